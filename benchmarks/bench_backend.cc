@@ -0,0 +1,508 @@
+/**
+ * @file kernels of `abyss::backend`, called directly on raw buffers.
+ *
+ * Elementwise kernels take index arrays, so broadcast and strided operands
+ * are measured through the index pattern (second argument).
+ */
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "backend/activation.h"
+#include "backend/amath.h"
+#include "backend/arithmetics.h"
+#include "backend/comparison.h"
+#include "backend/convolution.h"
+#include "backend/losses.h"
+#include "backend/matmul.h"
+#include "backend/normalization.h"
+#include "backend/parallel.h"
+#include "backend/pooling.h"
+#include "backend/random.h"
+#include "backend/reduction.h"
+#include "bench_utils.h"
+
+namespace {
+
+using namespace abyss;
+using namespace abyss::bench;
+
+template <typename T>
+std::vector<T> filled(size_t n, T value = T(1)) {
+  return std::vector<T>(n, value);
+}
+
+/**
+ * elementwise
+ */
+
+template <typename T1, typename T2, typename Out,
+          void (*Fn)(const T1*, const size_t*, const T2*, const size_t*,
+                     const size_t, Out*)>
+void BM_binary(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const int pattern = state.range(1);
+  auto a = filled<T1>(n, T1(3));
+  auto b = filled<T2>(n, T2(2));
+  // not a vector, `std::vector<bool>` has no buffer
+  auto out = std::make_unique<Out[]>(n);
+  auto ids1 = indices(n, kContiguous);
+  auto ids2 = indices(n, pattern);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Fn(a.data(), ids1.data(), b.data(), ids2.data(), n, out.get());
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(pattern_name(pattern));
+  report(state, perf, n * (sizeof(T1) + sizeof(T2) + sizeof(Out)), n);
+}
+
+template <typename T, void (*Fn)(const T*, const size_t*, const size_t, T*)>
+void BM_unary(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const int pattern = state.range(1);
+  auto a = filled<T>(n, T(2));
+  std::vector<T> out(n);
+  auto ids = indices(n, pattern);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Fn(a.data(), ids.data(), n, out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(pattern_name(pattern));
+  report(state, perf, 2 * n * sizeof(T), n);
+}
+
+template <typename T1, typename T2,
+          void (*Fn)(const T1*, const T2*, const size_t&, bool*) noexcept>
+void BM_compare(benchmark::State& state) {
+  const size_t n = state.range(0);
+  auto a = filled<T1>(n);
+  auto b = filled<T2>(n);
+  auto out = std::make_unique<bool[]>(n);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Fn(a.data(), b.data(), n, out.get());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, n * (sizeof(T1) + sizeof(T2) + sizeof(bool)), n);
+}
+
+void elementwise_args(benchmark::internal::Benchmark* b) {
+  for (int pattern : {kContiguous, kBroadcastRow, kTransposed}) {
+    for (int64_t n : {1 << 12, 1 << 16, 1 << 20}) b->Args({n, pattern});
+  }
+}
+
+#define ABYSS_BINARY_BENCH(fn)                                             \
+  BENCHMARK_TEMPLATE(BM_binary, double, double, double, backend::fn)       \
+      ->Apply(elementwise_args);                                           \
+  BENCHMARK_TEMPLATE(BM_binary, int32_t, int32_t, int32_t, backend::fn)    \
+      ->Apply(elementwise_args);                                           \
+  BENCHMARK_TEMPLATE(BM_binary, double, int32_t, double, backend::fn)      \
+      ->Apply(elementwise_args);
+
+ABYSS_BINARY_BENCH(add)
+ABYSS_BINARY_BENCH(sub)
+ABYSS_BINARY_BENCH(mult)
+ABYSS_BINARY_BENCH(div)
+BENCHMARK_TEMPLATE(BM_binary, double, double, bool, backend::equal)
+    ->Apply(elementwise_args);
+BENCHMARK_TEMPLATE(BM_binary, double, double, bool, backend::not_equal)
+    ->Apply(elementwise_args);
+
+BENCHMARK_TEMPLATE(BM_unary, double, backend::neg)->Apply(elementwise_args);
+BENCHMARK_TEMPLATE(BM_unary, int32_t, backend::neg)->Apply(elementwise_args);
+BENCHMARK_TEMPLATE(BM_unary, double, backend::exp)->Apply(elementwise_args);
+BENCHMARK_TEMPLATE(BM_unary, double, backend::log)->Apply(elementwise_args);
+
+BENCHMARK_TEMPLATE(BM_compare, double, double, backend::equal)
+    ->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_compare, int32_t, double, backend::not_equal)
+    ->Range(1 << 12, 1 << 20);
+
+/**
+ * reductions, a strided sum walks one column of a row-major matrix
+ */
+
+template <typename T>
+void BM_sum(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const int stride = state.range(1);
+  auto a = filled<T>(n * stride);
+  T out{};
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    out = T{};
+    backend::sum(a.data(), stride, n, &out);
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetLabel(stride == 1 ? "contiguous" : "strided");
+  report(state, perf, n * sizeof(T), n);
+}
+BENCHMARK_TEMPLATE(BM_sum, double)
+    ->ArgsProduct({{1 << 12, 1 << 16, 1 << 20}, {1, 16}});
+BENCHMARK_TEMPLATE(BM_sum, int32_t)
+    ->ArgsProduct({{1 << 12, 1 << 16, 1 << 20}, {1, 16}});
+
+/**
+ * matrix products
+ */
+
+template <typename T1, typename T2, typename Out>
+void BM_matmul(benchmark::State& state) {
+  const int n = state.range(0);
+  auto a = filled<T1>(size_t(n) * n);
+  auto b = filled<T2>(size_t(n) * n);
+  std::vector<Out> c(size_t(n) * n);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::matmul(a.data(), b.data(), n, n, n, c.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 3.0 * n * n * sizeof(Out), 2.0 * n * n * n);
+}
+BENCHMARK_TEMPLATE(BM_matmul, double, double, double)
+    ->RangeMultiplier(4)->Range(16, 512);
+BENCHMARK_TEMPLATE(BM_matmul, int32_t, int32_t, int32_t)
+    ->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK_TEMPLATE(BM_matmul, int32_t, double, double)
+    ->RangeMultiplier(4)->Range(16, 256);
+
+void BM_gemm(benchmark::State& state) {
+  const int n = state.range(0);
+  const bool trans = state.range(1);
+  auto a = filled<double>(size_t(n) * n);
+  auto b = filled<double>(size_t(n) * n);
+  std::vector<double> c(size_t(n) * n);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::gemm(trans, false, n, n, n, 1.0, a.data(), b.data(), 0.0,
+                  c.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(trans ? "transposed" : "contiguous");
+  report(state, perf, 3.0 * n * n * sizeof(double), 2.0 * n * n * n);
+}
+BENCHMARK(BM_gemm)->ArgsProduct({{64, 256, 512}, {0, 1}});
+
+void BM_linear(benchmark::State& state) {
+  const int out = state.range(0), in = state.range(0), batch = state.range(1);
+  auto w = filled<double>(size_t(out) * in, 0.01);
+  auto x = filled<double>(size_t(in) * batch, 0.5);
+  auto bias = filled<double>(out, 0.1);
+  std::vector<double> y(size_t(out) * batch);
+  std::vector<uint8_t> mask((y.size() + 7) / 8);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::linear(w.data(), x.data(), bias.data(), backend::Activation::kReLU,
+                    out, in, batch, y.data(), mask.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, (w.size() + x.size() + y.size()) * sizeof(double),
+         2.0 * out * in * batch);
+}
+BENCHMARK(BM_linear)->ArgsProduct({{128, 512}, {1, 32, 256}});
+
+/**
+ * activations
+ */
+
+void BM_activation(benchmark::State& state) {
+  const size_t n = state.range(0);
+  auto act = static_cast<backend::Activation>(state.range(1));
+  auto in = filled<double>(n, 0.5);
+  std::vector<double> out(n);
+  std::vector<uint8_t> mask((n + 7) / 8);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::activation(act, in.data(), {}, n, out.data(), mask.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 2 * n * sizeof(double), n);
+}
+BENCHMARK(BM_activation)
+    ->ArgsProduct({{1 << 12, 1 << 20},
+                   {int(backend::Activation::kReLU),
+                    int(backend::Activation::kGELU),
+                    int(backend::Activation::kSigmoid),
+                    int(backend::Activation::kTanh)}});
+
+void BM_activation_backward(benchmark::State& state) {
+  const size_t n = state.range(0);
+  auto act = static_cast<backend::Activation>(state.range(1));
+  auto grad = filled<double>(n, 1.0);
+  auto saved = filled<double>(n, 0.5);
+  std::vector<uint8_t> mask((n + 7) / 8, 0xaa);
+  std::vector<double> out(n);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::activation_backward(act, grad.data(), saved.data(), {},
+                                 mask.data(), n, out.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 3 * n * sizeof(double), n);
+}
+BENCHMARK(BM_activation_backward)
+    ->ArgsProduct({{1 << 12, 1 << 20},
+                   {int(backend::Activation::kReLU),
+                    int(backend::Activation::kTanh)}});
+
+void BM_bias_backward(benchmark::State& state) {
+  const size_t channels = state.range(0), inner = state.range(1);
+  const size_t n = channels * inner * 8;
+  auto grad = filled<double>(n);
+  std::vector<double> out(channels);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::bias_backward(grad.data(), channels, inner, n, out.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, n * sizeof(double), n);
+}
+BENCHMARK(BM_bias_backward)->ArgsProduct({{64, 512}, {1, 64}});
+
+/**
+ * convolution and pooling on (8, C, 32, 32) images
+ */
+
+backend::Conv2dGeometry conv_geometry(int channels, int kernel, int groups) {
+  backend::Conv2dGeometry g{};
+  g.batch = 8;
+  g.in_channels = channels;
+  g.height = g.width = 32;
+  g.out_channels = channels;
+  g.kernel_h = g.kernel_w = kernel;
+  g.stride_h = g.stride_w = 1;
+  g.pad_h = g.pad_w = kernel / 2;
+  g.dilation_h = g.dilation_w = 1;
+  g.groups = groups;
+  g.out_height = g.out_width = 32;
+  return g;
+}
+
+double conv_flops(const backend::Conv2dGeometry& g) {
+  return 2.0 * g.batch * g.out_channels * g.out_height * g.out_width *
+         (g.in_channels / g.groups) * g.kernel_h * g.kernel_w;
+}
+
+void BM_conv2d(benchmark::State& state) {
+  const int channels = state.range(0);
+  const int groups = state.range(1) ? channels : 1;
+  auto g = conv_geometry(channels, 3, groups);
+  auto input = filled<double>(size_t(g.batch) * channels * 32 * 32);
+  auto weight = filled<double>(size_t(channels) * (channels / groups) * 9);
+  std::vector<double> output(input.size());
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::conv2d(input.data(), weight.data(), g, output.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(groups == 1 ? "dense" : "depthwise");
+  report(state, perf, (2 * input.size() + weight.size()) * sizeof(double),
+         conv_flops(g));
+}
+BENCHMARK(BM_conv2d)->ArgsProduct({{8, 32}, {0, 1}});
+
+void BM_conv2d_backward(benchmark::State& state) {
+  const int channels = state.range(0);
+  auto g = conv_geometry(channels, 3, 1);
+  auto input = filled<double>(size_t(g.batch) * channels * 32 * 32);
+  auto weight = filled<double>(size_t(channels) * channels * 9);
+  auto grad_output = filled<double>(input.size());
+  std::vector<double> grad_input(input.size()), grad_weight(weight.size()),
+      grad_bias(channels);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::conv2d_backward_input(grad_output.data(), weight.data(), g,
+                                   grad_input.data());
+    backend::conv2d_backward_weight(grad_output.data(), input.data(), g,
+                                    grad_weight.data());
+    backend::conv2d_backward_bias(grad_output.data(), g, grad_bias.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 4 * input.size() * sizeof(double), 2 * conv_flops(g));
+}
+BENCHMARK(BM_conv2d_backward)->Arg(8)->Arg(32);
+
+void BM_im2col(benchmark::State& state) {
+  const int channels = state.range(0);
+  auto g = conv_geometry(channels, 3, 1);
+  auto image = filled<double>(size_t(channels) * 32 * 32);
+  std::vector<double> col(image.size() * 9);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::im2col(image.data(), g, channels, col.data());
+    backend::col2im(col.data(), g, channels, image.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 2 * (image.size() + col.size()) * sizeof(double));
+}
+BENCHMARK(BM_im2col)->Arg(8)->Arg(32);
+
+backend::Pool2dGeometry pool_geometry(int channels) {
+  backend::Pool2dGeometry g{};
+  g.batch = 8;
+  g.channels = channels;
+  g.height = g.width = 32;
+  g.kernel_h = g.kernel_w = 2;
+  g.stride_h = g.stride_w = 2;
+  g.out_height = g.out_width = 16;
+  return g;
+}
+
+void BM_pool2d(benchmark::State& state) {
+  const int channels = state.range(0);
+  const bool max = state.range(1);
+  auto g = pool_geometry(channels);
+  auto input = filled<double>(size_t(g.batch) * channels * 32 * 32);
+  std::vector<double> output(input.size() / 4), grad_input(input.size());
+  std::vector<int32_t> ids(output.size());
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    if (max) {
+      backend::max_pool2d(input.data(), g, output.data(), ids.data());
+      backend::max_pool2d_backward(output.data(), ids.data(), g,
+                                   grad_input.data());
+    } else {
+      backend::avg_pool2d(input.data(), g, output.data());
+      backend::avg_pool2d_backward(output.data(), g, grad_input.data());
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(max ? "max" : "avg");
+  report(state, perf, 2.5 * input.size() * sizeof(double), 2.0 * input.size());
+}
+BENCHMARK(BM_pool2d)->ArgsProduct({{8, 32}, {0, 1}});
+
+/**
+ * normalization
+ */
+
+void BM_batch_norm(benchmark::State& state) {
+  const int batch = 8, channels = state.range(0);
+  const size_t spatial = 32 * 32;
+  const size_t n = batch * channels * spatial;
+  auto input = filled<double>(n, 0.5), grad = filled<double>(n);
+  auto weight = filled<double>(channels), bias = filled<double>(channels, 0.0);
+  std::vector<double> running_mean(channels), running_var(channels, 1.0),
+      mean(channels), invstd(channels), output(n), grad_input(n),
+      grad_weight(channels), grad_bias(channels);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::batch_norm(input.data(), weight.data(), bias.data(),
+                        running_mean.data(), running_var.data(), batch,
+                        channels, spatial, true, 0.1, 1e-5, mean.data(),
+                        invstd.data(), output.data());
+    backend::batch_norm_backward(grad.data(), input.data(), weight.data(),
+                                 mean.data(), invstd.data(), batch, channels,
+                                 spatial, true, grad_input.data(),
+                                 grad_weight.data(), grad_bias.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 5.0 * n * sizeof(double), 15.0 * n);
+}
+BENCHMARK(BM_batch_norm)->Arg(8)->Arg(32);
+
+void BM_layer_norm(benchmark::State& state) {
+  const size_t rows = state.range(0), cols = state.range(1);
+  const size_t n = rows * cols;
+  auto input = filled<double>(n, 0.5), grad = filled<double>(n);
+  auto weight = filled<double>(cols), bias = filled<double>(cols, 0.0);
+  std::vector<double> mean(rows), invstd(rows), output(n), grad_input(n),
+      grad_weight(cols), grad_bias(cols);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::layer_norm(input.data(), weight.data(), bias.data(), rows, cols,
+                        1e-5, mean.data(), invstd.data(), output.data());
+    backend::layer_norm_backward(grad.data(), input.data(), weight.data(),
+                                 mean.data(), invstd.data(), rows, cols,
+                                 grad_input.data(), grad_weight.data(),
+                                 grad_bias.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 5.0 * n * sizeof(double), 15.0 * n);
+}
+BENCHMARK(BM_layer_norm)->ArgsProduct({{64, 1024}, {128, 1024}});
+
+/**
+ * losses
+ */
+
+void BM_cross_entropy(benchmark::State& state) {
+  const size_t batch = state.range(0), classes = state.range(1);
+  auto logits = filled<double>(batch * classes, 0.5);
+  std::vector<int32_t> target(batch, 1);
+  std::vector<double> grad(batch * classes);
+  double loss = 0;
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::cross_entropy(logits.data(), target.data(), batch, classes,
+                           &loss);
+    backend::cross_entropy_backward(logits.data(), target.data(), batch,
+                                    classes, 1.0 / batch, grad.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, 3.0 * batch * classes * sizeof(double),
+         8.0 * batch * classes);
+}
+BENCHMARK(BM_cross_entropy)->ArgsProduct({{32, 256}, {10, 1000}});
+
+/**
+ * random fills and the thread pool
+ */
+
+void BM_random(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const bool normal = state.range(1);
+  std::vector<double> out(n);
+  uint64_t offset = 0;
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    if (normal) {
+      backend::normal(42, offset, n, out.data());
+    } else {
+      backend::uniform(42, offset, n, out.data());
+    }
+    offset += n;
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(normal ? "normal" : "uniform");
+  report(state, perf, n * sizeof(double));
+}
+BENCHMARK(BM_random)->ArgsProduct({{1 << 12, 1 << 20}, {0, 1}});
+
+void BM_parallel_for(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<double> out(n);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    backend::parallel_for(0, n, 1024, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) out[i] = double(i);
+    });
+    benchmark::ClobberMemory();
+  }
+  report(state, perf, n * sizeof(double));
+}
+BENCHMARK(BM_parallel_for)->Range(1 << 10, 1 << 20);
+
+}  // namespace
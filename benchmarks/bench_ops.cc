@@ -0,0 +1,173 @@
+/**
+ * @file ops on tensors, through the public functions and the visitors.
+ */
+#include <vector>
+
+#include "bench_utils.h"
+#include "core/dispatcher.h"
+#include "functional.h"
+#include "jit.h"
+#include "ops/matrix_ops.h"
+#include "ops/merge_ops.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+using namespace abyss;
+using namespace abyss::bench;
+
+void BM_tensor_add(benchmark::State& state) {
+  const int n = state.range(0);
+  const int pattern = state.range(1);
+  Tensor a = full({n, n}, 1.0);
+  // `T()` returns a view owned by its tensor, so keep the tensor alive
+  Tensor base = full({pattern == kBroadcastRow ? 1 : n, n}, 2.0);
+  Tensor b = pattern == kTransposed ? base.T() : base;
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Tensor c = a + b;
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetLabel(pattern_name(pattern));
+  report(state, perf, 3.0 * n * n * sizeof(double), double(n) * n);
+}
+BENCHMARK(BM_tensor_add)
+    ->ArgsProduct({{64, 256, 1024}, {kContiguous, kBroadcastRow, kTransposed}});
+
+void BM_tensor_exp(benchmark::State& state) {
+  const int n = state.range(0);
+  Tensor a = full({n, n}, 0.5);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Tensor c = exp(a);
+    benchmark::DoNotOptimize(c);
+  }
+  report(state, perf, 2.0 * n * n * sizeof(double), double(n) * n);
+}
+BENCHMARK(BM_tensor_exp)->Arg(64)->Arg(256)->Arg(1024);
+
+/**
+ * @brief packing a transposed matrix, as before a matmul or a reshape.
+ */
+void BM_transpose_contiguous(benchmark::State& state) {
+  const int n = state.range(0);
+  // `T()` returns a view owned by its tensor, so keep the tensor alive
+  Tensor base = full({n, n}, 1.0);
+  Tensor view = base.T();
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Tensor c = view.contiguous();
+    benchmark::DoNotOptimize(c);
+  }
+  report(state, perf, 2.0 * n * n * sizeof(double));
+}
+BENCHMARK(BM_transpose_contiguous)->Arg(256)->Arg(1024)->Arg(4096);
+
+/**
+ * @brief scaling a small tensor, e.g. by a learning rate, where creating the
+ * scalar and the output metadata is most of the work.
+ */
+void BM_scalar_multiply(benchmark::State& state) {
+  const int n = state.range(0);
+  Tensor a = full({n}, 1.0);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Tensor c = 0.01 * a;
+    benchmark::DoNotOptimize(c);
+  }
+  report(state, perf, 2.0 * n * sizeof(double), n);
+}
+BENCHMARK(BM_scalar_multiply)->Arg(1)->Arg(16);
+
+void BM_fused(benchmark::State& state) {
+  const int n = state.range(0);
+  const bool compiled = state.range(1);
+  Tensor a = randn({n, n});
+  Tensor b = randn({n, n});
+  auto x = jit::input(0), y = jit::input(1);
+  jit::FusedKernel kernel(exp(x) * y + x / 2.0);
+
+  jit::set_enabled(compiled);
+  // build outside the timed loop
+  kernel({a, b});
+  jit::wait();
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Tensor c = kernel({a, b});
+    benchmark::DoNotOptimize(c);
+  }
+  jit::set_enabled(false);
+  state.SetLabel(compiled ? "jit" : "interpreted");
+  report(state, perf, 3.0 * n * n * sizeof(double), 5.0 * n * n);
+}
+BENCHMARK(BM_fused)->ArgsProduct({{64, 256, 1024}, {0, 1}});
+
+/**
+ * visitors
+ */
+
+void BM_matmul_visitor(benchmark::State& state) {
+  const int n = state.range(0);
+  const int stacks = state.range(1);
+  std::vector<int> shape = {n, n};
+  if (stacks > 1) shape.insert(shape.begin(), stacks);
+  Tensor lhs = randn(shape);
+  Tensor rhs = randn({n, n});
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    core::DataDispatcher<Tensor> a = lhs;
+    core::DataDispatcher<Tensor> b = rhs;
+    core::MatmulVisitor vis(a.desc(), b.desc());
+    a.accept(&vis, &b);
+    Tensor c = vis;
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetLabel(stacks > 1 ? "broadcast" : "2d");
+  report(state, perf, (2.0 * stacks + 1) * n * n * sizeof(double),
+         2.0 * stacks * n * n * n);
+}
+BENCHMARK(BM_matmul_visitor)->ArgsProduct({{32, 128, 256}, {1, 8}});
+
+void BM_sum_visitor(benchmark::State& state) {
+  const int n = state.range(0);
+  const int axis = state.range(1);
+  Tensor input = randn({n, n});
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    core::DataDispatcher<Tensor> a = input;
+    core::SumVisitor vis(a.desc(), axis < 0 ? core::ReductionVisitor::kNoAxis
+                                            : axis);
+    a.accept(&vis);
+    Tensor c = vis;
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetLabel(axis < 0 ? "all" : axis == 0 ? "strided" : "contiguous");
+  report(state, perf, double(n) * n * sizeof(double), double(n) * n);
+}
+BENCHMARK(BM_sum_visitor)->ArgsProduct({{64, 256, 1024}, {-1, 0, 1}});
+
+void BM_concat(benchmark::State& state) {
+  const int n = state.range(0);
+  const int parts = state.range(1);
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < parts; i++) tensors.push_back(full({n, n}, double(i)));
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    Tensor c = concat(tensors, 0);
+    benchmark::DoNotOptimize(c);
+  }
+  report(state, perf, 2.0 * parts * n * n * sizeof(double));
+}
+BENCHMARK(BM_concat)->ArgsProduct({{64, 256}, {2, 8}});
+
+}  // namespace
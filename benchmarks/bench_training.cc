@@ -0,0 +1,98 @@
+/**
+ * @file data loading and a whole training step.
+ */
+#include <utility>
+#include <vector>
+
+#include "autograd/function.h"
+#include "bench_utils.h"
+#include "functional.h"
+#include "nn/losses.h"
+#include "nn/module.h"
+#include "operators.h"
+#include "optimizers.h"
+#include "random.h"
+#include "tensor.h"
+#include "utils/data.h"
+
+namespace {
+
+using namespace abyss;
+using namespace abyss::bench;
+
+class Samples : public utils::data::Dataset {
+ public:
+  Samples(size_t n, int features) : features_{features}, n_{n} {}
+  size_t size() const override { return n_; }
+  std::pair<Tensor, Tensor> operator[](size_t idx) override {
+    return {full({features_}, double(idx)), full({1}, int(idx % 10))};
+  }
+
+ private:
+  int features_;
+  size_t n_;
+};
+
+void BM_data_loader(benchmark::State& state) {
+  const int features = 64;
+  const size_t batch = state.range(0);
+  const bool shuffle = state.range(1);
+  Samples dataset(1024, features);
+  utils::data::DataLoader loader(dataset, batch, shuffle);
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    for (auto& item : loader) benchmark::DoNotOptimize(item.first);
+  }
+  state.SetLabel(shuffle ? "shuffled" : "sequential");
+  report(state, perf,
+         dataset.size() * (features * sizeof(double) + sizeof(int)));
+}
+BENCHMARK(BM_data_loader)->ArgsProduct({{1, 32, 256}, {0, 1}});
+
+/**
+ * @brief differentiable transpose, `T()` is a view and views do not track
+ * gradients.
+ */
+class TransposeFn : public autograd::Function<TransposeFn> {
+ public:
+  static Tensor forward(autograd::Context&, Tensor a) {
+    return a.T().copy();
+  }
+  static std::vector<Tensor> backward(autograd::Context&, Tensor output_grad) {
+    return {output_grad.T().copy()};
+  }
+};
+
+/**
+ * @brief forward, backward and an SGD update of a linear classifier.
+ *
+ * Linear takes (features, batch) columns, the loss takes (batch, classes).
+ */
+void BM_training_step(benchmark::State& state) {
+  const int features = state.range(0), classes = 10;
+  const int batch = state.range(1);
+  nn::Linear fc(features, classes);
+  nn::NLLLoss loss_fn;
+  optim::SGD sgd(fc.parameters(), 0.01);
+
+  Tensor input = randn({features, batch});
+  Tensor target = full({batch}, 0);
+  for (int i = 0; i < batch; i++) target(i) = i % classes;
+
+  PerfRegion perf;
+  for (auto _ : state) {
+    sgd.zero_grad();
+    Tensor logits = TransposeFn().call(fc(input));
+    Tensor loss = loss_fn(logits, target);
+    loss.backward();
+    sgd.step();
+  }
+  // the forward product, and two more for the gradients
+  double flops = 3 * 2.0 * features * classes * batch;
+  report(state, perf, (features * batch + features * classes) * sizeof(double),
+         flops);
+}
+BENCHMARK(BM_training_step)->ArgsProduct({{64, 512}, {16, 128}});
+
+}  // namespace
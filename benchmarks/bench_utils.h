@@ -0,0 +1,107 @@
+#ifndef ABYSS_BENCH_UTILS_H
+#define ABYSS_BENCH_UTILS_H
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "profiler.h"
+
+namespace abyss::bench {
+
+/**
+ * @brief hardware counters around the timed loop, start it right before.
+ */
+class PerfRegion {
+ public:
+  PerfRegion() : start_{profiler::detail::thread_counters().read()} {}
+
+  profiler::CounterValues stop() const {
+    return profiler::detail::thread_counters().read() - start_;
+  }
+
+ private:
+  profiler::CounterValues start_;
+};
+
+/**
+ * @brief report throughput, `bytes` and `flops` are per iteration.
+ *
+ * Both are reported in units of 1e9 per second so JSON results can be diffed
+ * directly. Hardware counters are added per iteration, with IPC and bytes per
+ * cycle, when the kernel lets us read them.
+ */
+inline void report(benchmark::State& state, const PerfRegion& region,
+                   double bytes, double flops = 0) {
+  using profiler::Counter;
+  auto counters = region.stop();
+
+  double iterations = static_cast<double>(state.iterations());
+  state.counters["GB/s"] =
+      benchmark::Counter(bytes * iterations / 1e9, benchmark::Counter::kIsRate);
+  if (flops > 0) {
+    state.counters["GFLOP/s"] = benchmark::Counter(
+        flops * iterations / 1e9, benchmark::Counter::kIsRate);
+  }
+
+  for (int c = 0; c < profiler::kNumCounters; c++) {
+    if (!counters.has(Counter(c))) continue;
+    state.counters[profiler::counter_name(Counter(c))] = benchmark::Counter(
+        double(counters.values[c]), benchmark::Counter::kAvgIterations);
+  }
+  if (counters.ipc() > 0) {
+    state.counters["IPC"] = counters.ipc();
+    state.counters["bytes/cycle"] =
+        bytes * iterations / counters[Counter::kCycles];
+  }
+}
+
+/**
+ * @brief how operands are traversed by the indexed backend kernels.
+ */
+enum Pattern : int {
+  kContiguous = 0,
+  kBroadcastRow = 1,  // a (1, cols) row repeated over (rows, cols)
+  kTransposed = 2,    // a (cols, rows) buffer read as (rows, cols)
+};
+
+/**
+ * @brief indices of a square-ish (rows, cols) traversal of `n` elements.
+ */
+inline std::vector<size_t> indices(size_t n, int pattern) {
+  std::vector<size_t> ids(n);
+  size_t cols = 1;
+  while (cols * cols < n) cols *= 2;
+  size_t rows = (n + cols - 1) / cols;
+  for (size_t i = 0; i < n; i++) {
+    size_t r = i / cols, c = i % cols;
+    switch (pattern) {
+      case kBroadcastRow:
+        ids[i] = c;
+        break;
+      case kTransposed:
+        ids[i] = std::min(c * rows + r, n - 1);
+        break;
+      default:
+        ids[i] = i;
+    }
+  }
+  return ids;
+}
+
+inline const char* pattern_name(int pattern) {
+  switch (pattern) {
+    case kBroadcastRow:
+      return "broadcast";
+    case kTransposed:
+      return "transposed";
+    default:
+      return "contiguous";
+  }
+}
+
+}  // namespace abyss::bench
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef ABYSS_AUTOGRAD_CAPTURE_H
+#define ABYSS_AUTOGRAD_CAPTURE_H
+
+/**
+ * @file capture and replay of static steps.
+ *
+ * Every op resolves its shapes, broadcast indices and output buffers before it
+ * calls the backend. While a capture is active the resolved kernel is recorded
+ * together with the buffers it reads and writes, so the same step can later be
+ * re-run without dispatch, broadcast resolution, allocation or graph traffic.
+ */
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "abyss_export.h"
+#include "core/array.h"
+#include "profiler.h"
+
+namespace abyss::autograd {
+
+/**
+ * @brief a recorded sequence of kernels bound to fixed buffers.
+ *
+ * Replaying writes into the exact buffers that were used during capture, so
+ * every tensor produced inside the capture (outputs, gradients, updated
+ * parameters) sees the new values. New inputs are fed by writing them into the
+ * captured input tensors in place, e.g. `x(kAll) = batch`.
+ *
+ * Values read on the host during capture (scalar conversions, loop bounds,
+ * random samples) are baked into the recording.
+ */
+class ABYSS_EXPORT CapturedGraph {
+ public:
+  using Kernel = std::function<void()>;
+
+  struct Node {
+    std::string name;
+    Kernel kernel;
+    std::vector<size_t> reads;   // buffer ids
+    std::vector<size_t> writes;  // buffer ids
+    double flops = 0;            // estimate for the profiler
+  };
+
+  CapturedGraph() = default;
+  CapturedGraph(const CapturedGraph&) = delete;
+  CapturedGraph& operator=(const CapturedGraph&) = delete;
+
+  /**
+   * @brief the graph recording on this thread, `nullptr` if none.
+   */
+  static CapturedGraph* current();
+
+  /**
+   * @brief append a kernel, the touched buffers are retained by the graph.
+   *
+   * `nullptr` entries (optional operands) are skipped.
+   */
+  void record(std::string name, Kernel kernel,
+              std::initializer_list<core::Array*> reads,
+              std::initializer_list<core::Array*> writes, double flops = 0);
+
+  /**
+   * @brief run all recorded kernels in order.
+   */
+  void replay() const;
+
+  /**
+   * @brief drop the recording and release the retained buffers.
+   */
+  void reset();
+
+  bool empty() const;
+  const std::vector<Node>& nodes() const;
+  const std::vector<std::shared_ptr<core::Array>>& buffers() const;
+
+ private:
+  std::vector<Node> nodes_;
+  std::vector<std::shared_ptr<core::Array>> buffers_;
+  std::unordered_map<core::Array*, size_t> buffer_ids_;
+
+  size_t buffer_id(core::Array* buffer);
+};
+
+/**
+ * @brief records every kernel launched on this thread into `graph` while in
+ * scope. Kernels still execute eagerly during capture.
+ */
+class ABYSS_EXPORT CaptureGuard {
+ public:
+  explicit CaptureGuard(CapturedGraph& graph);
+  ~CaptureGuard();
+
+  CaptureGuard(const CaptureGuard&) = delete;
+  CaptureGuard& operator=(const CaptureGuard&) = delete;
+};
+
+/**
+ * @brief run a resolved kernel and record it if a capture is active.
+ *
+ * `kernel` must only capture what it needs to run again (raw buffer pointers
+ * and precomputed indices), the buffers are kept alive by the graph. Data
+ * pointers should be fetched when the kernel runs, a memory plan may move
+ * the buffers after capture and `writes` may get a buffer of their own when
+ * they were shared copy-on-write. `flops` is an estimate reported to the
+ * profiler.
+ */
+template <typename KernelTp>
+void run_kernel(const char* name, KernelTp&& kernel,
+                std::initializer_list<core::Array*> reads,
+                std::initializer_list<core::Array*> writes, double flops = 0) {
+  for (auto* buffer : writes) {
+    if (buffer != nullptr) buffer->prepare_write();
+  }
+  {
+    profiler::RecordScope scope("kernel", name, flops);
+    kernel();
+  }
+
+  if (auto* graph = CapturedGraph::current()) {
+    graph->record(name, std::forward<KernelTp>(kernel), reads, writes, flops);
+  }
+}
+
+}  // namespace abyss::autograd
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef ABYSS_AUTOGRAD_CHECKPOINT_H
+#define ABYSS_AUTOGRAD_CHECKPOINT_H
+
+#include <functional>
+
+#include "abyss_export.h"
+#include "tensor.h"
+
+namespace abyss::autograd {
+
+/**
+ * @brief gradient checkpointing (activation recomputation).
+ *
+ * Runs `segment(input)` without keeping the tensors its functions save for
+ * backward. Only `input` is saved, the segment is recomputed when the
+ * gradient reaches it. Parameters used inside the segment still receive
+ * gradients.
+ *
+ * The segment should be deterministic apart from random ops, which replay the
+ * same samples during recomputation.
+ */
+ABYSS_EXPORT Tensor checkpoint(std::function<Tensor(Tensor)> segment,
+                               Tensor input);
+
+}  // namespace abyss::autograd
+
+#endif
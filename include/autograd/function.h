@@ -10,8 +10,10 @@
 
 #include "abyss_export.h"
 #include "functional.h"
+#include "grad_mode.h"
 #include "graph.h"
 #include "operators.h"
+#include "profiler.h"
 #include "tensor.h"
 
 namespace abyss::autograd {
@@ -26,6 +28,20 @@ class ABYSS_EXPORT Function {
   // void call_backward();
  protected:
   std::string name;
+
+ private:
+  // only tensor arguments become edges of the graph
+  static void add_input(Context& ctx, const Tensor& arg) {
+    Context::Edge edge;
+    edge.requires_grad = arg.flags(core::FlagId::kRequiresGrad);
+    if (edge.requires_grad) {
+      edge.grad_fn = arg.grad_fn_;
+      if (edge.grad_fn == nullptr) edge.leaf = arg;
+    }
+    ctx.add_input(std::move(edge));
+  }
+  template <typename T>
+  static void add_input(Context&, const T&) {}
 };
 
 // /**
@@ -59,6 +75,8 @@ class ABYSS_EXPORT BackwardFn {
     return func_(ctx, output_grad);
   }
 
+  const std::string& name() const { return name_; }
+
   friend std::ostream& operator<<(std::ostream& os, const BackwardFn& bkd_fn) {
     os << bkd_fn.name_ << std::endl;
     return os;
@@ -70,29 +88,61 @@ class ABYSS_EXPORT BackwardFn {
   FuncType func_;
 };
 
+namespace detail {
+/**
+ * @brief only tensor arguments take part in gradient tracking, the others
+ * (axes, callables, ...) are passed through to `forward`.
+ */
+inline bool requires_grad(const Tensor& arg) {
+  return arg.flags(core::FlagId::kRequiresGrad);
+}
+template <typename T>
+bool requires_grad(const T&) {
+  return false;
+}
+
+inline void profile_input(profiler::RecordScope& scope, const Tensor& arg) {
+  scope.add_input(arg.shape(), arg.dtype().id());
+}
+template <typename T>
+void profile_input(profiler::RecordScope&, const T&) {}
+}  // namespace detail
+
 template <typename ChildType>
 template <typename... Args>
 Tensor Function<ChildType>::call(Args... args) {
   using namespace abyss::core;
 
+  // demangled once per function type
+  static const std::string& type_name =
+      profiler::detail::type_name(typeid(ChildType));
+
+  profiler::RecordScope scope("function");
+  if (scope.active()) {
+    scope.set_name(type_name);
+    (detail::profile_input(scope, args), ...);
+  }
+
   Graph& graph = Graph::instance();
 
+  bool requires_grad = (false || ... || detail::requires_grad(args));
+
   // create context and compute
   Context ctx;
+  (add_input(ctx, args), ...);
   Tensor output = ChildType::forward(ctx, std::forward<Args>(args)...);
 
   // update properties
-  std::array<Tensor, sizeof...(Args)> inputs{std::forward<Args>(args)...};
-  bool requires_grad = false;
-  for (auto&& in : inputs) {
-    requires_grad |= in.flags(FlagId::kRequiresGrad);
-  }
+  // (functions wrapping other functions may already report a gradient)
+  requires_grad |= output.flags(FlagId::kRequiresGrad);
+  requires_grad &= GradMode::is_enabled();
   output.set_flag(FlagId::kRequiresGrad, requires_grad);
   output.set_flag(FlagId::kIsLeaf, false);
   // output.set_requires_grad(true);
   // output.is_leaf_ = false;
   if (requires_grad) {
-    output.grad_fn_ = std::make_shared<BackwardFn>(name, ChildType::backward);
+    output.grad_fn_ = std::make_shared<BackwardFn>(
+        name.empty() ? type_name : name, ChildType::backward);
     graph.bind_context(output, ctx);
   }
   // bind output tensor with context and register to graph
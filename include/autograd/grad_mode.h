@@ -0,0 +1,37 @@
+#ifndef ABYSS_AUTOGRAD_GRAD_MODE_H
+#define ABYSS_AUTOGRAD_GRAD_MODE_H
+
+#include "abyss_export.h"
+
+namespace abyss::autograd {
+
+/**
+ * @brief thread local switch for recording the autograd graph.
+ *
+ * When disabled, `Function::call` neither sets `grad_fn` nor binds contexts,
+ * so no forward inputs are kept alive.
+ */
+class ABYSS_EXPORT GradMode {
+ public:
+  static bool is_enabled();
+  static void set_enabled(bool enabled);
+};
+
+/**
+ * @brief disable gradient recording while in scope.
+ */
+class ABYSS_EXPORT NoGradGuard {
+ public:
+  NoGradGuard();
+  ~NoGradGuard();
+
+  NoGradGuard(const NoGradGuard&) = delete;
+  NoGradGuard& operator=(const NoGradGuard&) = delete;
+
+ private:
+  bool prev_;
+};
+
+}  // namespace abyss::autograd
+
+#endif
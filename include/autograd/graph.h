@@ -1,6 +1,8 @@
 #ifndef ABYSS_AUTOGRAD_GRAPH_H
 #define ABYSS_AUTOGRAD_GRAPH_H
 
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -12,19 +14,70 @@
 
 namespace abyss::autograd {
 // class Tensor;
+class BackwardFn;
 
 /**
  * @brief Compute Context
  *
  * Edge of the graph to connect Nodes (a.k.a. Tensors) together.
+ *
+ * The inputs (where gradients flow to) are recorded by `Function::call`,
+ * independent of what `forward` saves, so a function may keep only what its
+ * backward needs (an output, a mask, ...) instead of its inputs.
  */
 class ABYSS_EXPORT Context {
  public:
-  void save_for_backward(std::initializer_list<Tensor> inputs);
+  /**
+   * @brief destination of the gradient of one tensor argument.
+   */
+  struct Edge {
+    // node that produced a non-leaf input
+    std::shared_ptr<BackwardFn> grad_fn;
+    // leaf input, gradients are accumulated into it
+    Tensor leaf;
+    bool requires_grad = false;
+  };
+
+  /**
+   * @brief keep tensors for backward.
+   *
+   * Their storage versions are recorded so that backward can detect in-place
+   * modification. Under copy-on-write the tensors keep their own view of the
+   * storage instead (see `set_copy_on_write`).
+   */
+  void save_for_backward(std::initializer_list<Tensor> tensors);
   std::vector<Tensor>& saved_tensors();
+  const std::vector<Tensor>& saved_tensors() const;
+
+  /**
+   * @brief throws if a saved tensor was modified in place since it was saved.
+   */
+  void check_saved_versions(const std::string& node) const;
+
+  /**
+   * @brief edges in the order of the tensor arguments, `backward` returns one
+   * gradient per edge (trailing ones may be omitted).
+   */
+  void add_input(Edge edge);
+  const std::vector<Edge>& inputs() const;
+
+  /**
+   * @brief keep non-tensor state (axes, callables, ...) for backward.
+   */
+  template <typename T>
+  void save_attribute(const std::string& name, T value) {
+    attributes_[name] = std::make_shared<T>(std::move(value));
+  }
+  template <typename T>
+  T& attribute(const std::string& name) {
+    return *std::static_pointer_cast<T>(attributes_.at(name));
+  }
 
  private:
   std::vector<Tensor> saved_tensors_;
+  std::vector<uint64_t> saved_versions_;
+  std::vector<Edge> inputs_;
+  std::unordered_map<std::string, std::shared_ptr<void>> attributes_;
 };
 // class Context;
 
@@ -34,27 +87,33 @@ class ABYSS_EXPORT Context {
  * Aritificial Neural Networks are basically Directed Acyclic Graphs (DAG).
  * The graph is represented as adjacency lists.
  *
- * Why a singleton you say? Because I cannot think of any use of multiple
- * graphs.
+ * There is one graph per thread (like `GradMode`), so threads training or
+ * running models at the same time never see each other's nodes. A tensor has
+ * to be differentiated on the thread that computed it.
  */
 class ABYSS_EXPORT Graph {
  public:
-  using EdgeType =
-      std::unordered_map<Tensor, Context, std::hash<Tensor>, Tensor::KeyEqual>;
+  // contexts are keyed by the backward node of their output, so in-place
+  // outputs sharing storage with an input still get their own node
+  using EdgeType = std::unordered_map<const BackwardFn*, Context>;
+
+  class SubgraphGuard;
   ~Graph() = default;
   Graph(const Graph&) = delete;
   Graph& operator=(const Graph&) = delete;
 
-  static Graph& instance() {
-    static Graph graph;
-
-    return graph;
-  }
+  /**
+   * @brief the graph of the calling thread.
+   */
+  static Graph& instance();
 
+  /**
+   * @brief drop everything recorded by the calling thread.
+   */
   static void clear();
 
   // std::vector<Tensor> nodes() const { return nodes_; }
-  EdgeType edges() const;
+  const EdgeType& edges() const;
 
   // size_t add_node(Tensor tensor) {
   //   nodes_.emplace_back(tensor);
@@ -66,14 +125,42 @@ class ABYSS_EXPORT Graph {
    */
   void bind_context(Tensor tsr, Context ctx);
 
+  /**
+   * @brief propagate `output_grad` to the leaves.
+   *
+   * Every node runs once, after all nodes consuming its output have, with the
+   * sum of their gradients. Leaf hooks fire as soon as the last edge into the
+   * leaf has been followed, while earlier nodes are still pending.
+   */
   void backward(Tensor& output, Tensor output_grad);
 
  private:
+  static void accumulate(Tensor& leaf, Tensor grad);
+  static void run_hooks(Tensor& leaf);
+
   // std::vector<Tensor> nodes_;
   EdgeType edges_;
 
   Graph() = default;
 };
 
+/**
+ * @brief record into an empty graph while in scope.
+ *
+ * The outer graph is restored on exit and everything recorded inside is
+ * released, which lets a function build and run a nested backward pass.
+ */
+class ABYSS_EXPORT Graph::SubgraphGuard {
+ public:
+  SubgraphGuard();
+  ~SubgraphGuard();
+
+  SubgraphGuard(const SubgraphGuard&) = delete;
+  SubgraphGuard& operator=(const SubgraphGuard&) = delete;
+
+ private:
+  EdgeType outer_;
+};
+
 }  // namespace abyss::autograd
 #endif
\ No newline at end of file
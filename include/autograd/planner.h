@@ -0,0 +1,73 @@
+#ifndef ABYSS_AUTOGRAD_PLANNER_H
+#define ABYSS_AUTOGRAD_PLANNER_H
+
+/**
+ * @file static memory planning for captured graphs.
+ *
+ * Intermediates of a captured step are only touched by the recorded kernels,
+ * so their lifetimes are known up front. The planner packs them into a single
+ * arena where buffers with disjoint lifetimes share memory.
+ */
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "abyss_export.h"
+#include "autograd/capture.h"
+
+namespace abyss::autograd {
+
+struct ABYSS_EXPORT MemoryPlan {
+  static constexpr size_t kAlignment = 64;
+
+  /**
+   * @brief placement of one intermediate buffer.
+   *
+   * `first` and `last` are the indices of the first and last node touching
+   * the buffer (inclusive).
+   */
+  struct Block {
+    size_t buffer;
+    size_t offset;
+    size_t nbytes;
+    size_t first;
+    size_t last;
+  };
+
+  std::vector<Block> blocks;
+
+  // every intermediate in its own allocation (what the graph holds today)
+  size_t naive_bytes = 0;
+  // most bytes alive at the same time, no plan can go below this
+  size_t live_peak_bytes = 0;
+  // size of the planned arena
+  size_t arena_bytes = 0;
+};
+
+ABYSS_EXPORT std::ostream& operator<<(std::ostream& os,
+                                      const MemoryPlan& plan);
+
+/**
+ * @brief compute lifetimes and assign arena offsets (greedy by size).
+ *
+ * A buffer is an intermediate when the graph holds its only reference and its
+ * first use is a write. Inputs, parameters, gradients and any tensor the
+ * caller still holds are left alone.
+ *
+ * Buffers are placed from the largest to the smallest, each at the best
+ * fitting gap between the already placed buffers whose lifetimes overlap.
+ */
+ABYSS_EXPORT MemoryPlan plan_memory(const CapturedGraph& graph);
+
+/**
+ * @brief allocate the arena and move the planned buffers into it.
+ *
+ * The previous allocations are released. Contents of intermediates are not
+ * preserved, the next replay recomputes them.
+ */
+ABYSS_EXPORT void apply_plan(CapturedGraph& graph, const MemoryPlan& plan);
+
+}  // namespace abyss::autograd
+
+#endif
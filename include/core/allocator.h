@@ -8,6 +8,7 @@
 #include <new>
 #include <utility>
 
+#include "memory_stats.h"
 // #include "types.h"
 // #include "buffer.h"
 
@@ -41,11 +42,17 @@ class Allocator {
       throw std::bad_array_new_length();
 
     T* ptr = static_cast<T*>(std::malloc(n * sizeof(T)));
-    if (ptr) return ptr;
+    if (ptr) {
+      memory::detail::on_allocate(ptr, n * sizeof(T));
+      return ptr;
+    }
 
     throw std::bad_alloc();
   }
-  void deallocate(T* ptr, size_type n) { std::free(ptr); }
+  void deallocate(T* ptr, size_type n) {
+    memory::detail::on_free(ptr, n * sizeof(T));
+    std::free(ptr);
+  }
 
 //  private:
   // size_type size_ = 0;
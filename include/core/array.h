@@ -5,7 +5,9 @@
  * The proper Array interface
  */
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -22,14 +24,51 @@
 namespace abyss::core {
 
 
-struct Array : Visitable {
+/**
+ * @brief type erased storage.
+ *
+ * Arrays are always owned by `std::shared_ptr`, so ops can retain the buffers
+ * they touch (e.g. when a step is captured for replay).
+ */
+struct Array : Visitable, std::enable_shared_from_this<Array> {
   virtual ~Array() = default;
 
   virtual size_t size() const = 0;
+  virtual size_t nbytes() const = 0;
   /**
    * @brief set all data back to 0
    */
   virtual void zero() = 0;
+  /**
+   * @brief move the array onto memory owned by someone else.
+   *
+   * The current contents are discarded. `ptr` must hold at least `nbytes()`
+   * bytes and stays valid as long as `owner` is alive.
+   */
+  virtual void rebind(void* ptr, std::shared_ptr<void> owner) = 0;
+
+  /**
+   * @brief a new array with the same contents that shares the buffer until
+   * either of them is written (copy-on-write).
+   */
+  virtual std::shared_ptr<Array> share() = 0;
+  /**
+   * @brief announce a write, called by every kernel before it modifies the
+   * array.
+   *
+   * Bumps the version and gives a copy-on-write array a buffer of its own if
+   * the current one is still shared.
+   */
+  virtual void prepare_write() = 0;
+
+  /**
+   * @brief how many writes the array has seen, autograd compares it with the
+   * version at the time a tensor was saved.
+   */
+  uint64_t version() const { return version_.load(std::memory_order_relaxed); }
+
+ protected:
+  std::atomic<uint64_t> version_{0};
 };
 
 template <typename T>
@@ -73,14 +112,26 @@ class ArrayImpl : public Array {
   ArrayImpl(std::vector<T> values);
   ArrayImpl(std::initializer_list<T> values);
 
+  /**
+   * @brief borrow `size` elements at `data` instead of allocating them.
+   *
+   * `owner` keeps the memory alive and is released with the array, a null
+   * owner leaves the memory to the caller.
+   */
+  ArrayImpl(T* data, size_t size, std::shared_ptr<void> owner);
+
   ArrayImpl& operator=(ArrayImpl copy);
 
   ~ArrayImpl();
 
   size_t size() const override { return size_; }
+  size_t nbytes() const override { return size_ * sizeof(T); }
   void zero() override {
     std::fill_n(data_, size_, 0);
   }
+  void rebind(void* ptr, std::shared_ptr<void> owner) override;
+  std::shared_ptr<Array> share() override;
+  void prepare_write() override;
 
   T* data() const { return data_; }
 
@@ -132,6 +183,18 @@ class ArrayImpl : public Array {
   size_t size_ = 0;
   allocator_type allocator_;
   T* data_ = nullptr;
+  // set when `data_` is borrowed instead of allocated
+  std::shared_ptr<void> owner_;
+  // `owner_` is a copy-on-write buffer other arrays may also read
+  bool shared_ = false;
+  // single elements (scalars) are stored inline instead of on the heap
+  T local_{};
+
+  T* acquire(size_t size) {
+    return size == 1 ? &local_ : allocator_.allocate(size);
+  }
+  bool is_local() const { return data_ == &local_; }
+  void release();
 };
 
 /**
@@ -243,22 +306,28 @@ template <typename T>
 ArrayImpl<T>::ArrayImpl(const ArrayImpl& other) {
   if (size_ != other.size_) {
     // only reallocate when the size is different
-    allocator_.deallocate(data_, size_);
+    release();
 
     size_ = other.size_;
     allocator_ = other.allocator_;
-    data_ = allocator_.allocate(size_);
+    data_ = acquire(size_);
   }
   std::copy_n(other.data_, other.size_, data_);
 }
 
 template <typename T>
 ArrayImpl<T>::ArrayImpl(ArrayImpl&& other) {
-  allocator_.deallocate(data_, size_);
+  release();
 
   size_ = other.size_;
   allocator_ = other.allocator_;
   data_ = other.data_;
+  owner_ = std::move(other.owner_);
+  shared_ = other.shared_;
+  if (other.is_local()) {
+    local_ = other.local_;
+    data_ = &local_;
+  }
 
   other.data_ = nullptr;
 }
@@ -266,36 +335,43 @@ ArrayImpl<T>::ArrayImpl(ArrayImpl&& other) {
 template <typename T>
 template <typename U>
 ArrayImpl<T>::ArrayImpl(const ArrayImpl<U>& other) : size_{other.size()} {
-  data_ = allocator_.allocate(size_);
+  data_ = acquire(size_);
   std::copy(other.begin(), other.end(), data_);
 }
 
 template <typename T>
 ArrayImpl<T>::ArrayImpl(size_t size) : size_{size} {
-  data_ = allocator_.allocate(size);
+  data_ = acquire(size);
 }
 
 template <typename T>
 ArrayImpl<T>::ArrayImpl(size_t size, T value) : size_{size} {
-  data_ = allocator_.allocate(size);
+  data_ = acquire(size);
   std::fill_n(data_, size_, value);
 }
 
 template <typename T>
 ArrayImpl<T>::ArrayImpl(std::vector<T> values) : size_{values.size()} {
-  data_ = allocator_.allocate(size_);
+  data_ = acquire(size_);
   std::copy(values.begin(), values.end(), data_);
 }
 
 template <typename T>
 ArrayImpl<T>::ArrayImpl(std::initializer_list<T> values) : size_{values.size()} {
-  data_ = allocator_.allocate(size_);
+  data_ = acquire(size_);
   std::copy(values.begin(), values.end(), data_);
 }
 
 // template <typename T>
 // ArrayImpl<T>::ArrayImpl(ArrayImpl&& other) {}
 
+template <typename T>
+ArrayImpl<T>::ArrayImpl(T* data, size_t size, std::shared_ptr<void> owner)
+    : size_{size}, data_{data}, owner_{std::move(owner)} {
+  // a borrowed buffer is never handed to the allocator, even without owner
+  if (!owner_) owner_ = std::shared_ptr<void>(std::shared_ptr<void>(), data);
+}
+
 template <typename T>
 ArrayImpl<T>& ArrayImpl<T>::operator=(ArrayImpl copy) {
   swap(*this, copy);
@@ -305,7 +381,64 @@ ArrayImpl<T>& ArrayImpl<T>::operator=(ArrayImpl copy) {
 
 template <typename T>
 ArrayImpl<T>::~ArrayImpl() {
-  allocator_.deallocate(data_, size_);
+  release();
+}
+
+template <typename T>
+void ArrayImpl<T>::rebind(void* ptr, std::shared_ptr<void> owner) {
+  release();
+
+  data_ = static_cast<T*>(ptr);
+  owner_ = std::move(owner);
+}
+
+template <typename T>
+std::shared_ptr<Array> ArrayImpl<T>::share() {
+  // inline scalars are cheaper to copy, and buffers borrowed from a memory
+  // plan may be reused once the plan moves on
+  if (is_local() || (owner_ && !shared_)) {
+    return std::make_shared<ArrayImpl<T>>(*this);
+  }
+
+  if (!owner_) {
+    // hand the buffer over to a block that frees it with the last borrower
+    owner_ = std::shared_ptr<T>(
+        data_, [allocator = allocator_, size = size_](T* ptr) mutable {
+          allocator.deallocate(ptr, size);
+        });
+    shared_ = true;
+  }
+
+  auto sibling = std::make_shared<ArrayImpl<T>>();
+  sibling->size_ = size_;
+  sibling->data_ = data_;
+  sibling->owner_ = owner_;
+  sibling->shared_ = true;
+  return sibling;
+}
+
+template <typename T>
+void ArrayImpl<T>::prepare_write() {
+  version_.fetch_add(1, std::memory_order_relaxed);
+
+  if (shared_ && owner_.use_count() > 1) {
+    T* own = acquire(size_);
+    std::copy_n(data_, size_, own);
+    owner_.reset();
+    shared_ = false;
+    data_ = own;
+  }
+}
+
+template <typename T>
+void ArrayImpl<T>::release() {
+  if (owner_) {
+    owner_.reset();
+  } else if (!is_local()) {
+    allocator_.deallocate(data_, size_);
+  }
+  data_ = nullptr;
+  shared_ = false;
 }
 
 template <typename T>
@@ -350,9 +483,16 @@ template <typename T>
 void ArrayImpl<T>::swap(ArrayImpl<T>& other) noexcept {
   using std::swap;
 
+  // inline elements stay in their object, only the value moves
+  bool local = is_local(), other_local = other.is_local();
   swap(size_, other.size_);
   swap(allocator_, other.allocator_);
   swap(data_, other.data_);
+  swap(owner_, other.owner_);
+  swap(shared_, other.shared_);
+  swap(local_, other.local_);
+  if (other_local) data_ = &local_;
+  if (local) other.data_ = &other.local_;
 }
 
 template <typename T>
@@ -13,6 +13,8 @@
 
 #include "core/visitor.h"
 #include "core/traits.h"
+#include "memory_stats.h"
+#include "profiler.h"
 
 namespace abyss::core {
 
@@ -66,12 +68,29 @@ class DataDispatcher : public T, public Visitable {
   virtual ~DataDispatcher() = default;
 
   using T::desc;
+  // side operands (weights, statistics, ...) are handed to visitors directly
+  using T::data;
   
   void accept(VisitorBase* vis) override {
+    // two relaxed loads when neither the profiler nor site tracking is on
+    if (profiler::is_enabled() || memory::is_tracking_sites()) {
+      profiler::RecordScope scope("visitor");
+      memory::SiteGuard site;
+      instrument(scope, site, vis, nullptr);
+      T::data()->accept(vis);
+      return;
+    }
     T::data()->accept(vis);
   }
 
   void accept(VisitorBase* vis, Visitable* b) override {
+    if (profiler::is_enabled() || memory::is_tracking_sites()) {
+      profiler::RecordScope scope("visitor");
+      memory::SiteGuard site;
+      instrument(scope, site, vis, b);
+      T::data()->accept(vis, b);
+      return;
+    }
     // std::cout<<"dispatch accept (meta) > ";
     // b->accept(vis, T::data());
     T::data()->accept(vis, b);
@@ -90,6 +109,22 @@ class DataDispatcher : public T, public Visitable {
   void accept(VisitorBase* vis, ArrayImpl<double>* a) override {
     T::data()->accept(vis, a);
   }
+
+ private:
+  // only the entry points are instrumented, the inner overloads finish the
+  // double dispatch of the same op
+  void instrument(profiler::RecordScope& scope, memory::SiteGuard& site,
+                  VisitorBase* vis, Visitable* b) {
+    const std::string& name = profiler::detail::type_name(typeid(*vis));
+    site.set(name.c_str());
+    if (!scope.active()) return;
+
+    scope.set_name(name);
+    scope.add_input(T::desc().shape, T::dtype().id());
+    if (auto* other = dynamic_cast<DataDispatcher*>(b)) {
+      scope.add_input(other->desc().shape, other->dtype().id());
+    }
+  }
 };
 
 
@@ -129,6 +164,15 @@ class TypeDispatcher : public T, public Visitable {
   }
 };
 
+/**
+ * @brief typed storage behind a dispatcher, `nullptr` if the tensor is empty
+ * or holds another type.
+ */
+template <typename ValueType, typename T>
+ArrayImpl<ValueType>* array_cast(const DataDispatcher<T>& dp) {
+  return dynamic_cast<ArrayImpl<ValueType>*>(dp.data());
+}
+
 }  // namespace abyss::core
 
 #endif
\ No newline at end of file
@@ -27,7 +27,7 @@ class DTypeImpl : public DTypeBase {
   DTypeImpl() = default;
 
   std::type_index id() const override { return typeid(T); }
-  size_t itemsize() const override { return 0; }
+  size_t itemsize() const override { return sizeof(T); }
 
 //  protected:
   void accept(VisitorBase* vis) override {
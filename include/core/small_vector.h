@@ -0,0 +1,252 @@
+#ifndef ABYSS_CORE_SMALL_VECTOR_H
+#define ABYSS_CORE_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace abyss::core {
+
+/**
+ * @brief vector with inline storage for the first N elements.
+ *
+ * Meant for tensor metadata (shapes, strides, coordinates): up to N elements
+ * live inside the object, so creating and copying one is a memcpy with no
+ * heap allocation. Longer vectors move to the heap. Only trivially copyable
+ * element types are supported.
+ *
+ * It converts to and from `std::vector<T>` so existing interfaces keep
+ * working, though every conversion to `std::vector` allocates.
+ */
+template <typename T, size_t N>
+class SmallVector {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SmallVector only holds trivially copyable types");
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  SmallVector() = default;
+  explicit SmallVector(size_t count, const T& value = T()) {
+    assign(count, value);
+  }
+  SmallVector(std::initializer_list<T> values) {
+    assign(values.begin(), values.end());
+  }
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+  SmallVector(InputIt first, InputIt last) {
+    assign(first, last);
+  }
+  SmallVector(const std::vector<T>& values) {
+    assign(values.begin(), values.end());
+  }
+
+  SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+  SmallVector(SmallVector&& other) noexcept { steal(other); }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) assign(other.begin(), other.end());
+    return *this;
+  }
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      release();
+      steal(other);
+    }
+    return *this;
+  }
+  SmallVector& operator=(std::initializer_list<T> values) {
+    assign(values.begin(), values.end());
+    return *this;
+  }
+
+  ~SmallVector() { release(); }
+
+  operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return capacity_; }
+  // true while the elements live inside the object
+  bool is_inline() const { return data_ == inline_; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  T& operator[](size_t i) { return data_[i]; }
+  const T& operator[](size_t i) const { return data_[i]; }
+  T& front() { return data_[0]; }
+  const T& front() const { return data_[0]; }
+  T& back() { return data_[size_ - 1]; }
+  const T& back() const { return data_[size_ - 1]; }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  const_iterator cbegin() const { return data_; }
+  const_iterator cend() const { return data_ + size_; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  void reserve(size_t capacity) {
+    if (capacity <= capacity_) return;
+
+    T* grown = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+    if (grown == nullptr) throw std::bad_alloc();
+    if (size_ > 0) std::memcpy(grown, data_, size_ * sizeof(T));
+    release();
+    data_ = grown;
+    capacity_ = capacity;
+  }
+
+  void clear() { size_ = 0; }
+
+  void resize(size_t count, const T& value = T()) {
+    reserve(count);
+    if (count > size_) std::fill(data_ + size_, data_ + count, value);
+    size_ = count;
+  }
+
+  void assign(size_t count, const T& value) {
+    clear();
+    resize(count, value);
+  }
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+  void assign(InputIt first, InputIt last) {
+    clear();
+    insert(end(), first, last);
+  }
+  void assign(std::initializer_list<T> values) {
+    assign(values.begin(), values.end());
+  }
+
+  void push_back(const T& value) {
+    if (size_ == capacity_) reserve(capacity_ * 2);
+    data_[size_++] = value;
+  }
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    push_back(T(std::forward<Args>(args)...));
+    return back();
+  }
+  void pop_back() { size_--; }
+
+  iterator insert(const_iterator pos, const T& value) {
+    return insert(pos, 1, value);
+  }
+  iterator insert(const_iterator pos, size_t count, const T& value) {
+    // `value` may live in this vector
+    T copy = value;
+    iterator it = open_gap(pos, count);
+    std::fill_n(it, count, copy);
+    return it;
+  }
+  template <typename InputIt,
+            typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+  iterator insert(const_iterator pos, InputIt first, InputIt last) {
+    // buffered so that `first` may point into this vector or be single pass
+    SmallVector values;
+    for (; first != last; ++first) values.push_back(*first);
+    iterator it = open_gap(pos, values.size());
+    std::copy(values.begin(), values.end(), it);
+    return it;
+  }
+  iterator insert(const_iterator pos, std::initializer_list<T> values) {
+    return insert(pos, values.begin(), values.end());
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+  iterator erase(const_iterator first, const_iterator last) {
+    iterator it = begin() + (first - begin());
+    std::copy(last, cend(), it);
+    size_ -= last - first;
+    return it;
+  }
+
+  friend bool operator==(const SmallVector& a, const SmallVector& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+  friend bool operator!=(const SmallVector& a, const SmallVector& b) {
+    return !(a == b);
+  }
+  friend bool operator<(const SmallVector& a, const SmallVector& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(),
+                                        b.end());
+  }
+
+ private:
+  T* data_ = inline_;
+  size_t size_ = 0;
+  size_t capacity_ = N;
+  T inline_[N];
+
+  void release() {
+    if (!is_inline()) std::free(data_);
+    data_ = inline_;
+    capacity_ = N;
+  }
+
+  // take over `other`'s elements, leaving it empty
+  void steal(SmallVector& other) {
+    if (other.is_inline()) {
+      std::memcpy(inline_, other.inline_, other.size_ * sizeof(T));
+    } else {
+      data_ = other.data_;
+      capacity_ = other.capacity_;
+      other.data_ = other.inline_;
+      other.capacity_ = N;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+  // shift the tail to make room for `count` elements at `pos`
+  iterator open_gap(const_iterator pos, size_t count) {
+    size_t index = pos - begin();
+    if (size_ + count > capacity_) {
+      reserve(std::max(size_ + count, capacity_ * 2));
+    }
+    std::copy_backward(data_ + index, data_ + size_, data_ + size_ + count);
+    size_ += count;
+    return data_ + index;
+  }
+};
+
+template <typename T, size_t N>
+std::ostream& operator<<(std::ostream& os, const SmallVector<T, N>& values) {
+  os << "{";
+  for (size_t i = 0; i < values.size(); i++) {
+    os << (i > 0 ? ", " : " ") << values[i];
+  }
+  return os << " }";
+}
+
+}  // namespace abyss::core
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef ABYSS_CORE_STATIC_DESC_H
+#define ABYSS_CORE_STATIC_DESC_H
+
+/**
+ * @file fixed-rank strided loops.
+ *
+ * Walking a strided array with `unravel_index` costs a division and a heap
+ * allocation per element. `StaticDesc<N>` keeps the shape and strides in
+ * arrays of a compile time rank, so the loops below are instantiated once per
+ * rank and the index math is unrolled. `for_each_offset` dispatches on the
+ * rank once per call, ranks above `kMaxStaticRank` take a generic loop.
+ */
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "small_vector.h"
+
+namespace abyss::core {
+
+constexpr int kMaxStaticRank = 6;
+
+/**
+ * @brief shapes, strides and coordinates, inline up to the fixed ranks.
+ */
+using DimVector = SmallVector<int, kMaxStaticRank>;
+
+template <int N>
+struct StaticDesc {
+  size_t offset = 0;
+  std::array<int, N> shape{};
+  std::array<int, N> strides{};
+
+  /**
+   * @brief `shape` and `strides` must have N entries.
+   */
+  static StaticDesc from(const DimVector& shape, const DimVector& strides,
+                         size_t offset = 0) {
+    StaticDesc desc;
+    desc.offset = offset;
+    for (int i = 0; i < N; i++) {
+      desc.shape[i] = shape[i];
+      desc.strides[i] = strides[i];
+    }
+    return desc;
+  }
+};
+
+namespace detail {
+
+template <int D, int N, size_t K, typename Callable>
+inline void walk(const std::array<int, N>& shape,
+                 const std::array<std::array<int, N>, K>& strides,
+                 std::array<size_t, K> offsets, Callable& fn) {
+  for (int i = 0; i < shape[D]; i++) {
+    if constexpr (D + 1 == N) {
+      fn(offsets);
+    } else {
+      walk<D + 1, N>(shape, strides, offsets, fn);
+    }
+    for (size_t k = 0; k < K; k++) offsets[k] += strides[k][D];
+  }
+}
+
+/**
+ * @brief odometer over any rank, including 0 (a single element).
+ */
+template <size_t K, typename Callable>
+void walk_dynamic(const DimVector& shape,
+                  const std::array<const DimVector*, K>& strides,
+                  std::array<size_t, K> offsets, Callable& fn) {
+  for (int extent : shape) {
+    if (extent == 0) return;
+  }
+
+  const int rank = shape.size();
+  DimVector coords(rank, 0);
+  while (true) {
+    fn(offsets);
+
+    int d = rank - 1;
+    for (; d >= 0; d--) {
+      for (size_t k = 0; k < K; k++) offsets[k] += (*strides[k])[d];
+      if (++coords[d] < shape[d]) break;
+      for (size_t k = 0; k < K; k++) {
+        offsets[k] -= size_t((*strides[k])[d]) * shape[d];
+      }
+      coords[d] = 0;
+    }
+    if (d < 0) return;
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief call `fn(std::integral_constant<int, N>{})` with the tensor rank, or
+ * with N = 0 for ranks without a fixed-rank instantiation.
+ */
+template <typename Callable>
+decltype(auto) dispatch_rank(size_t rank, Callable&& fn) {
+  switch (rank) {
+    case 1:
+      return fn(std::integral_constant<int, 1>{});
+    case 2:
+      return fn(std::integral_constant<int, 2>{});
+    case 3:
+      return fn(std::integral_constant<int, 3>{});
+    case 4:
+      return fn(std::integral_constant<int, 4>{});
+    case 5:
+      return fn(std::integral_constant<int, 5>{});
+    case 6:
+      return fn(std::integral_constant<int, 6>{});
+    default:
+      return fn(std::integral_constant<int, 0>{});
+  }
+}
+
+/**
+ * @brief visit `shape` in row-major order with the offsets of K arrays.
+ *
+ * Each array is given by its strides over `shape` (0 for broadcast axes) and
+ * starting offset, `fn` receives a `std::array<size_t, K>` of the current
+ * element offsets.
+ */
+template <size_t K, typename Callable>
+void for_each_offset(const DimVector& shape,
+                     const std::array<const DimVector*, K>& strides,
+                     const std::array<size_t, K>& offsets, Callable&& fn) {
+  dispatch_rank(shape.size(), [&](auto rank) {
+    constexpr int N = decltype(rank)::value;
+    if constexpr (N == 0) {
+      detail::walk_dynamic<K>(shape, strides, offsets, fn);
+    } else {
+      auto fixed = StaticDesc<N>::from(shape, shape);
+      std::array<std::array<int, N>, K> fixed_strides;
+      for (size_t k = 0; k < K; k++) {
+        fixed_strides[k] = StaticDesc<N>::from(shape, *strides[k]).strides;
+      }
+      detail::walk<0, N>(fixed.shape, fixed_strides, offsets, fn);
+    }
+  });
+}
+
+/**
+ * @brief offsets of every element of a strided array, in row-major order.
+ */
+inline std::vector<size_t> strided_offsets(const DimVector& shape,
+                                           const DimVector& strides,
+                                           size_t offset = 0) {
+  size_t size = 1;
+  for (int extent : shape) size *= extent;
+
+  std::vector<size_t> out(size);
+  size_t* it = out.data();
+  for_each_offset<1>(shape, {&strides}, {offset},
+                     [&](const std::array<size_t, 1>& o) { *it++ = o[0]; });
+  return out;
+}
+
+}  // namespace abyss::core
+
+#endif
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "abyss_export.h"
+#include "static_desc.h"
 
 namespace abyss::core {
 
@@ -20,8 +21,8 @@ namespace abyss::core {
  */
 struct ArrayDesc {
   size_t offset = 0;
-  std::vector<int> shape;
-  std::vector<int> strides;
+  DimVector shape;
+  DimVector strides;
 };
 
 /**
@@ -94,7 +95,7 @@ class TensorFlags {
 /**
  * @brief calculate array element size from the shape
  */
-inline size_t shape2size(const std::vector<int>& shape) {
+inline size_t shape2size(const DimVector& shape) {
   auto length =
       std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<int>());
 
@@ -104,8 +105,8 @@ inline size_t shape2size(const std::vector<int>& shape) {
 /**
  * @brief calculate strides from the shape
  */
-inline std::vector<int> shape2strides(const std::vector<int>& shape) {
-  std::vector<int> strides(shape.size(), 1);
+inline DimVector shape2strides(const DimVector& shape) {
+  DimVector strides(shape.size(), 1);
 
   for (int i = shape.size() - 1; i >= 0; i--) {
     strides[i] = std::accumulate(shape.begin() + i + 1, shape.end(), 1,
@@ -115,6 +116,28 @@ inline std::vector<int> shape2strides(const std::vector<int>& shape) {
   return strides;
 }
 
+/**
+ * @brief check if the data is laid out densely in row-major order.
+ *
+ * The offset is not taken into account, axes of size 1 can have any stride.
+ */
+inline bool is_contiguous(const ArrayDesc& desc) {
+  int expected = 1;
+  for (int i = desc.shape.size() - 1; i >= 0; i--) {
+    if (desc.shape[i] != 1 && desc.strides[i] != expected) return false;
+    expected *= desc.shape[i];
+  }
+
+  return true;
+}
+
+/**
+ * @brief offsets of every element of `desc`, in row-major order.
+ */
+inline std::vector<size_t> strided_offsets(const ArrayDesc& desc) {
+  return strided_offsets(desc.shape, desc.strides, desc.offset);
+}
+
 /**
  * @brief calcuate the coordinate/indices from a 1-d index.
  *
@@ -123,9 +146,8 @@ inline std::vector<int> shape2strides(const std::vector<int>& shape) {
  *
  * @return the coordinates of the 1-d `index` based on the `shape`.
  */
-inline std::vector<int> unravel_index(int index,
-                                      const std::vector<int>& shape) {
-  std::vector<int> out(shape.size());
+inline DimVector unravel_index(int index, const DimVector& shape) {
+  DimVector out(shape.size());
 
   for (int i = shape.size() - 1; i >= 0; i--) {
     out[i] = index % shape[i];
@@ -143,8 +165,8 @@ inline std::vector<int> unravel_index(int index,
 /**
  * @brief check if the shape are boardcast compatible
  */
-inline bool is_broadcastable(const std::vector<int>& shape1,
-                             const std::vector<int>& shape2) noexcept {
+inline bool is_broadcastable(const DimVector& shape1,
+                             const DimVector& shape2) noexcept {
   size_t min_dim = std::min(shape1.size(), shape2.size());
 
   auto it1 = shape1.rbegin();
@@ -162,37 +184,14 @@ inline bool is_broadcastable(const std::vector<int>& shape1,
 template <typename InputIt, typename OutputIt>
 OutputIt copy(InputIt first, InputIt last, ArrayDesc desc, OutputIt d_first,
               ArrayDesc d_desc) {
-  first += desc.offset;
-  d_first += d_desc.offset;
-
-  // raw index to iterate through
-  size_t index = 0;
-  size_t offset = 0;
-  size_t d_offset = 0;
-  // size_t acc_d_offset = 0;
-  while (index < shape2size(desc.shape)) {
-    // calculate output offset
-    auto d_coords = unravel_index(index, d_desc.shape);
-    d_offset = 0;
-    for (size_t i = 0; i < d_desc.strides.size(); i++) {
-      d_offset += d_desc.strides[i] * d_coords[i];
-    }
-
-    // calculate input offset
-    auto coords = unravel_index(index, desc.shape);
-    offset = 0;
-    for (size_t i = 0; i < desc.strides.size(); i++) {
-      offset += desc.strides[i] * coords[i];
-    }
-
-    *(d_first + d_offset) = *(first + offset);  // assign to output
-
-    // d_first[d_offset] = first[offset];
-
-    // std::cout<< d_offset << ", " << offset << std::endl;
-    // std::cout<< d_offset << ", " << *(first + offset) << std::endl;
-
-    index++;
+  // the shapes may differ as long as the sizes match
+  auto offsets = strided_offsets(desc);
+  auto d_offsets = strided_offsets(d_desc);
+
+  size_t d_offset = d_desc.offset;
+  for (size_t i = 0; i < offsets.size(); i++) {
+    d_offset = d_offsets[i];
+    *(d_first + d_offset) = *(first + offsets[i]);  // assign to output
   }
 
   return d_first + d_offset + 1;
@@ -237,32 +236,13 @@ OutputIt broadcast_copy(InputIt first, InputIt last, ArrayDesc desc,
   }
 
   // copy the data
-  first += desc.offset;
-  d_first += d_desc.offset;
-
-  size_t arr_size = shape2size(d_desc.shape);
-  // basic index to go through
-  size_t index = 0;
-  // actual offsets / index of the array
-  size_t offset = 0;
-  size_t d_offset = 0;
-  while (index < arr_size) {
-    auto coords = unravel_index(index, d_desc.shape);
-    offset = 0;
-    for (size_t i = 0; i < coords.size(); i++) {
-      offset += coords[i] * desc.strides[i];
-    }
-    d_offset = 0;
-    for (size_t i = 0; i < coords.size(); i++) {
-      d_offset += coords[i] * d_desc.strides[i];
-    }
-
-    *(d_first + d_offset) = *(first + offset);
-
-    // std::cout<< d_offset << ", " << offset<<std::endl;
-
-    index++;
-  }
+  size_t d_offset = d_desc.offset;
+  for_each_offset<2>(d_desc.shape, {&desc.strides, &d_desc.strides},
+                     {desc.offset, d_desc.offset},
+                     [&](const std::array<size_t, 2>& o) {
+                       *(d_first + o[1]) = *(first + o[0]);
+                       d_offset = o[1];
+                     });
 
   return d_first + d_offset + 1;
 }
@@ -0,0 +1,55 @@
+#ifndef ABYSS_DISTRIBUTED_DATA_PARALLEL_H
+#define ABYSS_DISTRIBUTED_DATA_PARALLEL_H
+
+#include <memory>
+#include <vector>
+
+#include "abyss_export.h"
+#include "distributed/process_group.h"
+#include "nn/module.h"
+#include "tensor.h"
+
+namespace abyss::distributed {
+
+/**
+ * @brief data parallel training of a module replicated on every rank.
+ *
+ * The parameters are broadcast from rank 0 on construction. During backward
+ * the gradients are grouped into buckets (last layers first) and each bucket
+ * is averaged over the ranks on a background thread as soon as all of its
+ * gradients are ready, overlapping communication with the rest of backward.
+ *
+ * Call `synchronize` between backward and the optimizer step, a second
+ * backward before it throws. Every rank has to build the same model and run
+ * the same number of steps, shard the data with `DataLoader::shard`.
+ *
+ * Do not combine it with `Optimizer::overlap_with_backward`: the overlapped
+ * updates would run on the local gradients before they are averaged.
+ */
+class ABYSS_EXPORT DistributedDataParallel : public nn::Module {
+ public:
+  DistributedDataParallel(nn::Module& module, ProcessGroup& group);
+  ~DistributedDataParallel();
+
+  nn::Module& module() { return module_; }
+
+  /**
+   * @brief wait until every gradient holds its average over the ranks.
+   *
+   * Buckets backward did not complete (unused parameters) are reduced here.
+   */
+  void synchronize();
+
+ protected:
+  Tensor forward(Tensor input) override;
+
+ private:
+  struct Reducer;
+
+  nn::Module& module_;
+  std::shared_ptr<Reducer> reducer_;
+};
+
+}  // namespace abyss::distributed
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef ABYSS_DISTRIBUTED_PROCESS_GROUP_H
+#define ABYSS_DISTRIBUTED_PROCESS_GROUP_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "abyss_export.h"
+#include "tensor.h"
+
+namespace abyss::distributed {
+
+enum class ReduceOp { kSum, kAverage };
+
+/**
+ * @brief collectives between the processes of one machine.
+ *
+ * Every rank maps the same POSIX shared memory segment, which holds a barrier
+ * and one bucket sized buffer per rank. Nothing goes through the network.
+ *
+ * Collectives have to be called in the same order by every rank and only
+ * support contiguous float64 tensors. Larger inputs are processed one bucket
+ * at a time.
+ */
+class ABYSS_EXPORT ProcessGroup {
+ public:
+  static constexpr size_t kDefaultBucketBytes = size_t(4) << 20;
+
+  /**
+   * @param[in] name name of the shared memory segment (e.g. "/abyss-job"),
+   * the same on every rank and unique per job
+   * @param[in] rank rank of this process in `[0, world_size)`
+   * @param[in] world_size number of processes
+   * @param[in] bucket_bytes size of the per rank buffer
+   */
+  ProcessGroup(const std::string& name, int rank, int world_size,
+               size_t bucket_bytes = kDefaultBucketBytes);
+  ~ProcessGroup();
+
+  ProcessGroup(const ProcessGroup&) = delete;
+  ProcessGroup& operator=(const ProcessGroup&) = delete;
+
+  int rank() const;
+  int world_size() const;
+
+  /**
+   * @brief number of elements reduced per ring pass.
+   */
+  size_t bucket_size() const;
+
+  /**
+   * @brief ring all-reduce in place.
+   *
+   * The tensors of one call are packed into shared buckets, so many small
+   * gradients cost the same number of synchronizations as one large one.
+   */
+  void all_reduce(std::vector<Tensor>& tensors, ReduceOp op = ReduceOp::kSum);
+  void all_reduce(Tensor& tensor, ReduceOp op = ReduceOp::kSum);
+
+  /**
+   * @brief overwrite the tensors of every rank with those of `root`.
+   */
+  void broadcast(std::vector<Tensor>& tensors, int root = 0);
+
+  void barrier();
+
+ private:
+  struct Header;
+
+  int rank_;
+  int world_size_;
+  size_t bucket_size_;
+
+  size_t mapped_bytes_ = 0;
+  void* segment_ = nullptr;
+  Header* header_ = nullptr;
+
+  double* slot(int rank) const;
+  void ring_reduce(size_t n);
+};
+
+}  // namespace abyss::distributed
+
+#endif
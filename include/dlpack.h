@@ -0,0 +1,111 @@
+#ifndef ABYSS_DLPACK_H
+#define ABYSS_DLPACK_H
+
+/**
+ * @file zero-copy exchange with other libraries through DLPack.
+ *
+ * `to_dlpack` hands the storage of a tensor to another library as a
+ * `DLManagedTensor`, `from_dlpack` wraps one produced elsewhere. Neither
+ * copies, the two sides read and write the same memory.
+ */
+
+#include <cstdint>
+
+#include "abyss_export.h"
+#include "tensor.h"
+
+// the structs below are the DLPack 0.8 ABI, skipped when the upstream header
+// is included first (they share its include guard)
+#ifndef DLPACK_DLPACK_H_
+#define DLPACK_DLPACK_H_
+
+#define DLPACK_VERSION 80
+#define DLPACK_ABI_VERSION 1
+
+extern "C" {
+
+typedef enum {
+  kDLCPU = 1,
+  kDLCUDA = 2,
+  kDLCUDAHost = 3,
+  kDLOpenCL = 4,
+  kDLVulkan = 7,
+  kDLMetal = 8,
+  kDLVPI = 9,
+  kDLROCM = 10,
+  kDLROCMHost = 11,
+  kDLExtDev = 12,
+  kDLCUDAManaged = 13,
+  kDLOneAPI = 14,
+  kDLWebGPU = 15,
+  kDLHexagon = 16,
+} DLDeviceType;
+
+typedef struct {
+  DLDeviceType device_type;
+  int32_t device_id;
+} DLDevice;
+
+typedef enum {
+  kDLInt = 0U,
+  kDLUInt = 1U,
+  kDLFloat = 2U,
+  kDLOpaqueHandle = 3U,
+  kDLBfloat = 4U,
+  kDLComplex = 5U,
+  kDLBool = 6U,
+} DLDataTypeCode;
+
+typedef struct {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+  void* data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t* shape;
+  // in elements, NULL for compact row-major
+  int64_t* strides;
+  uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void* manager_ctx;
+  void (*deleter)(struct DLManagedTensor* self);
+} DLManagedTensor;
+
+}  // extern "C"
+
+#endif
+
+namespace abyss {
+
+/**
+ * @brief export a tensor without copying it.
+ *
+ * The returned tensor keeps the storage alive until its `deleter` is called,
+ * which the consumer must do exactly once. Exporting counts as a write: the
+ * consumer may modify the memory, so the version is bumped and a
+ * copy-on-write storage gets a buffer of its own first.
+ */
+ABYSS_EXPORT DLManagedTensor* to_dlpack(const Tensor& tensor);
+
+/**
+ * @brief wrap a DLPack tensor without copying it.
+ *
+ * Only CPU tensors of bool, uint8, int32 and float64 with non-negative
+ * strides are accepted. On success the tensor takes ownership of `managed`
+ * and calls its deleter once the storage is released, on failure it throws
+ * and ownership stays with the caller. Tensors exported by `to_dlpack` come
+ * back as the tensor they came from.
+ */
+ABYSS_EXPORT Tensor from_dlpack(DLManagedTensor* managed);
+
+}  // namespace abyss
+
+#endif
@@ -11,6 +11,7 @@
 #include "core/dispatcher.h"
 #include "core/visitor.h"
 // #include "ops/dtype_ops.h"
+#include "random.h"
 #include "tensor.h"
 
 namespace abyss {
@@ -39,6 +40,7 @@ ABYSS_EXPORT Tensor arange(T1 start, T2 stop, T3 step, ScalarType dtype = kNone)
     
     void visit(core::DTypeImpl<uint8_t>* dtype) override {
       auto arr = ArrayImpl<common_t>::from_range(start_, stop_, step_);
+      dtype_ = dtype;
       desc_.shape = {static_cast<int>(arr.size())};
       desc_.strides = {1};
       data_ = std::make_shared<ArrayImpl<uint8_t>>(arr);
@@ -46,6 +48,7 @@ ABYSS_EXPORT Tensor arange(T1 start, T2 stop, T3 step, ScalarType dtype = kNone)
 
     void visit(core::DTypeImpl<int32_t>* dtype) override {
       auto arr = ArrayImpl<common_t>::from_range(start_, stop_, step_);
+      dtype_ = dtype;
       desc_.shape = {static_cast<int>(arr.size())};
       desc_.strides = {1};
       data_ = std::make_shared<ArrayImpl<int32_t>>(arr);
@@ -53,6 +56,7 @@ ABYSS_EXPORT Tensor arange(T1 start, T2 stop, T3 step, ScalarType dtype = kNone)
     }
     void visit(core::DTypeImpl<double>* dtype) override {
       auto arr = ArrayImpl<common_t>::from_range(start_, stop_, step_);
+      dtype_ = dtype;
       desc_.shape = {static_cast<int>(arr.size())};
       desc_.strides = {1};
       data_ = std::make_shared<ArrayImpl<double>>(arr);
@@ -79,7 +83,20 @@ ABYSS_EXPORT Tensor arange(T stop, ScalarType dtype = kNone) {
   return arange(0, stop, 1, dtype);
 }
 
+/**
+ * @brief samples from the standard normal distribution.
+ *
+ * Draws from the default generator unless one is given.
+ */
 ABYSS_EXPORT Tensor randn(std::vector<int> shape, ScalarType dtype = kNone);
+ABYSS_EXPORT Tensor randn(std::vector<int> shape, Generator& generator,
+                          ScalarType dtype = kNone);
+/**
+ * @brief samples from the uniform distribution [0, 1).
+ */
+ABYSS_EXPORT Tensor rand(std::vector<int> shape, ScalarType dtype = kNone);
+ABYSS_EXPORT Tensor rand(std::vector<int> shape, Generator& generator,
+                         ScalarType dtype = kNone);
 
 ABYSS_EXPORT Tensor concat(std::vector<Tensor> tensors, int axis = 0);
 /**
@@ -101,6 +118,123 @@ ABYSS_EXPORT Tensor sum(Tensor a, int axis);
 
 ABYSS_EXPORT Tensor negative(Tensor a);
 
+/**
+ * @brief pointwise nonlinearities with a fused kernel.
+ *
+ * GELU is the exact (erf) form.
+ */
+enum class Activation { kIdentity, kReLU, kGELU, kSigmoid, kTanh };
+
+ABYSS_EXPORT Tensor relu(Tensor a);
+ABYSS_EXPORT Tensor gelu(Tensor a);
+ABYSS_EXPORT Tensor sigmoid(Tensor a);
+ABYSS_EXPORT Tensor tanh(Tensor a);
+
+/**
+ * @brief in-place variants, `a` is overwritten and rebound to the result.
+ *
+ * Not available for leaves that require grad. There is no in-place GELU
+ * under autograd as its backward needs the original input.
+ */
+ABYSS_EXPORT Tensor& relu_(Tensor& a);
+ABYSS_EXPORT Tensor& sigmoid_(Tensor& a);
+ABYSS_EXPORT Tensor& tanh_(Tensor& a);
+
+/**
+ * @brief act(input + bias) in a single pass, `bias` holds one value per entry
+ * of `input` along `axis` (e.g. the output features of a linear layer).
+ */
+ABYSS_EXPORT Tensor bias_activation(Tensor input, Tensor bias, int axis,
+                                    Activation act);
+
+/**
+ * @brief act(weight * input + bias) of a (out, in) weight and (in, batch)
+ * input, `bias` holds one value per output row.
+ *
+ * A single pass over the output: GEMM accumulates into the bias and the
+ * activation is applied while the result is in cache.
+ */
+ABYSS_EXPORT Tensor linear(Tensor input, Tensor weight, Tensor bias = Tensor(),
+                           Activation act = Activation::kIdentity);
+
+/**
+ * @brief 2d convolution of a (N, C, H, W) input.
+ *
+ * @param weight (out_channels, C / groups, kernel_h, kernel_w) filters
+ * @param bias (out_channels) offsets, may be left empty
+ */
+ABYSS_EXPORT Tensor conv2d(Tensor input, Tensor weight, Tensor bias = Tensor(),
+                           int stride = 1, int padding = 0, int dilation = 1,
+                           int groups = 1);
+
+/**
+ * @brief 2d max/average pooling of a (N, C, H, W) input.
+ *
+ * A `stride` of 0 uses the kernel size. Average pooling counts padded
+ * positions as zeros.
+ */
+ABYSS_EXPORT Tensor max_pool2d(Tensor input, int kernel_size, int stride = 0,
+                               int padding = 0);
+ABYSS_EXPORT Tensor avg_pool2d(Tensor input, int kernel_size, int stride = 0,
+                               int padding = 0);
+
+/**
+ * @brief normalize every channel (axis 1) of the input.
+ *
+ * In training the batch statistics are used and `running_mean`/`running_var`
+ * are updated in place, otherwise the running statistics are used.
+ */
+ABYSS_EXPORT Tensor batch_norm(Tensor input, Tensor running_mean,
+                               Tensor running_var, Tensor weight = Tensor(),
+                               Tensor bias = Tensor(), bool training = false,
+                               double momentum = 0.1, double eps = 1e-5);
+/**
+ * @brief normalize over the trailing axes given by `normalized_shape`.
+ */
+ABYSS_EXPORT Tensor layer_norm(Tensor input, std::vector<int> normalized_shape,
+                               Tensor weight = Tensor(), Tensor bias = Tensor(),
+                               double eps = 1e-5);
+
+/**
+ * @brief mean cross entropy of (batch, classes) scores against class IDs.
+ *
+ * Fused log-softmax + negative log likelihood, numerically stable for large
+ * scores.
+ */
+ABYSS_EXPORT Tensor cross_entropy(Tensor input, Tensor target);
+
+/**
+ * @brief mean negative log likelihood of (batch, classes) log probabilities
+ * against class IDs.
+ */
+ABYSS_EXPORT Tensor nll_loss(Tensor input, Tensor target);
+
+/**
+ * runtime settings
+ */
+
+/**
+ * @brief number of threads used by the native kernels.
+ *
+ * Defaults to the `ABYSS_NUM_THREADS` environment variable or the number of
+ * hardware threads.
+ */
+ABYSS_EXPORT void set_num_threads(int n);
+ABYSS_EXPORT int get_num_threads();
+
+/**
+ * @brief defer copies until something is written, off by default.
+ *
+ * With copy-on-write on, `Tensor::copy()` of a dense tensor and the tensors
+ * autograd saves for backward share the storage of their source. The first
+ * write to either side (an in-place op, an assignment to a view, an optimizer
+ * step) gives it a buffer of its own, so saved tensors keep the values the
+ * forward pass saw. With it off, saved tensors alias their source and
+ * backward throws if one was modified in place since it was saved.
+ */
+ABYSS_EXPORT void set_copy_on_write(bool enabled);
+ABYSS_EXPORT bool copy_on_write_enabled();
+
 /**
  * complex layer types
  * maybe move to layers
@@ -0,0 +1,130 @@
+#ifndef ABYSS_JIT_H
+#define ABYSS_JIT_H
+
+/**
+ * @file fused element-wise expressions with an optional JIT.
+ *
+ * An `Expr` describes a chain of element-wise ops over its inputs, e.g.
+ * `exp(jit::input(0)) * jit::input(1) + 1.0`. `FusedKernel` evaluates it,
+ * either op by op with the regular tensor ops (the interpreter) or, when the
+ * JIT is enabled, in one pass with C++ generated for the expression, the
+ * input dtypes, the rank and which inputs are contiguous.
+ *
+ * Generated kernels are built with the system compiler into shared objects in
+ * a cache directory, keyed by a hash of their source, the compiler and the
+ * host CPU (kernels use `-march=native`), and `dlopen`ed. Building
+ * happens in the background, calls keep running on the interpreter until the
+ * kernel is loaded. Later processes load it straight from the cache.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "abyss_export.h"
+#include "tensor.h"
+
+namespace abyss::jit {
+
+class ABYSS_EXPORT Expr {
+ public:
+  enum class Op { kInput, kConstant, kAdd, kSub, kMul, kDiv, kNeg, kExp, kLog };
+
+  // constants, implicit so `x * 2.0` reads naturally
+  Expr(double value);
+  static Expr input(int index);
+  static Expr apply(Op op, std::vector<Expr> args);
+
+  Op op() const;
+  int index() const;
+  double value() const;
+  const std::vector<Expr>& args() const;
+
+  /**
+   * @brief number of inputs the expression reads (highest index + 1).
+   */
+  int num_inputs() const;
+
+  /**
+   * @brief canonical text form, e.g. `add(exp(x0), 1)`.
+   */
+  std::string str() const;
+
+ private:
+  struct Node;
+  std::shared_ptr<const Node> node_;
+
+  explicit Expr(std::shared_ptr<const Node> node);
+};
+
+inline Expr input(int index) { return Expr::input(index); }
+
+ABYSS_EXPORT Expr operator+(Expr a, Expr b);
+ABYSS_EXPORT Expr operator-(Expr a, Expr b);
+ABYSS_EXPORT Expr operator*(Expr a, Expr b);
+ABYSS_EXPORT Expr operator/(Expr a, Expr b);
+ABYSS_EXPORT Expr operator-(Expr a);
+ABYSS_EXPORT Expr exp(Expr a);
+ABYSS_EXPORT Expr log(Expr a);
+
+/**
+ * @brief evaluates an expression on tensors.
+ *
+ * Inputs broadcast like the tensor ops and the result has the same dtype.
+ * Only int32 and float64 inputs are compiled. Calls that have to record
+ * gradients always run on the interpreter, which builds the graph.
+ */
+class ABYSS_EXPORT FusedKernel {
+ public:
+  explicit FusedKernel(Expr expr);
+
+  Tensor operator()(const std::vector<Tensor>& inputs) const;
+
+  const Expr& expr() const { return expr_; }
+
+ private:
+  Expr expr_;
+};
+
+/**
+ * @brief evaluate op by op, what the JIT falls back to.
+ */
+ABYSS_EXPORT Tensor interpret(const Expr& expr,
+                              const std::vector<Tensor>& inputs);
+
+/**
+ * @brief turn the JIT on or off, off unless `ABYSS_JIT=1`.
+ */
+ABYSS_EXPORT void set_enabled(bool enabled);
+ABYSS_EXPORT bool is_enabled();
+
+/**
+ * @brief where kernels are built and cached.
+ *
+ * Defaults to `ABYSS_JIT_CACHE`, else `jit` under `$XDG_CACHE_HOME/abyss` (or
+ * `~/.cache/abyss`). Without a home it is `/tmp/abyss-jit-<uid>`, created
+ * private to the user, or a fresh temporary directory if that name is taken by
+ * anyone else. Changing it forgets the kernels loaded so far. The compiler is
+ * `ABYSS_JIT_CXX` (split on spaces, run without a shell), `c++` if unset.
+ */
+ABYSS_EXPORT void set_cache_dir(const std::string& dir);
+ABYSS_EXPORT std::string cache_dir();
+
+/**
+ * @brief block until the kernels being built are done.
+ */
+ABYSS_EXPORT void wait();
+
+struct Stats {
+  size_t compiled = 0;   // built by this process
+  size_t loaded = 0;     // found in the cache
+  size_t failed = 0;     // could not be built or loaded
+  size_t compiled_calls = 0;
+  size_t interpreted_calls = 0;
+};
+ABYSS_EXPORT Stats stats();
+
+}  // namespace abyss::jit
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef ABYSS_MEMORY_STATS_H
+#define ABYSS_MEMORY_STATS_H
+
+/**
+ * @file memory accounting.
+ *
+ * Every buffer allocated by `core::Allocator` is counted: live and peak bytes
+ * and allocation counts are always kept. Attributing buffers to call sites
+ * keeps a table of live buffers and is turned on with `track_sites`.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "abyss_export.h"
+
+namespace abyss::memory {
+
+struct Stats {
+  size_t live_bytes = 0;
+  size_t peak_bytes = 0;
+  size_t allocations = 0;
+  size_t frees = 0;
+};
+
+struct SiteStats {
+  std::string site;
+  size_t live_bytes = 0;
+  size_t peak_bytes = 0;
+  size_t allocations = 0;
+  // part of `live_bytes` held by saved tensors, filled by `snapshot()`
+  size_t graph_bytes = 0;
+};
+
+/**
+ * @brief a tensor kept alive by the autograd graph for backward.
+ */
+struct SavedTensor {
+  std::string node;  // backward node that saved it
+  std::string site;  // where its buffer was allocated, if tracked
+  std::vector<int> shape;
+  std::string dtype;
+  size_t nbytes = 0;  // of the whole buffer, views retain all of it
+};
+
+struct Snapshot {
+  Stats stats;
+  // unique buffers held by saved tensors of the calling thread's graph
+  size_t graph_bytes = 0;
+  // everything else that is live
+  size_t free_bytes = 0;
+  // largest first
+  std::vector<SavedTensor> saved;
+  // largest live first, empty unless sites are tracked
+  std::vector<SiteStats> sites;
+};
+
+namespace detail {
+ABYSS_EXPORT extern std::atomic<bool> tracking_sites;
+
+ABYSS_EXPORT void on_allocate(const void* ptr, size_t nbytes);
+ABYSS_EXPORT void on_free(const void* ptr, size_t nbytes);
+ABYSS_EXPORT const char* current_site();
+ABYSS_EXPORT void set_current_site(const char* site);
+}  // namespace detail
+
+/**
+ * @brief process wide counters.
+ */
+ABYSS_EXPORT Stats stats();
+/**
+ * @brief restart peak tracking from the current live bytes.
+ */
+ABYSS_EXPORT void reset_peak();
+
+/**
+ * @brief attribute allocations to sites from now on.
+ *
+ * Buffers allocated before tracking started are not attributed. Disabling
+ * drops the site table.
+ */
+ABYSS_EXPORT void track_sites(bool enable);
+inline bool is_tracking_sites() {
+  return detail::tracking_sites.load(std::memory_order_relaxed);
+}
+ABYSS_EXPORT std::vector<SiteStats> site_stats();
+
+/**
+ * @brief counters, the live sites and what the calling thread's graph holds.
+ */
+ABYSS_EXPORT Snapshot snapshot();
+ABYSS_EXPORT std::ostream& operator<<(std::ostream& os,
+                                      const Snapshot& snapshot);
+
+/**
+ * @brief label allocations of the calling thread while in scope.
+ *
+ * The outermost label wins, ops label their own allocations (by visitor)
+ * when nothing else does.
+ */
+class SiteGuard {
+ public:
+  SiteGuard() = default;
+  explicit SiteGuard(const char* site) { set(site); }
+  ~SiteGuard() {
+    if (active_) detail::set_current_site(nullptr);
+  }
+
+  SiteGuard(const SiteGuard&) = delete;
+  SiteGuard& operator=(const SiteGuard&) = delete;
+
+  void set(const char* site) {
+    if (active_ || detail::current_site() != nullptr) return;
+    active_ = true;
+    detail::set_current_site(site);
+  }
+
+ private:
+  bool active_ = false;
+};
+
+}  // namespace abyss::memory
+
+#endif
@@ -14,5 +14,36 @@ class ABYSS_EXPORT LogSoftmax : public Module {
  private:
   int axis_;
 };
+
+/**
+ * @brief rectified linear unit, `inplace` overwrites the input.
+ */
+class ABYSS_EXPORT ReLU : public Module {
+ public:
+  explicit ReLU(bool inplace = false);
+
+  Tensor forward(Tensor input) override;
+
+ private:
+  bool inplace_;
+};
+
+/**
+ * @brief gaussian error linear unit (exact erf form).
+ */
+class ABYSS_EXPORT GELU : public Module {
+ public:
+  Tensor forward(Tensor input) override;
+};
+
+class ABYSS_EXPORT Sigmoid : public Module {
+ public:
+  Tensor forward(Tensor input) override;
+};
+
+class ABYSS_EXPORT Tanh : public Module {
+ public:
+  Tensor forward(Tensor input) override;
+};
 }  // namespace abyss::nn
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef ABYSS_NN_CONVOLUTION_H
+#define ABYSS_NN_CONVOLUTION_H
+
+#include "abyss_export.h"
+#include "module.h"
+
+namespace abyss::nn {
+/**
+ * @brief 2d convolution over (N, C, H, W) batches.
+ *
+ * `groups == in_channels == out_channels` gives a depthwise convolution.
+ */
+class ABYSS_EXPORT Conv2d : public Module {
+ public:
+  Conv2d(int in_channels, int out_channels, int kernel_size, int stride = 1,
+         int padding = 0, int dilation = 1, int groups = 1, bool bias = true);
+
+  Tensor weight() const { return weight_; }
+  Tensor bias() const { return bias_; }
+
+  Tensor forward(Tensor input) override;
+
+ private:
+  Tensor weight_;
+  Tensor bias_;
+  int stride_;
+  int padding_;
+  int dilation_;
+  int groups_;
+};
+}  // namespace abyss::nn
+
+#endif
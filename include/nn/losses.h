@@ -4,12 +4,12 @@
 #include "module.h"
 
 namespace abyss::nn {
-// class ABYSS_EXPORT CrossEntropyLoss : public Module {
-//   public:
-//   CrossEntropyLoss() = default;
-  
-//   Tensor forward(Tensor input, Tensor target) override;
-// };
+class ABYSS_EXPORT CrossEntropyLoss : public Module {
+  public:
+  CrossEntropyLoss() = default;
+
+  Tensor forward(Tensor input, Tensor target) override;
+};
 class ABYSS_EXPORT NLLLoss : public Module {
   public:
   NLLLoss() = default;
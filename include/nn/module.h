@@ -39,18 +39,34 @@ class ABYSS_EXPORT Module {
  public:
   virtual ~Module() = default;
 
+  /**
+   * @brief parameters of the modules constructed on the calling thread.
+   *
+   * Registration is per thread, so threads can build and train their own
+   * models concurrently. Build a model on the thread that optimizes it, any
+   * thread may run its forward.
+   */
   std::vector<Tensor>& parameters();
 
+  /**
+   * @brief switch between training and evaluation behaviour (e.g. batch
+   * statistics vs. running statistics).
+   */
+  void train(bool mode = true);
+  void eval();
+  bool is_training() const;
+
   template <typename... Args>
   Tensor operator()(Args... args) {
     return forward(std::forward<Tensor>(args)...);
   }
 
  protected:
-  static std::vector<Tensor> parameters_;
-  static std::unordered_map<std::string, Tensor*> states_;
+  static thread_local std::vector<Tensor> parameters_;
+  static thread_local std::unordered_map<std::string, Tensor*> states_;
 
   std::unordered_map<std::string, Tensor*> local_states_;
+  bool training_ = true;
 
   Module() = default;
   // forward functions are no-op because different child might have different
@@ -62,9 +78,15 @@ class ABYSS_EXPORT Module {
   friend Tensor& make_parameter(Tensor data, bool requires_grad);
 };
 
+/**
+ * @brief y = act(W x + b) of column inputs (in_features, batch).
+ *
+ * The bias and the activation are applied in one pass over the product.
+ */
 class ABYSS_EXPORT Linear : public Module {
  public:
-  Linear(int in_features, int out_features, bool bias = true);
+  Linear(int in_features, int out_features, bool bias = true,
+         Activation activation = Activation::kIdentity);
 
   Tensor weight() const { return weight_; }
   Tensor bias() const { return bias_; }
@@ -74,6 +96,7 @@ class ABYSS_EXPORT Linear : public Module {
  private:
   Tensor weight_;
   Tensor bias_;
+  Activation activation_;
 };
 
 }  // namespace abyss::nn
@@ -0,0 +1,59 @@
+#ifndef ABYSS_NN_NORMALIZATION_H
+#define ABYSS_NN_NORMALIZATION_H
+
+#include <vector>
+
+#include "abyss_export.h"
+#include "module.h"
+
+namespace abyss::nn {
+/**
+ * @brief batch normalization of (N, C, H, W) input.
+ *
+ * Uses the batch statistics while training and the running statistics after
+ * `eval()`.
+ */
+class ABYSS_EXPORT BatchNorm2d : public Module {
+ public:
+  BatchNorm2d(int num_features, double eps = 1e-5, double momentum = 0.1,
+              bool affine = true);
+
+  Tensor weight() const { return weight_; }
+  Tensor bias() const { return bias_; }
+  Tensor running_mean() const { return running_mean_; }
+  Tensor running_var() const { return running_var_; }
+
+  Tensor forward(Tensor input) override;
+
+ private:
+  Tensor weight_;
+  Tensor bias_;
+  Tensor running_mean_;
+  Tensor running_var_;
+  double eps_;
+  double momentum_;
+};
+
+/**
+ * @brief normalization over the trailing `normalized_shape` axes of each
+ * sample.
+ */
+class ABYSS_EXPORT LayerNorm : public Module {
+ public:
+  LayerNorm(std::vector<int> normalized_shape, double eps = 1e-5,
+            bool elementwise_affine = true);
+
+  Tensor weight() const { return weight_; }
+  Tensor bias() const { return bias_; }
+
+  Tensor forward(Tensor input) override;
+
+ private:
+  std::vector<int> normalized_shape_;
+  Tensor weight_;
+  Tensor bias_;
+  double eps_;
+};
+}  // namespace abyss::nn
+
+#endif
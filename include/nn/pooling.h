@@ -0,0 +1,39 @@
+#ifndef ABYSS_NN_POOLING_H
+#define ABYSS_NN_POOLING_H
+
+#include "abyss_export.h"
+#include "module.h"
+
+namespace abyss::nn {
+/**
+ * @brief 2d max pooling, `stride` defaults to the kernel size.
+ */
+class ABYSS_EXPORT MaxPool2d : public Module {
+ public:
+  MaxPool2d(int kernel_size, int stride = 0, int padding = 0);
+
+  Tensor forward(Tensor input) override;
+
+ private:
+  int kernel_size_;
+  int stride_;
+  int padding_;
+};
+
+/**
+ * @brief 2d average pooling, `stride` defaults to the kernel size.
+ */
+class ABYSS_EXPORT AvgPool2d : public Module {
+ public:
+  AvgPool2d(int kernel_size, int stride = 0, int padding = 0);
+
+  Tensor forward(Tensor input) override;
+
+ private:
+  int kernel_size_;
+  int stride_;
+  int padding_;
+};
+}  // namespace abyss::nn
+
+#endif
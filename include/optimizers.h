@@ -1,6 +1,9 @@
 #ifndef ABYSS_OPTIMIZER_H
 #define ABYSS_OPTIMIZER_H
 
+#include <memory>
+#include <vector>
+
 #include "abyss_export.h"
 #include "tensor.h"
 
@@ -8,6 +11,8 @@ namespace abyss::optim {
 
 class ABYSS_EXPORT Optimizer {
  public:
+  virtual ~Optimizer();
+
   /**
    * @brief clear gradients
    * 
@@ -18,12 +23,23 @@ class ABYSS_EXPORT Optimizer {
 
   /**
    * @brief update model parameters based on gradients
+   *
+   * With `overlap_with_backward` this only waits for the updates already
+   * running and applies the remaining ones (parameters backward never
+   * reached).
    */
-  // virtual void step() {
-  //   throw std::runtime_error("pleasae implement the step function for your optimizer.");
-  // }
+  void step();
 
-  virtual void step() = 0;
+  /**
+   * @brief update every parameter as soon as backward has finished its
+   * gradient.
+   *
+   * The updates run on a background thread while backward continues with
+   * earlier layers. `step` (and `zero_grad`) wait for them. Not for models
+   * wrapped in `DistributedDataParallel`, whose gradients are only averaged
+   * by `synchronize`.
+   */
+  void overlap_with_backward(bool enabled = true);
 
  protected:
   std::vector<Tensor>& params_;
@@ -32,6 +48,17 @@ class ABYSS_EXPORT Optimizer {
    * Constructor set as protected becasue this was meant to be extended.
    */
   Optimizer(std::vector<Tensor>& parameters);
+
+  /**
+   * @brief update a single parameter in place from its gradient.
+   */
+  virtual void update(Tensor& param) = 0;
+
+ private:
+  struct Overlap;
+  std::shared_ptr<Overlap> overlap_;
+
+  void synchronize();
 };
 
 /**
@@ -43,7 +70,8 @@ class ABYSS_EXPORT SGD final : public Optimizer {
  public:
   SGD(std::vector<Tensor>& parameters, double lr);
 
-  void step() override;
+ protected:
+  void update(Tensor& param) override;
 
  private:
   double learning_rate_;
@@ -0,0 +1,225 @@
+#ifndef ABYSS_PROFILER_H
+#define ABYSS_PROFILER_H
+
+/**
+ * @file op level profiler.
+ *
+ * Three layers are instrumented: `Function::call` ("function"), the visitor
+ * dispatch of every op ("visitor") and every kernel launch, including kernels
+ * replayed from a captured graph ("kernel"). Scopes nest, so a function event
+ * covers the visitors and kernels it ran.
+ *
+ * Nothing is recorded unless a `Profile` is active, a disabled scope costs
+ * one relaxed atomic load.
+ *
+ * Hardware counters (cycles, instructions, cache, branch and TLB misses) are
+ * read through Linux perf_event. Counters the kernel refuses (no PMU,
+ * `perf_event_paranoid`, other platforms) are reported as unavailable instead
+ * of failing.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+#include "abyss_export.h"
+
+namespace abyss::profiler {
+
+enum class Counter : int {
+  kCycles = 0,
+  kInstructions,
+  kLLCMisses,
+  kBranchMisses,
+  kDTLBMisses,
+};
+constexpr int kNumCounters = 5;
+
+ABYSS_EXPORT const char* counter_name(Counter counter);
+
+struct CounterValues {
+  std::array<uint64_t, kNumCounters> values{};
+  // bit `1 << Counter` is set for every counter that was read
+  unsigned available = 0;
+
+  bool has(Counter counter) const {
+    return (available & (1u << int(counter))) != 0;
+  }
+  uint64_t operator[](Counter counter) const { return values[int(counter)]; }
+
+  /**
+   * @brief instructions per cycle, 0 unless both were counted.
+   */
+  double ipc() const {
+    if (!has(Counter::kCycles) || !has(Counter::kInstructions)) return 0;
+    auto cycles = (*this)[Counter::kCycles];
+    return cycles > 0 ? double((*this)[Counter::kInstructions]) / cycles : 0;
+  }
+};
+
+inline CounterValues operator-(const CounterValues& a, const CounterValues& b) {
+  CounterValues out;
+  out.available = a.available & b.available;
+  for (int i = 0; i < kNumCounters; i++) {
+    // multiplexed counts are scaled estimates and may step back a little
+    out.values[i] = a.values[i] > b.values[i] ? a.values[i] - b.values[i] : 0;
+  }
+  return out;
+}
+
+/**
+ * @brief counters of the calling thread, opened on construction.
+ *
+ * Only user space work of the thread that created it is counted, threads of
+ * the backend pool are not. The counters run from construction on, take the
+ * difference of two `read()`s around a region.
+ */
+class ABYSS_EXPORT HardwareCounters {
+ public:
+  HardwareCounters();
+  ~HardwareCounters();
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  /**
+   * @brief `CounterValues::available` bits of the counters that opened.
+   */
+  unsigned available() const { return available_; }
+  CounterValues read() const;
+
+ private:
+  int leader_ = -1;
+  // counter of each group member, in the order they were opened
+  std::array<Counter, kNumCounters> members_{};
+  std::array<int, kNumCounters> fds_{};
+  int num_members_ = 0;
+  unsigned available_ = 0;
+};
+
+struct Input {
+  std::vector<int> shape;
+  std::string dtype;
+};
+
+struct Event {
+  std::string category;
+  std::string name;
+  std::vector<Input> inputs;
+  uint64_t start_ns = 0;     // since the profile started
+  uint64_t duration_ns = 0;
+  int thread_id = 0;
+  size_t bytes_allocated = 0;  // by the scope and everything nested in it
+  double flops = 0;            // estimate, 0 if unknown
+  CounterValues counters;      // only sampled by `Profile(true)`
+};
+
+namespace detail {
+ABYSS_EXPORT extern std::atomic<bool> enabled;
+ABYSS_EXPORT extern std::atomic<bool> sample_counters;
+
+ABYSS_EXPORT uint64_t now_ns();
+ABYSS_EXPORT int thread_id();
+/**
+ * @brief running total of bytes allocated on this thread while profiling.
+ */
+ABYSS_EXPORT size_t allocated_bytes();
+ABYSS_EXPORT void count_allocation(size_t nbytes);
+ABYSS_EXPORT void record(Event&& event);
+/**
+ * @brief counters of the calling thread, opened on first use.
+ */
+ABYSS_EXPORT HardwareCounters& thread_counters();
+/**
+ * @brief demangled type name without its namespaces, cached.
+ */
+ABYSS_EXPORT const std::string& type_name(const std::type_info& type);
+ABYSS_EXPORT const char* dtype_name(std::type_index dtype);
+}  // namespace detail
+
+inline bool is_enabled() {
+  return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief records one event from construction to destruction.
+ *
+ * Inputs and names are only worth computing when `active()`.
+ */
+class ABYSS_EXPORT RecordScope {
+ public:
+  explicit RecordScope(const char* category, const char* name = "",
+                       double flops = 0) {
+    if (is_enabled()) start(category, name, flops);
+  }
+  ~RecordScope() {
+    if (event_) finish();
+  }
+
+  RecordScope(const RecordScope&) = delete;
+  RecordScope& operator=(const RecordScope&) = delete;
+
+  bool active() const { return event_ != nullptr; }
+
+  void set_name(const std::string& name);
+  void set_flops(double flops);
+  void add_input(const std::vector<int>& shape, std::type_index dtype);
+
+ private:
+  std::unique_ptr<Event> event_;
+  size_t bytes_at_start_ = 0;
+  CounterValues counters_at_start_;
+
+  void start(const char* category, const char* name, double flops);
+  void finish();
+};
+
+/**
+ * @brief a profiling session, recording starts on construction.
+ *
+ * Events of every thread are collected until `stop()` (or destruction). Only
+ * one session can be active at a time. With `hardware_counters` every scope
+ * also reads the counters of its thread, which costs a system call on entry
+ * and exit.
+ */
+class ABYSS_EXPORT Profile {
+ public:
+  explicit Profile(bool hardware_counters = false);
+  ~Profile();
+
+  Profile(const Profile&) = delete;
+  Profile& operator=(const Profile&) = delete;
+
+  void stop();
+
+  /**
+   * @brief the recorded events in the order they finished, filled by
+   * `stop()`.
+   */
+  const std::vector<Event>& events() const;
+
+  /**
+   * @brief write the events in the Chrome trace format (chrome://tracing,
+   * Perfetto).
+   */
+  void export_chrome_trace(const std::string& path) const;
+
+  /**
+   * @brief events aggregated by category and name, sorted by total time.
+   */
+  std::string table() const;
+
+ private:
+  bool running_ = true;
+  std::vector<Event> events_;
+};
+
+}  // namespace abyss::profiler
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef ABYSS_RANDOM_H
+#define ABYSS_RANDOM_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "abyss_export.h"
+
+namespace abyss {
+
+/**
+ * @brief Counter-based random number generator state.
+ *
+ * The generator only holds a seed and a counter offset. Random ops reserve a
+ * range of counters with `advance` and generate them with Philox, so the
+ * samples are reproducible and do not depend on the number of threads.
+ */
+class ABYSS_EXPORT Generator {
+ public:
+  explicit Generator(uint64_t seed);
+
+  Generator(const Generator&) = delete;
+  Generator& operator=(const Generator&) = delete;
+
+  /**
+   * @brief reseed the generator and reset the counter offset.
+   */
+  void manual_seed(uint64_t seed);
+
+  uint64_t seed() const;
+  uint64_t offset() const;
+
+  /**
+   * @brief move the counter, e.g. to replay the samples of an earlier range.
+   */
+  void set_offset(uint64_t offset);
+
+  /**
+   * @brief reserve `n` counters.
+   *
+   * @return the first counter of the reserved range
+   */
+  uint64_t advance(uint64_t n);
+
+ private:
+  uint64_t seed_;
+  std::atomic<uint64_t> offset_{0};
+};
+
+/**
+ * @brief the generator used by random ops when none is given.
+ *
+ * It is seeded non-deterministically at startup, call `manual_seed` for
+ * reproducible runs.
+ */
+ABYSS_EXPORT Generator& default_generator();
+
+/**
+ * @brief seed the default generator
+ */
+ABYSS_EXPORT void manual_seed(uint64_t seed);
+
+}  // namespace abyss
+
+#endif
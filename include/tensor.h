@@ -36,6 +36,7 @@ using TensorFlags = core::TensorFlags;
 namespace autograd {
 // meta graph class
 class Graph;
+class Context;
 
 // forward function mixin
 template <typename ChildType>
@@ -58,6 +59,8 @@ class ABYSS_EXPORT Tensor {
 
   // graph create grad during backward ops
   friend class autograd::Graph;
+  // saved tensors share storage copy-on-write
+  friend class autograd::Context;
 
   // autograd function creates grad_fn on the fly
   template <typename ChildType>
@@ -100,6 +103,28 @@ class ABYSS_EXPORT Tensor {
 
   Tensor& operator=(Tensor copy);
 
+  using Deleter = std::function<void(void*)>;
+
+  /**
+   * @brief Tensor over memory owned by someone else, without copying it.
+   *
+   * `strides` are in elements and must not be negative, `data` has to hold
+   * every element they reach. `deleter` is called with `data` once the last
+   * tensor or view using the memory is gone, possibly on another thread.
+   * Without a deleter the caller keeps the memory alive for as long as the
+   * tensor is used.
+   *
+   * Writes through the tensor go to the foreign memory.
+   */
+  static Tensor from_blob(void* data, std::vector<int> shape,
+                          std::vector<int> strides, ScalarType dtype,
+                          Deleter deleter = nullptr);
+  /**
+   * @brief from_blob over densely packed row-major data.
+   */
+  static Tensor from_blob(void* data, std::vector<int> shape, ScalarType dtype,
+                          Deleter deleter = nullptr);
+
   virtual ~Tensor() {
     // std::cout << "Tensor destruct" << std::endl;
   }
@@ -113,13 +138,25 @@ class ABYSS_EXPORT Tensor {
     swap(flags_, other.flags_);
     swap(grad_, other.grad_);
     swap(grad_fn_, other.grad_fn_);
+    swap(hooks_, other.hooks_);
   }
 
   /**
    * @brief Deep copy of tensors
+   *
+   * Dense tensors are copied lazily under `set_copy_on_write(true)`.
    */
   Tensor copy();
 
+  /**
+   * @brief the tensor itself if its elements are dense and in row-major
+   * order, a packed copy otherwise.
+   *
+   * Permuted views (`T()`, `transpose`) are packed with a cache-blocked
+   * transpose. Like `copy()`, the result is not tracked by autograd.
+   */
+  Tensor contiguous() const;
+
   /**
    * @brief all elements evaluates to true
    */
@@ -132,10 +169,15 @@ class ABYSS_EXPORT Tensor {
   // Tensor any() const;
 
   ScalarType dtype() const;
+  /**
+   * @brief number of writes to the underlying storage, shared by views and
+   * shallow copies.
+   */
+  uint64_t version() const;
   // core::ArrayDesc desc() const { return desc_; }
   size_t offset() const;
-  const std::vector<int>& shape() const;
-  const std::vector<int>& strides() const;
+  const core::DimVector& shape() const;
+  const core::DimVector& strides() const;
   // core::Array* data() const;
 
   // bool flags(core::TensorFlags name);
@@ -211,8 +253,23 @@ class ABYSS_EXPORT Tensor {
   Tensor& grad();
   autograd::BackwardFn& grad_fn();
 
+  /**
+   * @brief a new leaf sharing the same data but cut from the graph.
+   */
+  Tensor detach() const;
+
   void backward(Tensor gradient = 1);
 
+  /**
+   * @brief called with the tensor once a backward pass has finished
+   * accumulating its gradient.
+   *
+   * Only leaves that require grad are notified. Copies of the tensor share
+   * their hooks, hooks run on the thread calling `backward`.
+   */
+  using Hook = std::function<void(Tensor&)>;
+  void register_hook(Hook hook);
+
  protected:
   ScalarType dtype_ = kNone;
   core::ArrayDesc desc_;
@@ -226,6 +283,7 @@ class ABYSS_EXPORT Tensor {
   // bool requires_grad_ = false;
   std::shared_ptr<Tensor> grad_;
   std::shared_ptr<autograd::BackwardFn> grad_fn_;
+  std::shared_ptr<std::vector<Hook>> hooks_;
 
   core::Array* data() const;
   core::ArrayDesc desc() const;
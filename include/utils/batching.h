@@ -0,0 +1,79 @@
+#ifndef ABYSS_UTIL_BATCHING_H
+#define ABYSS_UTIL_BATCHING_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "abyss_export.h"
+#include "nn/module.h"
+#include "tensor.h"
+
+namespace abyss::utils {
+
+/**
+ * @brief serve single sample requests from many threads in batches.
+ *
+ * Requests are queued and a background thread concatenates up to
+ * `max_batch_size` of them along `batch_axis` (0 or 1), waiting at most
+ * `max_delay` after the oldest one arrived. One forward runs per batch
+ * without recording a graph and the output is sliced back into per request
+ * results, so many small products become one GEMM.
+ *
+ * Every sample has size 1 along the batch axis (e.g. `(in_features, 1)` for
+ * `nn::Linear`, which takes columns). The module is switched to evaluation
+ * mode and must not be trained while the executor runs.
+ */
+class ABYSS_EXPORT BatchingExecutor {
+ public:
+  BatchingExecutor(nn::Module& module, int batch_axis = 0,
+                   size_t max_batch_size = 32,
+                   std::chrono::microseconds max_delay =
+                       std::chrono::microseconds(500));
+  /**
+   * @brief answers every pending request before returning.
+   */
+  ~BatchingExecutor();
+
+  BatchingExecutor(const BatchingExecutor&) = delete;
+  BatchingExecutor& operator=(const BatchingExecutor&) = delete;
+
+  std::future<Tensor> submit(Tensor sample);
+
+  /**
+   * @brief number of forward passes run so far.
+   */
+  size_t num_batches() const;
+
+ private:
+  struct Request {
+    Tensor sample;
+    std::promise<Tensor> result;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
+  nn::Module& module_;
+  int axis_;
+  size_t max_batch_size_;
+  std::chrono::microseconds max_delay_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  bool stop_ = false;
+  std::atomic<size_t> num_batches_{0};
+  std::thread thread_;
+
+  void loop();
+  void run(std::vector<Request>& batch);
+  Tensor slice(Tensor& output, int index);
+};
+
+}  // namespace abyss::utils
+
+#endif
@@ -38,11 +38,22 @@ class ABYSS_EXPORT DataLoader {
   DataLoader(const DataLoader& other);
   DataLoader& operator=(DataLoader copy);
 
+  /**
+   * @brief only iterate over the samples of `rank` out of `world_size`.
+   *
+   * The (shuffled) sample order is split round robin. It is padded by wrapping
+   * around so every rank runs the same number of batches. All ranks have to
+   * share the random seed to shuffle alike.
+   */
+  void shard(size_t rank, size_t world_size);
+
   void swap(DataLoader& b) {
     using std::swap;
 
     swap(batch_size_, b.batch_size_);
     swap(shuffle_, b.shuffle_);
+    swap(rank_, b.rank_);
+    swap(world_size_, b.world_size_);
 
     swap(dataset_, b.dataset_);
     swap(offset_, b.offset_);
@@ -69,11 +80,14 @@ class ABYSS_EXPORT DataLoader {
  private:
   size_t batch_size_;
   bool shuffle_;
+  size_t rank_ = 0;
+  size_t world_size_ = 1;
 
   Dataset* dataset_;
   
   size_t offset_ = 0;
   // std::shared_ptr<size_t[]> ids_;
+  // sample ids of this rank in iteration order
   std::vector<size_t> ids_;
   
   // like the view object in tensor, created for reference
@@ -82,6 +96,7 @@ class ABYSS_EXPORT DataLoader {
   static size_t calc_size(size_t dataset_size, size_t batch_size);
 
   void update_slice();
+  void reset_ids(bool shuffle);
 };
 
 }  // namespace abyss::utils::data
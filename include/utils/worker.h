@@ -0,0 +1,52 @@
+#ifndef ABYSS_UTIL_WORKER_H
+#define ABYSS_UTIL_WORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "abyss_export.h"
+
+namespace abyss::utils {
+
+/**
+ * @brief a single background thread running tasks in submission order.
+ *
+ * Used to overlap work (parameter updates, gradient communication) with the
+ * rest of a backward pass. The first exception thrown by a task is rethrown
+ * by `wait`.
+ */
+class ABYSS_EXPORT BackgroundWorker {
+ public:
+  BackgroundWorker();
+  ~BackgroundWorker();
+
+  BackgroundWorker(const BackgroundWorker&) = delete;
+  BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+  void submit(std::function<void()> task);
+
+  /**
+   * @brief block until every submitted task has finished.
+   */
+  void wait();
+
+ private:
+  void loop();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable idle_cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool busy_ = false;
+  bool stop_ = false;
+  std::exception_ptr error_;
+  std::thread thread_;
+};
+
+}  // namespace abyss::utils
+
+#endif
@@ -0,0 +1,86 @@
+#include "autograd/capture.h"
+
+#include <stdexcept>
+
+namespace abyss::autograd {
+
+namespace {
+thread_local CapturedGraph* current_graph = nullptr;
+}  // namespace
+
+/**
+ * CapturedGraph implementations
+ */
+
+CapturedGraph* CapturedGraph::current() { return current_graph; }
+
+void CapturedGraph::record(std::string name, Kernel kernel,
+                           std::initializer_list<core::Array*> reads,
+                           std::initializer_list<core::Array*> writes,
+                           double flops) {
+  Node node{std::move(name), std::move(kernel), {}, {}, flops};
+  for (auto* buffer : reads) {
+    if (buffer != nullptr) node.reads.emplace_back(buffer_id(buffer));
+  }
+  for (auto* buffer : writes) {
+    if (buffer != nullptr) node.writes.emplace_back(buffer_id(buffer));
+  }
+
+  nodes_.emplace_back(std::move(node));
+}
+
+void CapturedGraph::replay() const {
+  if (current_graph == this) {
+    throw std::runtime_error("cannot replay a graph while capturing it");
+  }
+
+  for (auto& node : nodes_) {
+    for (size_t id : node.writes) buffers_[id]->prepare_write();
+    profiler::RecordScope scope("kernel", node.name.c_str(), node.flops);
+    node.kernel();
+  }
+}
+
+void CapturedGraph::reset() {
+  nodes_.clear();
+  buffers_.clear();
+  buffer_ids_.clear();
+}
+
+bool CapturedGraph::empty() const { return nodes_.empty(); }
+const std::vector<CapturedGraph::Node>& CapturedGraph::nodes() const {
+  return nodes_;
+}
+const std::vector<std::shared_ptr<core::Array>>& CapturedGraph::buffers()
+    const {
+  return buffers_;
+}
+
+size_t CapturedGraph::buffer_id(core::Array* buffer) {
+  auto it = buffer_ids_.find(buffer);
+  if (it != buffer_ids_.end()) {
+    return it->second;
+  }
+
+  size_t id = buffers_.size();
+  buffers_.emplace_back(buffer->shared_from_this());
+  buffer_ids_.emplace(buffer, id);
+
+  return id;
+}
+
+/**
+ * CaptureGuard implementations
+ */
+
+CaptureGuard::CaptureGuard(CapturedGraph& graph) {
+  if (current_graph != nullptr) {
+    throw std::runtime_error("nested graph capture is not supported");
+  }
+
+  current_graph = &graph;
+}
+
+CaptureGuard::~CaptureGuard() { current_graph = nullptr; }
+
+}  // namespace abyss::autograd
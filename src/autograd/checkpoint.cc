@@ -0,0 +1,13 @@
+#include "autograd/checkpoint.h"
+
+#include "autograd/functors.h"
+
+namespace abyss::autograd {
+
+Tensor checkpoint(std::function<Tensor(Tensor)> segment, Tensor input) {
+  CheckpointFn checkpoint_fn;
+
+  return checkpoint_fn.call(input, segment);
+}
+
+}  // namespace abyss::autograd
@@ -7,15 +7,64 @@
  * signature.
  */
 
+#include <functional>
+#include <stdexcept>
+
 #include "autograd/function.h"
+#include "autograd/graph.h"
 #include "core/dispatcher.h"
 #include "functional.h"
+#include "ops/act_ops.h"
+#include "ops/conv_ops.h"
+#include "ops/loss_ops.h"
 #include "ops/matrix_ops.h"
+#include "ops/norm_ops.h"
+#include "ops/pool_ops.h"
+#include "ops/merge_ops.h"
 #include "ops/vector_ops.h"
+#include "random.h"
 #include "tensor.h"
 
 namespace abyss::autograd {
 
+namespace detail {
+/**
+ * @brief fused kernels walk raw rows, strided views are densified first.
+ */
+inline Tensor contiguous(Tensor a) {
+  core::DataDispatcher<Tensor> dp = a;
+  return core::is_contiguous(dp.desc()) ? a : a.copy();
+}
+
+/**
+ * @brief gradients seeded by `Tensor::backward()` default to integers, the
+ * floating point kernels need them promoted.
+ */
+inline Tensor floating(Tensor grad) {
+  return grad.dtype() == kFloat64 ? grad : 1.0 * grad;
+}
+
+/**
+ * @brief rewinds `generator` to `offset` while in scope, even if the scope
+ * is left by an exception.
+ */
+class RewindGenerator {
+ public:
+  RewindGenerator(Generator& generator, uint64_t offset)
+      : generator_{generator}, offset_{generator.offset()} {
+    generator_.set_offset(offset);
+  }
+  ~RewindGenerator() { generator_.set_offset(offset_); }
+
+  RewindGenerator(const RewindGenerator&) = delete;
+  RewindGenerator& operator=(const RewindGenerator&) = delete;
+
+ private:
+  Generator& generator_;
+  uint64_t offset_;
+};
+}  // namespace detail
+
 class AddFn : public Function<AddFn> {
  public:
   static Tensor forward(Context& ctx, Tensor a, Tensor b) {
@@ -144,6 +193,8 @@ class MatmulFn : public Function<MatmulFn> {
     using namespace abyss;
     std::vector<Tensor> input_grads(inputs.size());
 
+    // a broadcast gradient (e.g. from sum) has zero strides
+    output_grad = detail::contiguous(output_grad);
     core::DataDispatcher<Tensor> o_grad = output_grad.T();
     core::DataDispatcher<Tensor> a = inputs[0];
     core::DataDispatcher<Tensor> b = inputs[1].T();
@@ -258,5 +309,571 @@ class LogFn : public Function<LogFn> {
   }
 };
 
+/**
+ * @brief log-softmax followed by the mean negative log likelihood.
+ *
+ * Only the logits are saved, the softmax is recomputed in backward rather than
+ * kept alive between the passes.
+ */
+class CrossEntropyFn : public Function<CrossEntropyFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, Tensor target) {
+    if (input.dtype() != kFloat64) {
+      throw std::runtime_error("cross entropy expects floating point scores");
+    }
+    if (target.dtype() != kInt32) {
+      throw std::runtime_error("expects class IDs with integral type");
+    }
+
+    ctx.save_for_backward({input, target});
+
+    core::DataDispatcher<Tensor> dp1 = detail::contiguous(input);
+    core::DataDispatcher<Tensor> dp2 = detail::contiguous(target);
+    core::CrossEntropyVisitor vis(dp1.desc(), dp2.desc());
+    dp1.accept(&vis, &dp2);
+
+    return vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    auto inputs = ctx.saved_tensors();
+
+    // the loss is a scalar, so is its gradient
+    double scale = output_grad.dtype() == kInt32
+                       ? static_cast<int32_t>(output_grad)
+                       : static_cast<double>(output_grad);
+
+    core::DataDispatcher<Tensor> dp1 = detail::contiguous(inputs[0]);
+    core::DataDispatcher<Tensor> dp2 = detail::contiguous(inputs[1]);
+    core::CrossEntropyBackwardVisitor vis(dp1.desc(), dp2.desc(), scale);
+    dp1.accept(&vis, &dp2);
+
+    return {vis, Tensor()};
+  }
+};
+
+/**
+ * @brief mean negative log likelihood over log probabilities.
+ *
+ * The gradient only depends on the targets, so the input is saved for its
+ * shape alone.
+ */
+class NLLLossFn : public Function<NLLLossFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, Tensor target) {
+    if (input.dtype() != kFloat64) {
+      throw std::runtime_error("nll loss expects floating point scores");
+    }
+    if (target.dtype() != kInt32) {
+      throw std::runtime_error("expects class IDs with integral type");
+    }
+
+    ctx.save_for_backward({input, target});
+
+    core::DataDispatcher<Tensor> dp1 = detail::contiguous(input);
+    core::DataDispatcher<Tensor> dp2 = detail::contiguous(target);
+    core::NLLLossVisitor vis(dp1.desc(), dp2.desc());
+    dp1.accept(&vis, &dp2);
+
+    return vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    auto inputs = ctx.saved_tensors();
+
+    // the loss is a scalar, so is its gradient
+    double scale = output_grad.dtype() == kInt32
+                       ? static_cast<int32_t>(output_grad)
+                       : static_cast<double>(output_grad);
+
+    core::DataDispatcher<Tensor> dp1 = detail::contiguous(inputs[0]);
+    core::DataDispatcher<Tensor> dp2 = detail::contiguous(inputs[1]);
+    core::NLLLossBackwardVisitor vis(dp1.desc(), dp2.desc(), scale);
+    dp1.accept(&vis, &dp2);
+
+    return {vis, Tensor()};
+  }
+};
+
+/**
+ * @brief 2d convolution over NCHW input with an optional per channel bias.
+ *
+ * The backward pass is the transposed lowering of the forward, i.e. two
+ * more GEMMs (or the direct kernels for depthwise convolutions).
+ */
+class Conv2dFn : public Function<Conv2dFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, Tensor weight, Tensor bias,
+                        core::Conv2dParams params) {
+    bool has_bias = bias.dtype() != kNone;
+    if (input.dtype() != kFloat64 || weight.dtype() != kFloat64 ||
+        (has_bias && bias.dtype() != kFloat64)) {
+      throw std::runtime_error("conv2d expects floating point tensors");
+    }
+
+    ctx.save_for_backward({input, weight, bias});
+    ctx.save_attribute("params", params);
+
+    core::DataDispatcher<Tensor> dp1 = detail::contiguous(input);
+    core::DataDispatcher<Tensor> dp2 = detail::contiguous(weight);
+    core::Conv2dVisitor vis(dp1.desc(), dp2.desc(), params);
+    dp1.accept(&vis, &dp2);
+
+    if (!has_bias) {
+      return vis;
+    }
+    if (bias.ndims() != 1 || bias.shape(0) != weight.shape(0)) {
+      throw std::runtime_error("conv2d: bias must have one value per channel");
+    }
+
+    core::DataDispatcher<Tensor> out = vis;
+    core::DataDispatcher<Tensor> b = bias.reshape({bias.shape(0), 1, 1});
+    core::AddVisitor add_vis(out.desc(), b.desc());
+    out.accept(&add_vis, &b);
+
+    return add_vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    using core::FlagId;
+
+    auto inputs = ctx.saved_tensors();
+    auto& params = ctx.attribute<core::Conv2dParams>("params");
+
+    core::DataDispatcher<Tensor> grad =
+        detail::contiguous(detail::floating(output_grad));
+    std::vector<Tensor> input_grads(inputs.size());
+
+    if (inputs[0].flags(FlagId::kRequiresGrad)) {
+      core::DataDispatcher<Tensor> weight = detail::contiguous(inputs[1]);
+      core::Conv2dInputGradVisitor vis(grad.desc(), weight.desc(),
+                                       inputs[0].shape(), params);
+      grad.accept(&vis, &weight);
+      input_grads[0] = vis;
+    }
+    if (inputs[1].flags(FlagId::kRequiresGrad)) {
+      core::DataDispatcher<Tensor> input = detail::contiguous(inputs[0]);
+      core::Conv2dWeightGradVisitor vis(grad.desc(), input.desc(),
+                                        inputs[1].shape(), params);
+      grad.accept(&vis, &input);
+      input_grads[1] = vis;
+    }
+    if (inputs[2].flags(FlagId::kRequiresGrad)) {
+      core::Conv2dBiasGradVisitor vis(grad.desc());
+      grad.accept(&vis);
+      input_grads[2] = vis;
+    }
+
+    return input_grads;
+  }
+};
+
+class MaxPool2dFn : public Function<MaxPool2dFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, core::Pool2dParams params) {
+    if (input.dtype() != kFloat64) {
+      throw std::runtime_error("max_pool2d expects a floating point input");
+    }
+
+    auto g = core::pool2d_geometry(input.shape(), params);
+    // position of every maximum, so backward does not search again
+    Tensor indices = empty({g.batch, g.channels, g.out_height, g.out_width},
+                           kInt32);
+
+    ctx.save_for_backward({input});
+    ctx.save_attribute("params", params);
+    ctx.save_attribute("indices", indices);
+
+    core::DataDispatcher<Tensor> dp = detail::contiguous(input);
+    core::MaxPool2dVisitor vis(dp.desc(), params, indices);
+    dp.accept(&vis);
+
+    return vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    auto inputs = ctx.saved_tensors();
+
+    core::DataDispatcher<Tensor> grad =
+        detail::contiguous(detail::floating(output_grad));
+    core::MaxPool2dBackwardVisitor vis(
+        grad.desc(), inputs[0].shape(),
+        ctx.attribute<core::Pool2dParams>("params"),
+        ctx.attribute<Tensor>("indices"));
+    grad.accept(&vis);
+
+    return {vis};
+  }
+};
+
+class AvgPool2dFn : public Function<AvgPool2dFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, core::Pool2dParams params) {
+    if (input.dtype() != kFloat64) {
+      throw std::runtime_error("avg_pool2d expects a floating point input");
+    }
+
+    ctx.save_for_backward({input});
+    ctx.save_attribute("params", params);
+
+    core::DataDispatcher<Tensor> dp = detail::contiguous(input);
+    core::AvgPool2dVisitor vis(dp.desc(), params);
+    dp.accept(&vis);
+
+    return vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    auto inputs = ctx.saved_tensors();
+
+    core::DataDispatcher<Tensor> grad =
+        detail::contiguous(detail::floating(output_grad));
+    core::AvgPool2dBackwardVisitor vis(
+        grad.desc(), inputs[0].shape(),
+        ctx.attribute<core::Pool2dParams>("params"));
+    grad.accept(&vis);
+
+    return {vis};
+  }
+};
+
+/**
+ * @brief act(input + bias) with the bias broadcast along `axis`.
+ *
+ * Backward keeps as little as the activation allows: the sign bits for ReLU,
+ * the output for sigmoid and tanh, the input for GELU. The in-place variant
+ * overwrites the input, which is why it cannot be used for GELU under grad.
+ */
+class ActivationFn : public Function<ActivationFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, Tensor bias,
+                        Activation act, int axis, bool inplace) {
+    using core::FlagId;
+
+    if (input.dtype() != kFloat64) {
+      throw std::runtime_error("activation expects a floating point input");
+    }
+    bool requires_grad = GradMode::is_enabled() &&
+                         (input.flags(FlagId::kRequiresGrad) ||
+                          bias.flags(FlagId::kRequiresGrad));
+    if (inplace && requires_grad) {
+      if (act == Activation::kGELU) {
+        throw std::runtime_error(
+            "in-place GELU overwrites the input its backward needs");
+      }
+      if (input.flags(FlagId::kRequiresGrad) && input.flags(FlagId::kIsLeaf)) {
+        throw std::runtime_error(
+            "in-place activation of a leaf that requires grad");
+      }
+    }
+
+    core::ActivationOperands operands;
+    operands.bias = bias;
+    operands.axis = axis;
+    if (act == Activation::kReLU && requires_grad) {
+      operands.mask = empty({static_cast<int>((input.size() + 7) / 8)}, kUint8);
+    }
+
+    core::DataDispatcher<Tensor> dp = inplace ? input : detail::contiguous(input);
+    core::ActivationVisitor vis(dp.desc(), act, operands, inplace);
+    dp.accept(&vis);
+
+    if (act == Activation::kSigmoid || act == Activation::kTanh) {
+      operands.saved = vis;
+    } else if (act == Activation::kGELU) {
+      operands.saved = dp;
+    }
+    ctx.save_attribute("operands", operands);
+    ctx.save_attribute("act", act);
+
+    return vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    auto operands = ctx.attribute<core::ActivationOperands>("operands");
+
+    core::DataDispatcher<Tensor> grad =
+        detail::contiguous(detail::floating(output_grad));
+    core::ActivationBackwardVisitor vis(
+        grad.desc(), ctx.attribute<Activation>("act"), operands);
+    grad.accept(&vis);
+
+    std::vector<Tensor> input_grads{vis, Tensor()};
+    if (operands.bias.flags(core::FlagId::kRequiresGrad)) {
+      core::DataDispatcher<Tensor> pre = input_grads[0];
+      core::BiasGradVisitor bias_vis(pre.desc(), operands.axis,
+                                     operands.bias.shape());
+      pre.accept(&bias_vis);
+      input_grads[1] = bias_vis;
+    }
+
+    return input_grads;
+  }
+};
+
+/**
+ * @brief act(weight * input + bias) of column inputs (in, batch).
+ *
+ * The bias seeds the GEMM output and the activation runs on it while it is
+ * still in cache. GELU needs the pre-activation for backward, so under grad it
+ * is applied as a separate pass.
+ */
+class LinearFn : public Function<LinearFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, Tensor weight, Tensor bias,
+                        Activation act) {
+    using core::FlagId;
+
+    if (input.dtype() != kFloat64 || weight.dtype() != kFloat64) {
+      throw std::runtime_error("linear expects floating point operands");
+    }
+    bool requires_grad = GradMode::is_enabled() &&
+                         (input.flags(FlagId::kRequiresGrad) ||
+                          weight.flags(FlagId::kRequiresGrad) ||
+                          bias.flags(FlagId::kRequiresGrad));
+    bool split = requires_grad && act == Activation::kGELU;
+
+    core::ActivationOperands operands;
+    operands.bias = bias;
+    if (act == Activation::kReLU && requires_grad) {
+      int n = input.ndims() == 2 ? input.shape(1) : 1;
+      operands.mask = empty({(weight.shape(0) * n + 7) / 8}, kUint8);
+    }
+
+    core::DataDispatcher<Tensor> dp1 = detail::contiguous(weight);
+    core::DataDispatcher<Tensor> dp2 = detail::contiguous(input);
+    core::LinearVisitor vis(dp1.desc(), dp2.desc(),
+                            split ? Activation::kIdentity : act, operands);
+    dp1.accept(&vis, &dp2);
+
+    Tensor output = vis;
+    if (split) {
+      core::DataDispatcher<Tensor> pre = output;
+      core::ActivationVisitor act_vis(pre.desc(), act, {});
+      pre.accept(&act_vis);
+      output = act_vis;
+    }
+
+    // the bias is already part of what is saved
+    operands.bias = Tensor();
+    if (act == Activation::kSigmoid || act == Activation::kTanh) {
+      operands.saved = output;
+    } else if (act == Activation::kGELU) {
+      operands.saved = vis;
+    }
+    ctx.save_for_backward({dp2, dp1});
+    ctx.save_attribute("operands", operands);
+    ctx.save_attribute("act", act);
+    ctx.save_attribute("bias_shape", bias.shape());
+
+    return output;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    auto& inputs = ctx.saved_tensors();
+    auto operands = ctx.attribute<core::ActivationOperands>("operands");
+    const auto& edges = ctx.inputs();
+
+    core::DataDispatcher<Tensor> grad =
+        detail::contiguous(detail::floating(output_grad));
+    core::ActivationBackwardVisitor act_vis(
+        grad.desc(), ctx.attribute<Activation>("act"), operands);
+    grad.accept(&act_vis);
+
+    std::vector<Tensor> input_grads(3);
+    core::DataDispatcher<Tensor> pre = act_vis;
+    if (edges[0].requires_grad) {
+      // W^T g
+      core::DataDispatcher<Tensor> weight_t = inputs[1].T();
+      core::MatmulVisitor vis(weight_t.desc(), pre.desc());
+      weight_t.accept(&vis, &pre);
+      input_grads[0] = vis;
+    }
+    if (edges[1].requires_grad) {
+      // g x^T
+      core::DataDispatcher<Tensor> input_t = inputs[0].T();
+      core::MatmulVisitor vis(pre.desc(), input_t.desc());
+      pre.accept(&vis, &input_t);
+      input_grads[1] = vis;
+    }
+    if (edges[2].requires_grad) {
+      core::BiasGradVisitor vis(pre.desc(), 0,
+                                ctx.attribute<core::DimVector>("bias_shape"));
+      pre.accept(&vis);
+      input_grads[2] = vis;
+    }
+
+    return input_grads;
+  }
+};
+
+/**
+ * @brief batch normalization over axis 1.
+ *
+ * The batch mean and inverse standard deviation of the forward are kept for
+ * backward, so the input is not reduced again.
+ */
+class BatchNormFn : public Function<BatchNormFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, Tensor weight, Tensor bias,
+                        Tensor running_mean, Tensor running_var, bool training,
+                        double momentum, double eps) {
+    if (input.dtype() != kFloat64) {
+      throw std::runtime_error("batch_norm expects a floating point input");
+    }
+    if (input.ndims() < 2) {
+      throw std::runtime_error("batch_norm expects input of shape (N, C, ...)");
+    }
+
+    core::NormOperands operands;
+    operands.weight = weight;
+    operands.bias = bias;
+    operands.running_mean = running_mean;
+    operands.running_var = running_var;
+    operands.mean = empty({input.shape(1)});
+    operands.invstd = empty({input.shape(1)});
+
+    ctx.save_for_backward({input, weight, bias});
+    ctx.save_attribute("operands", operands);
+    ctx.save_attribute("training", training);
+
+    core::DataDispatcher<Tensor> dp = detail::contiguous(input);
+    core::BatchNormVisitor vis(dp.desc(), operands, training, momentum, eps);
+    dp.accept(&vis);
+
+    return vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    using core::FlagId;
+
+    auto inputs = ctx.saved_tensors();
+    auto operands = ctx.attribute<core::NormOperands>("operands");
+    int channels = inputs[0].shape(1);
+
+    std::vector<Tensor> input_grads(inputs.size());
+    if (inputs[1].flags(FlagId::kRequiresGrad)) {
+      input_grads[1] = operands.grad_weight = empty({channels});
+    }
+    if (inputs[2].flags(FlagId::kRequiresGrad)) {
+      input_grads[2] = operands.grad_bias = empty({channels});
+    }
+
+    core::DataDispatcher<Tensor> grad =
+        detail::contiguous(detail::floating(output_grad));
+    core::DataDispatcher<Tensor> input = detail::contiguous(inputs[0]);
+    core::BatchNormBackwardVisitor vis(grad.desc(), input.desc(), operands,
+                                       ctx.attribute<bool>("training"));
+    grad.accept(&vis, &input);
+    input_grads[0] = vis;
+
+    return input_grads;
+  }
+};
+
+/**
+ * @brief layer normalization over the last `normalized_ndim` axes.
+ */
+class LayerNormFn : public Function<LayerNormFn> {
+ public:
+  static Tensor forward(Context& ctx, Tensor input, Tensor weight, Tensor bias,
+                        int normalized_ndim, double eps) {
+    if (input.dtype() != kFloat64) {
+      throw std::runtime_error("layer_norm expects a floating point input");
+    }
+    if (normalized_ndim < 1 || normalized_ndim > int(input.ndims())) {
+      throw std::runtime_error("layer_norm: invalid normalized shape");
+    }
+
+    std::vector<int> shape = input.shape();
+    int rows = 1;
+    for (size_t i = 0; i < shape.size() - normalized_ndim; i++) {
+      rows *= shape[i];
+    }
+
+    core::NormOperands operands;
+    operands.weight = weight;
+    operands.bias = bias;
+    operands.mean = empty({rows});
+    operands.invstd = empty({rows});
+
+    ctx.save_for_backward({input, weight, bias});
+    ctx.save_attribute("operands", operands);
+    ctx.save_attribute("normalized_ndim", normalized_ndim);
+
+    core::DataDispatcher<Tensor> dp = detail::contiguous(input);
+    core::LayerNormVisitor vis(dp.desc(), normalized_ndim, operands, eps);
+    dp.accept(&vis);
+
+    return vis;
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    using core::FlagId;
+
+    auto inputs = ctx.saved_tensors();
+    auto operands = ctx.attribute<core::NormOperands>("operands");
+
+    std::vector<Tensor> input_grads(inputs.size());
+    if (inputs[1].flags(FlagId::kRequiresGrad)) {
+      input_grads[1] = operands.grad_weight = empty(inputs[1].shape());
+    }
+    if (inputs[2].flags(FlagId::kRequiresGrad)) {
+      input_grads[2] = operands.grad_bias = empty(inputs[2].shape());
+    }
+
+    core::DataDispatcher<Tensor> grad =
+        detail::contiguous(detail::floating(output_grad));
+    core::DataDispatcher<Tensor> input = detail::contiguous(inputs[0]);
+    core::LayerNormBackwardVisitor vis(grad.desc(), input.desc(),
+                                       ctx.attribute<int>("normalized_ndim"),
+                                       operands);
+    grad.accept(&vis, &input);
+    input_grads[0] = vis;
+
+    return input_grads;
+  }
+};
+
+/**
+ * @brief runs a segment without keeping its activations.
+ *
+ * Only the segment input is saved, the segment is run again inside backward
+ * and differentiated on a nested graph.
+ */
+class CheckpointFn : public Function<CheckpointFn> {
+ public:
+  using Segment = std::function<Tensor(Tensor)>;
+
+  static Tensor forward(Context& ctx, Tensor input, Segment segment) {
+    ctx.save_for_backward({input});
+    ctx.save_attribute("segment", segment);
+    // random ops must draw the same samples when recomputed
+    ctx.save_attribute("rng_offset", default_generator().offset());
+
+    // the segment is recorded into a throw-away graph, so the output still
+    // tells whether anything inside (e.g. parameters) needs gradients
+    Graph::SubgraphGuard subgraph;
+    return segment(input);
+  }
+  static std::vector<Tensor> backward(Context& ctx, Tensor output_grad) {
+    using core::FlagId;
+
+    auto& segment = ctx.attribute<Segment>("segment");
+    bool input_requires_grad =
+        ctx.saved_tensors()[0].flags(FlagId::kRequiresGrad);
+
+    Tensor input = ctx.saved_tensors()[0].detach();
+    input.set_flag(FlagId::kRequiresGrad, input_requires_grad);
+
+    {
+      Graph::SubgraphGuard subgraph;
+      Tensor output;
+      {
+        detail::RewindGenerator rewind(default_generator(),
+                                       ctx.attribute<uint64_t>("rng_offset"));
+        output = segment(input);
+      }
+
+      if (output.flags(FlagId::kRequiresGrad)) {
+        Graph::instance().backward(output, output_grad);
+      }
+    }
+
+    return {input_requires_grad ? input.grad() : Tensor()};
+  }
+};
+
 }  // namespace abyss::autograd
 #endif
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "autograd/grad_mode.h"
+
+namespace abyss::autograd {
+
+namespace {
+thread_local bool grad_enabled = true;
+}  // namespace
+
+bool GradMode::is_enabled() { return grad_enabled; }
+void GradMode::set_enabled(bool enabled) { grad_enabled = enabled; }
+
+NoGradGuard::NoGradGuard() : prev_{GradMode::is_enabled()} {
+  GradMode::set_enabled(false);
+}
+NoGradGuard::~NoGradGuard() { GradMode::set_enabled(prev_); }
+
+}  // namespace abyss::autograd
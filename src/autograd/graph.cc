@@ -1,51 +1,165 @@
 #include "autograd/graph.h"
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "autograd/function.h"
+#include "functional.h"
 // #include "core/utility.h"
 
 namespace abyss::autograd {
 
-void Context::save_for_backward(std::initializer_list<Tensor> inputs) {
-  saved_tensors_.assign(inputs.begin(), inputs.end());
+void Context::save_for_backward(std::initializer_list<Tensor> tensors) {
+  saved_tensors_.assign(tensors.begin(), tensors.end());
+  saved_versions_.clear();
+
+  bool share = copy_on_write_enabled();
+  for (auto& tensor : saved_tensors_) {
+    if (share && tensor.data_) tensor.data_ = tensor.data_->share();
+    saved_versions_.emplace_back(tensor.version());
+  }
 }
 std::vector<Tensor>& Context::saved_tensors() { return saved_tensors_; }
+const std::vector<Tensor>& Context::saved_tensors() const {
+  return saved_tensors_;
+}
+
+void Context::check_saved_versions(const std::string& node) const {
+  for (size_t i = 0; i < saved_tensors_.size(); i++) {
+    uint64_t version = saved_tensors_[i].version();
+    if (version != saved_versions_[i]) {
+      throw std::runtime_error(
+          node + ": saved tensor " + std::to_string(i) +
+          " was modified in place after it was saved (version " +
+          std::to_string(saved_versions_[i]) + ", now " +
+          std::to_string(version) + ")");
+    }
+  }
+}
+
+void Context::add_input(Edge edge) { inputs_.emplace_back(std::move(edge)); }
+const std::vector<Context::Edge>& Context::inputs() const { return inputs_; }
 
 /**
  * Graph impementations
  */
 
+Graph& Graph::instance() {
+  static thread_local Graph graph;
+
+  return graph;
+}
+
 void Graph::clear() { Graph::instance().edges_.clear(); }
-Graph::EdgeType Graph::edges() const { return edges_; }
+const Graph::EdgeType& Graph::edges() const { return edges_; }
+
+void Graph::bind_context(Tensor tsr, Context ctx) {
+  edges_[tsr.grad_fn_.get()] = ctx;
+}
 
-void Graph::bind_context(Tensor tsr, Context ctx) { edges_[tsr] = ctx; }
+Graph::SubgraphGuard::SubgraphGuard() {
+  std::swap(Graph::instance().edges_, outer_);
+}
+Graph::SubgraphGuard::~SubgraphGuard() {
+  std::swap(Graph::instance().edges_, outer_);
+}
 
 void Graph::backward(Tensor& output, Tensor output_grad) {
-  // Context& ctx = edges_[output];
-  auto it = edges_.find(output);
-  if (it == edges_.end()) {
-    // reached leaf tensor, update gradients
+  if (output.grad_fn_ == nullptr) {
+    // a leaf tensor, update gradients
     if (output.flags(abyss::core::FlagId::kRequiresGrad)) {
-      // output.init_grad();
-      output.grad() = output.grad() + output_grad;
-      
-      // Tensor tmp = output.grad() + output_grad;
-      // output.grad() = tmp;
+      accumulate(output, output_grad);
+      run_hooks(output);
     }
 
     return;
   }
 
-  Context& ctx = it->second;
-  auto& inputs = ctx.saved_tensors();
-  // gradients are updated in the grad_fn call
-  auto input_grads = output.grad_fn().call(ctx, output_grad);
+  const BackwardFn* root = output.grad_fn_.get();
+  if (edges_.find(root) == edges_.end()) {
+    return;
+  }
+
+  // count the edges into every reachable node and leaf (leaves are told
+  // apart by their shared gradient)
+  std::unordered_map<const BackwardFn*, size_t> dependencies;
+  std::unordered_map<const Tensor*, size_t> pending_leaves;
+  std::vector<const BackwardFn*> stack{root};
+  while (!stack.empty()) {
+    const BackwardFn* node = stack.back();
+    stack.pop_back();
+
+    for (auto& input : edges_.at(node).inputs()) {
+      if (!input.requires_grad) continue;
+
+      if (input.grad_fn) {
+        const BackwardFn* next = input.grad_fn.get();
+        if (edges_.find(next) == edges_.end()) continue;
+        if (dependencies[next]++ == 0) stack.push_back(next);
+      } else {
+        pending_leaves[input.leaf.grad_.get()]++;
+      }
+    }
+  }
+
+  // a node is ready once every consumer has handed over its gradient
+  std::unordered_map<const BackwardFn*, Tensor> grads{{root, output_grad}};
+  std::vector<const BackwardFn*> ready{root};
+  while (!ready.empty()) {
+    const BackwardFn* node = ready.back();
+    ready.pop_back();
+
+    // no consumer produced a gradient, only the counts are passed on
+    std::vector<Tensor> input_grads;
+    Context& ctx = edges_.at(node);
+    auto it = grads.find(node);
+    if (it != grads.end()) {
+      Tensor grad = std::move(it->second);
+      grads.erase(it);
+      ctx.check_saved_versions(node->name());
+      input_grads = const_cast<BackwardFn*>(node)->call(ctx, grad);
+    }
+
+    auto& inputs = ctx.inputs();
+    for (size_t i = 0; i < inputs.size(); i++) {
+      if (!inputs[i].requires_grad) continue;
+      // functions may leave out gradients nobody asked for
+      bool has_grad = i < input_grads.size() && input_grads[i].dtype() != kNone;
+
+      if (inputs[i].grad_fn) {
+        const BackwardFn* next = inputs[i].grad_fn.get();
+        auto deps = dependencies.find(next);
+        if (deps == dependencies.end()) continue;
+
+        if (has_grad) {
+          auto it = grads.find(next);
+          if (it == grads.end()) {
+            grads.emplace(next, input_grads[i]);
+          } else {
+            it->second = it->second + input_grads[i];
+          }
+        }
+        if (--deps->second == 0) ready.push_back(next);
+      } else {
+        Tensor leaf = inputs[i].leaf;
+        if (has_grad) accumulate(leaf, input_grads[i]);
+        if (--pending_leaves[leaf.grad_.get()] == 0) run_hooks(leaf);
+      }
+    }
+  }
+}
+
+void Graph::accumulate(Tensor& leaf, Tensor grad) {
+  leaf.grad() = leaf.grad() + grad;
+}
+
+void Graph::run_hooks(Tensor& leaf) {
+  if (leaf.hooks_ == nullptr) return;
 
-  // Depth First traversal
-  for (size_t i = 0; i < inputs.size(); i++) {
-    backward(inputs[i], input_grads[i]);
+  for (auto& hook : *leaf.hooks_) {
+    hook(leaf);
   }
 }
 
-};  // namespace abyss::autograd
\ No newline at end of file
+};  // namespace abyss::autograd
@@ -0,0 +1,139 @@
+#include "autograd/planner.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <numeric>
+
+namespace abyss::autograd {
+
+namespace {
+
+constexpr size_t kUnused = std::numeric_limits<size_t>::max();
+
+size_t align_up(size_t nbytes) {
+  constexpr size_t kAlign = MemoryPlan::kAlignment;
+  return (nbytes + kAlign - 1) / kAlign * kAlign;
+}
+
+bool overlaps(const MemoryPlan::Block& a, const MemoryPlan::Block& b) {
+  return a.first <= b.last && b.first <= a.last;
+}
+
+}  // namespace
+
+MemoryPlan plan_memory(const CapturedGraph& graph) {
+  auto& nodes = graph.nodes();
+  auto& buffers = graph.buffers();
+
+  // 1. lifetimes, reads of a node happen before its writes
+  std::vector<size_t> first(buffers.size(), kUnused);
+  std::vector<size_t> last(buffers.size(), 0);
+  std::vector<bool> written_first(buffers.size(), false);
+  for (size_t i = 0; i < nodes.size(); i++) {
+    for (auto id : nodes[i].reads) {
+      if (first[id] == kUnused) first[id] = i;
+      last[id] = i;
+    }
+    for (auto id : nodes[i].writes) {
+      if (first[id] == kUnused) {
+        first[id] = i;
+        written_first[id] = true;
+      }
+      last[id] = i;
+    }
+  }
+
+  // 2. intermediates: only referenced by the graph and produced inside it
+  MemoryPlan plan;
+  for (size_t id = 0; id < buffers.size(); id++) {
+    if (first[id] == kUnused || !written_first[id]) continue;
+    if (buffers[id].use_count() != 1) continue;
+
+    size_t nbytes = buffers[id]->nbytes();
+    plan.blocks.push_back({id, 0, nbytes, first[id], last[id]});
+    plan.naive_bytes += nbytes;
+  }
+
+  // 3. peak of the live bytes over the whole step
+  std::vector<long long> delta(nodes.size() + 1, 0);
+  for (auto& block : plan.blocks) {
+    delta[block.first] += block.nbytes;
+    delta[block.last + 1] -= block.nbytes;
+  }
+  long long live = 0;
+  for (auto d : delta) {
+    live += d;
+    plan.live_peak_bytes =
+        std::max(plan.live_peak_bytes, static_cast<size_t>(live));
+  }
+
+  // 4. greedy by size
+  std::vector<size_t> order(plan.blocks.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return plan.blocks[a].nbytes > plan.blocks[b].nbytes;
+  });
+
+  std::vector<const MemoryPlan::Block*> placed;
+  for (auto idx : order) {
+    auto& block = plan.blocks[idx];
+    size_t size = align_up(block.nbytes);
+
+    std::vector<const MemoryPlan::Block*> conflicts;
+    for (auto* other : placed) {
+      if (overlaps(block, *other)) conflicts.emplace_back(other);
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](auto* a, auto* b) { return a->offset < b->offset; });
+
+    // best fitting gap between the conflicting blocks, else after the last
+    size_t best_offset = kUnused;
+    size_t best_gap = kUnused;
+    size_t prev_end = 0;
+    for (auto* other : conflicts) {
+      if (other->offset >= prev_end) {
+        size_t gap = other->offset - prev_end;
+        if (gap >= size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+      }
+      prev_end = std::max(prev_end, other->offset + align_up(other->nbytes));
+    }
+    if (best_offset == kUnused) best_offset = prev_end;
+
+    block.offset = best_offset;
+    plan.arena_bytes = std::max(plan.arena_bytes, best_offset + size);
+    placed.emplace_back(&block);
+  }
+
+  return plan;
+}
+
+void apply_plan(CapturedGraph& graph, const MemoryPlan& plan) {
+  if (plan.arena_bytes == 0) return;
+
+  void* ptr = std::aligned_alloc(MemoryPlan::kAlignment, plan.arena_bytes);
+  if (ptr == nullptr) throw std::bad_alloc();
+  std::shared_ptr<void> arena(ptr, std::free);
+
+  auto* base = static_cast<unsigned char*>(ptr);
+  auto& buffers = graph.buffers();
+  for (auto& block : plan.blocks) {
+    buffers.at(block.buffer)->rebind(base + block.offset, arena);
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const MemoryPlan& plan) {
+  os << "MemoryPlan: " << plan.blocks.size() << " intermediates\n"
+     << "  naive:     " << plan.naive_bytes << " bytes\n"
+     << "  live peak: " << plan.live_peak_bytes << " bytes\n"
+     << "  arena:     " << plan.arena_bytes << " bytes\n";
+
+  return os;
+}
+
+}  // namespace abyss::autograd
@@ -0,0 +1,53 @@
+#ifndef ABYSS_BACKEND_ACTIVATION_H
+#define ABYSS_BACKEND_ACTIVATION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+enum class Activation { kIdentity, kReLU, kGELU, kSigmoid, kTanh };
+
+/**
+ * @brief optional per channel bias, element `i` adds
+ * `data[(i / inner) % channels]`.
+ */
+struct BiasLayout {
+  const double* data = nullptr;
+  size_t channels = 1;
+  size_t inner = 1;
+};
+
+/**
+ * @brief out = act(in + bias) over `n` contiguous elements.
+ *
+ * `out` may alias `in` (in-place). ReLU records which outputs are positive in
+ * `mask` (one bit per element, `(n + 7) / 8` bytes) when it is given, that is
+ * all its backward needs.
+ */
+ABYSS_EXPORT void activation(Activation act, const double* in, BiasLayout bias,
+                             size_t n, double* out, uint8_t* mask);
+
+/**
+ * @brief gradient w.r.t. the pre-activation `in + bias`.
+ *
+ * `saved` is what the forward kept: the output for sigmoid and tanh, the
+ * input (bias added on the fly) for GELU, unused for ReLU (`mask`).
+ * `grad_in` may alias `grad_out`.
+ */
+ABYSS_EXPORT void activation_backward(Activation act, const double* grad_out,
+                                      const double* saved, BiasLayout bias,
+                                      const uint8_t* mask, size_t n,
+                                      double* grad_in);
+
+/**
+ * @brief gradient of the bias, sums everything but the channel.
+ */
+ABYSS_EXPORT void bias_backward(const double* grad, size_t channels,
+                                size_t inner, size_t n, double* grad_bias);
+
+}  // namespace abyss::backend
+
+#endif
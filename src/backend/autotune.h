@@ -0,0 +1,109 @@
+#ifndef ABYSS_BACKEND_AUTOTUNE_H
+#define ABYSS_BACKEND_AUTOTUNE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * @brief parameters of one kernel configuration, their meaning is up to the
+ * kernel (block sizes, grains, variant ids, ...).
+ */
+using TuneConfig = std::vector<long>;
+
+/**
+ * @brief pick the fastest of `candidates` for `kernel` on `shape_class`.
+ *
+ * The first call for a (kernel, shape class, thread count) times `run` on
+ * every candidate and keeps the winner, in memory and in the cache file, so
+ * later calls and later processes return it right away. `run` is called on
+ * the caller's buffers, so the kernel must overwrite its outputs rather than
+ * accumulate into them.
+ *
+ * With tuning disabled (or a single candidate) the first candidate, the
+ * kernel's default, is returned without running anything.
+ */
+ABYSS_EXPORT TuneConfig autotune(
+    const std::string& kernel, const std::string& shape_class,
+    const std::vector<TuneConfig>& candidates,
+    const std::function<void(const TuneConfig&)>& run);
+
+/**
+ * @brief `autotune` for one call site with a fixed list of candidates.
+ *
+ * Kernels run far more often than they see a new shape class, so the site
+ * remembers which candidate won for each one and later calls are a lookup,
+ * without building the key, the candidates or the runner. Typically a
+ * function local static:
+ *
+ *     static TuneSite site("linear", {{256}, {64}, {1024}});
+ *     long grain = site({m, k, n}, [&](const TuneConfig& c) { ... })[0];
+ */
+class ABYSS_EXPORT TuneSite {
+ public:
+  TuneSite(std::string kernel, std::vector<TuneConfig> candidates);
+
+  TuneSite(const TuneSite&) = delete;
+  TuneSite& operator=(const TuneSite&) = delete;
+
+  template <typename Run>
+  const TuneConfig& operator()(std::initializer_list<size_t> dims, Run&& run) {
+    size_t index = 0;
+    if (find(dims, index)) return candidates_[index];
+    return tune(dims, std::function<void(const TuneConfig&)>(
+                          std::forward<Run>(run)));
+  }
+
+ private:
+  struct Entry {
+    std::vector<size_t> buckets;
+    int threads;
+    uint64_t generation;
+    size_t index;
+  };
+
+  std::string kernel_;
+  std::vector<TuneConfig> candidates_;
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+
+  bool find(std::initializer_list<size_t> dims, size_t& index);
+  const TuneConfig& tune(std::initializer_list<size_t> dims,
+                         const std::function<void(const TuneConfig&)>& run);
+};
+
+/**
+ * @brief bucket sizes by the next power of two, e.g. "64x256x32".
+ */
+ABYSS_EXPORT std::string shape_class(std::initializer_list<size_t> dims);
+
+/**
+ * @brief turn tuning on or off, on unless `ABYSS_AUTOTUNE=0`.
+ *
+ * Winners that are already known are used either way.
+ */
+ABYSS_EXPORT void set_autotune_enabled(bool enabled);
+ABYSS_EXPORT bool autotune_enabled();
+
+/**
+ * @brief where winners are persisted, an empty path keeps them in memory.
+ *
+ * Defaults to `ABYSS_AUTOTUNE_CACHE`, else `autotune.json` under
+ * `$XDG_CACHE_HOME/abyss` (or `~/.cache/abyss`). Changing the path drops the
+ * winners of the old file from memory.
+ */
+ABYSS_EXPORT void set_autotune_cache(const std::string& path);
+ABYSS_EXPORT std::string autotune_cache();
+
+}  // namespace abyss::backend
+
+#endif
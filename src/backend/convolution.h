@@ -0,0 +1,90 @@
+#ifndef ABYSS_BACKEND_CONVOLUTION_H
+#define ABYSS_BACKEND_CONVOLUTION_H
+
+#include <cstddef>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * @brief shapes and hyper-parameters of a 2d convolution on NCHW data.
+ *
+ * The weight is laid out as (out_channels, in_channels / groups, kernel_h,
+ * kernel_w). All buffers are contiguous.
+ */
+struct Conv2dGeometry {
+  int batch;
+  int in_channels;
+  int height;
+  int width;
+  int out_channels;
+  int out_height;
+  int out_width;
+  int kernel_h;
+  int kernel_w;
+  int stride_h;
+  int stride_w;
+  int pad_h;
+  int pad_w;
+  int dilation_h;
+  int dilation_w;
+  int groups;
+};
+
+/**
+ * @brief unfold the receptive fields of `channels` planes into columns.
+ *
+ * @param[in] im contiguous (channels, height, width) image
+ * @param[inout] col (channels * kernel_h * kernel_w, out_height * out_width)
+ * matrix, padded positions are zero
+ */
+ABYSS_EXPORT void im2col(const double* im, const Conv2dGeometry& g,
+                         int channels, double* col);
+
+/**
+ * @brief inverse of `im2col`, overlapping fields are summed into `im`.
+ *
+ * `im` is accumulated into, not overwritten.
+ */
+ABYSS_EXPORT void col2im(const double* col, const Conv2dGeometry& g,
+                         int channels, double* im);
+
+/**
+ * @brief output = conv2d(input, weight)
+ *
+ * Depthwise convolutions (one input and one output channel per group) run on
+ * a direct kernel, everything else is lowered to im2col + gemm per sample
+ * and group.
+ */
+ABYSS_EXPORT void conv2d(const double* input, const double* weight,
+                         const Conv2dGeometry& g, double* output);
+
+/**
+ * @brief gradient w.r.t. the input, `weight^T * grad_output` folded back
+ * with `col2im`.
+ */
+ABYSS_EXPORT void conv2d_backward_input(const double* grad_output,
+                                        const double* weight,
+                                        const Conv2dGeometry& g,
+                                        double* grad_input);
+
+/**
+ * @brief gradient w.r.t. the weight, `grad_output * im2col(input)^T` summed
+ * over the batch.
+ */
+ABYSS_EXPORT void conv2d_backward_weight(const double* grad_output,
+                                         const double* input,
+                                         const Conv2dGeometry& g,
+                                         double* grad_weight);
+
+/**
+ * @brief gradient w.r.t. a per channel bias, sums everything but the channel.
+ */
+ABYSS_EXPORT void conv2d_backward_bias(const double* grad_output,
+                                       const Conv2dGeometry& g,
+                                       double* grad_bias);
+
+}  // namespace abyss::backend
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef ABYSS_BACKEND_LOSSES_H
+#define ABYSS_BACKEND_LOSSES_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * @brief mean cross entropy of row-major logits (log softmax + nll fused).
+ *
+ * Each row is read once, the max and the sum of exponentials are updated
+ * together (online logsumexp). Rows are processed in parallel.
+ *
+ * @param[in] logits contiguous (batch, classes) scores
+ * @param[in] target class id of each row
+ * @param[in] batch number of rows
+ * @param[in] classes number of columns
+ * @param[inout] out_data the mean loss (1 element)
+ */
+ABYSS_EXPORT void cross_entropy(const double* logits, const int32_t* target,
+                                size_t batch, size_t classes,
+                                double* out_data);
+
+/**
+ * @brief gradient of `cross_entropy`: `scale * (softmax(logits) - onehot)`.
+ *
+ * @param[inout] out_data contiguous (batch, classes) gradient
+ */
+ABYSS_EXPORT void cross_entropy_backward(const double* logits,
+                                         const int32_t* target, size_t batch,
+                                         size_t classes, double scale,
+                                         double* out_data);
+
+/**
+ * @brief mean negative log likelihood, `-mean(input[i, target[i]])`.
+ *
+ * @param[in] input contiguous (batch, classes) log probabilities
+ * @param[in] target class id of each row
+ * @param[in] batch number of rows
+ * @param[in] classes number of columns
+ * @param[inout] out_data the mean loss (1 element)
+ */
+ABYSS_EXPORT void nll_loss(const double* input, const int32_t* target,
+                           size_t batch, size_t classes, double* out_data);
+
+/**
+ * @brief gradient of `nll_loss`: `-scale` at the targets, 0 elsewhere.
+ *
+ * @param[inout] out_data contiguous (batch, classes) gradient
+ */
+ABYSS_EXPORT void nll_loss_backward(const int32_t* target, size_t batch,
+                                    size_t classes, double scale,
+                                    double* out_data);
+
+}  // namespace abyss::backend
+
+#endif
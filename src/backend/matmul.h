@@ -6,6 +6,7 @@
 #include <cstdint>
 
 #include "abyss_export.h"
+#include "activation.h"
 // #include "backend/backend.h"
 // #include "tensor.h"
 
@@ -25,5 +26,29 @@ ABYSS_EXPORT void matmul(const double* A, const int32_t* B, int m, int k, int n,
 ABYSS_EXPORT void matmul(const double* A, const double* B, int m, int k, int n,
             double* C) noexcept;
 
+/**
+ * @brief general matrix multiply on row-major storage.
+ *
+ * C = alpha * op(A) * op(B) + beta * C, where op(A) is (m, k) and op(B) is
+ * (k, n). A transposed operand is read as stored, no copy is made.
+ */
+ABYSS_EXPORT void gemm(bool trans_a, bool trans_b, int m, int n, int k,
+                       double alpha, const double* A, const double* B,
+                       double beta, double* C) noexcept;
+
+/**
+ * @brief fused output = act(weight * input + bias) on row-major storage.
+ *
+ * weight is (m, k), input (k, n) and bias (m) is added to every row of the
+ * (m, n) output, it may be null. The output is seeded with the bias so GEMM
+ * accumulates into it (beta = 1), the activation then runs panel by panel
+ * while the panel is still in cache. `mask` receives the ReLU sign bits as in
+ * `activation`. The panel size is auto-tuned, the first call for a shape class
+ * runs the tuner.
+ */
+ABYSS_EXPORT void linear(const double* weight, const double* input,
+                         const double* bias, Activation act, int m, int k,
+                         int n, double* output, uint8_t* mask);
+
 }  // namespace abyss::backend
 #endif
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "activation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "parallel.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// minimum elements per thread, a multiple of 8 so mask bytes are not shared
+constexpr size_t kGrain = 8192;
+
+constexpr double kInvSqrt2 = 0.70710678118654752440;
+constexpr double kInvSqrt2Pi = 0.39894228040143267794;
+
+inline double relu(double z) { return z > 0.0 ? z : 0.0; }
+inline double gelu(double z) { return 0.5 * z * (1.0 + std::erf(z * kInvSqrt2)); }
+inline double sigmoid(double z) {
+  // never exponentiate a large positive number
+  if (z >= 0.0) return 1.0 / (1.0 + std::exp(-z));
+  double e = std::exp(z);
+  return e / (1.0 + e);
+}
+
+/**
+ * @brief apply `fn(begin, end, bias_value)` on runs of elements that share the
+ * same bias value.
+ */
+template <typename Fn>
+void for_each_run(size_t first, size_t last, const BiasLayout& bias, Fn fn) {
+  if (bias.data == nullptr) {
+    fn(first, last, 0.0);
+    return;
+  }
+
+  size_t i = first;
+  while (i < last) {
+    size_t run_end = std::min(last, (i / bias.inner + 1) * bias.inner);
+    fn(i, run_end, bias.data[(i / bias.inner) % bias.channels]);
+    i = run_end;
+  }
+}
+
+template <typename Op>
+void map_runs(const double* in, const BiasLayout& bias, size_t first,
+              size_t last, double* out, Op op) {
+  for_each_run(first, last, bias, [&](size_t begin, size_t end, double b) {
+    for (size_t i = begin; i < end; i++) {
+      out[i] = op(in[i] + b);
+    }
+  });
+}
+
+}  // namespace
+
+void activation(Activation act, const double* in, BiasLayout bias, size_t n,
+                double* out, uint8_t* mask) {
+  parallel_for(0, n, kGrain, [&](size_t first, size_t last) {
+    // chunks start on a byte boundary of the mask
+    first = first / 8 * 8;
+    last = last == n ? n : last / 8 * 8;
+
+    switch (act) {
+      case Activation::kIdentity:
+        map_runs(in, bias, first, last, out, [](double z) { return z; });
+        break;
+      case Activation::kReLU:
+        map_runs(in, bias, first, last, out, relu);
+        break;
+      case Activation::kGELU:
+        map_runs(in, bias, first, last, out, gelu);
+        break;
+      case Activation::kSigmoid:
+        map_runs(in, bias, first, last, out, sigmoid);
+        break;
+      case Activation::kTanh:
+        map_runs(in, bias, first, last, out, [](double z) { return std::tanh(z); });
+        break;
+    }
+
+    if (act == Activation::kReLU && mask != nullptr) {
+      for (size_t byte = first / 8; byte * 8 < last; byte++) {
+        uint8_t bits = 0;
+        size_t end = std::min(last, byte * 8 + 8);
+        for (size_t i = byte * 8; i < end; i++) {
+          bits |= uint8_t(out[i] > 0.0) << (i - byte * 8);
+        }
+        mask[byte] = bits;
+      }
+    }
+  });
+}
+
+void activation_backward(Activation act, const double* grad_out,
+                         const double* saved, BiasLayout bias,
+                         const uint8_t* mask, size_t n, double* grad_in) {
+  parallel_for(0, n, kGrain, [&](size_t first, size_t last) {
+    switch (act) {
+      case Activation::kIdentity:
+        if (grad_in != grad_out) {
+          std::copy(grad_out + first, grad_out + last, grad_in + first);
+        }
+        break;
+      case Activation::kReLU:
+        for (size_t i = first; i < last; i++) {
+          bool positive = (mask[i / 8] >> (i % 8)) & 1;
+          grad_in[i] = positive ? grad_out[i] : 0.0;
+        }
+        break;
+      case Activation::kGELU:
+        for_each_run(first, last, bias, [&](size_t begin, size_t end, double b) {
+          for (size_t i = begin; i < end; i++) {
+            double z = saved[i] + b;
+            double cdf = 0.5 * (1.0 + std::erf(z * kInvSqrt2));
+            double pdf = kInvSqrt2Pi * std::exp(-0.5 * z * z);
+            grad_in[i] = grad_out[i] * (cdf + z * pdf);
+          }
+        });
+        break;
+      case Activation::kSigmoid:
+        for (size_t i = first; i < last; i++) {
+          grad_in[i] = grad_out[i] * saved[i] * (1.0 - saved[i]);
+        }
+        break;
+      case Activation::kTanh:
+        for (size_t i = first; i < last; i++) {
+          grad_in[i] = grad_out[i] * (1.0 - saved[i] * saved[i]);
+        }
+        break;
+    }
+  });
+}
+
+void bias_backward(const double* grad, size_t channels, size_t inner, size_t n,
+                   double* grad_bias) {
+  const size_t outer = n / (channels * inner);
+
+  parallel_for(0, channels, std::max<size_t>(1, kGrain / (n / channels + 1)),
+               [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++) {
+      double acc = 0.0;
+      for (size_t o = 0; o < outer; o++) {
+        const double* g = grad + (o * channels + c) * inner;
+        for (size_t j = 0; j < inner; j++) {
+          acc += g[j];
+        }
+      }
+      grad_bias[c] = acc;
+    }
+  });
+}
+
+}  // namespace abyss::backend
@@ -0,0 +1,338 @@
+#include "autotune.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include "parallel.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// timed runs per candidate, after one warm up run
+constexpr int kRepeats = 3;
+
+using Winners = std::map<std::string, TuneConfig>;
+
+bool default_enabled() {
+  const char* env = std::getenv("ABYSS_AUTOTUNE");
+  return env == nullptr || std::string(env) != "0";
+}
+
+std::string default_path() {
+  if (const char* env = std::getenv("ABYSS_AUTOTUNE_CACHE")) return env;
+  if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+    return std::string(xdg) + "/abyss/autotune.json";
+  }
+  if (const char* home = std::getenv("HOME")) {
+    return std::string(home) + "/.cache/abyss/autotune.json";
+  }
+  return "";
+}
+
+/**
+ * cache file
+ *
+ * A flat object of keys to integer arrays, e.g.
+ * {"linear|64x256x32|t4": [16384]}
+ */
+
+class Parser {
+ public:
+  explicit Parser(const std::string& text) : s_{text} {}
+
+  bool parse(Winners& out) {
+    if (!expect('{')) return false;
+    if (peek() == '}') return true;
+    while (true) {
+      std::string key;
+      TuneConfig config;
+      if (!string(key) || !expect(':') || !array(config)) return false;
+      out[key] = config;
+      if (peek() == ',') {
+        i_++;
+        continue;
+      }
+      return expect('}');
+    }
+  }
+
+ private:
+  const std::string& s_;
+  size_t i_ = 0;
+
+  char peek() {
+    while (i_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[i_])))
+      i_++;
+    return i_ < s_.size() ? s_[i_] : '\0';
+  }
+  bool expect(char c) {
+    if (peek() != c) return false;
+    i_++;
+    return true;
+  }
+  bool string(std::string& out) {
+    if (!expect('"')) return false;
+    while (i_ < s_.size() && s_[i_] != '"') {
+      if (s_[i_] == '\\' && i_ + 1 < s_.size()) i_++;
+      out.push_back(s_[i_++]);
+    }
+    return expect('"');
+  }
+  bool array(TuneConfig& out) {
+    if (!expect('[')) return false;
+    if (peek() == ']') return expect(']');
+    while (true) {
+      peek();
+      const char* begin = s_.c_str() + i_;
+      char* end = nullptr;
+      long value = std::strtol(begin, &end, 10);
+      if (end == begin) return false;
+      i_ += end - begin;
+      out.push_back(value);
+      if (peek() == ',') {
+        i_++;
+        continue;
+      }
+      return expect(']');
+    }
+  }
+};
+
+Winners load(const std::string& path) {
+  Winners winners;
+  if (path.empty()) return winners;
+
+  std::ifstream file(path);
+  if (!file) return winners;
+  std::stringstream ss;
+  ss << file.rdbuf();
+
+  // a damaged cache only costs a retune
+  if (!Parser(ss.str()).parse(winners)) winners.clear();
+  return winners;
+}
+
+void make_parents(const std::string& path) {
+  for (size_t pos = path.find('/', 1); pos != std::string::npos;
+       pos = path.find('/', pos + 1)) {
+    ::mkdir(path.substr(0, pos).c_str(), 0755);
+  }
+}
+
+void save(const std::string& path, const Winners& winners) {
+  if (path.empty()) return;
+
+  // other processes may have tuned other kernels in the meantime
+  Winners merged = load(path);
+  for (const auto& kv : winners) merged[kv.first] = kv.second;
+
+  make_parents(path);
+  // written aside and renamed so readers never see a partial file
+  std::string tmp = path + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream file(tmp);
+    if (!file) return;
+    file << "{";
+    const char* sep = "\n";
+    for (const auto& kv : merged) {
+      file << sep << "  \"" << kv.first << "\": [";
+      for (size_t i = 0; i < kv.second.size(); i++) {
+        file << (i > 0 ? ", " : "") << kv.second[i];
+      }
+      file << "]";
+      sep = ",\n";
+    }
+    file << "\n}\n";
+  }
+  std::rename(tmp.c_str(), path.c_str());
+}
+
+struct Cache {
+  std::mutex mutex;
+  std::string path = default_path();
+  bool loaded = false;
+  Winners winners;
+
+  Winners& get() {
+    if (!loaded) {
+      winners = load(path);
+      loaded = true;
+    }
+    return winners;
+  }
+};
+
+Cache& cache() {
+  static Cache instance;
+  return instance;
+}
+
+std::atomic<bool> tuning{default_enabled()};
+// bumped whenever known winners are dropped, so call sites forget theirs
+std::atomic<uint64_t> generation{0};
+
+size_t bucket(size_t d) {
+  size_t b = 1;
+  while (b < d) b *= 2;
+  return b;
+}
+
+double time_run(const std::function<void(const TuneConfig&)>& run,
+                const TuneConfig& config) {
+  using clock = std::chrono::steady_clock;
+  run(config);
+
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < kRepeats; i++) {
+    auto start = clock::now();
+    run(config);
+    best = std::min(
+        best, std::chrono::duration<double>(clock::now() - start).count());
+  }
+  return best;
+}
+
+}  // namespace
+
+TuneConfig autotune(const std::string& kernel, const std::string& shape_class,
+                    const std::vector<TuneConfig>& candidates,
+                    const std::function<void(const TuneConfig&)>& run) {
+  if (candidates.empty()) return {};
+
+  // winners depend on how many threads share the work
+  std::string key = kernel + "|" + shape_class + "|t" +
+                    std::to_string(get_num_threads());
+  auto& c = cache();
+  {
+    std::lock_guard<std::mutex> lock(c.mutex);
+    auto& winners = c.get();
+    auto it = winners.find(key);
+    // winners that are no longer a candidate are tuned again
+    if (it != winners.end() && std::find(candidates.begin(), candidates.end(),
+                                         it->second) != candidates.end()) {
+      return it->second;
+    }
+  }
+  if (candidates.size() == 1 || !tuning.load(std::memory_order_relaxed)) {
+    return candidates.front();
+  }
+
+  // not under the lock, kernels may tune their own parts
+  size_t best = 0;
+  double best_time = std::numeric_limits<double>::max();
+  for (size_t i = 0; i < candidates.size(); i++) {
+    double t = time_run(run, candidates[i]);
+    if (t < best_time) {
+      best_time = t;
+      best = i;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(c.mutex);
+  c.get()[key] = candidates[best];
+  save(c.path, c.winners);
+  return candidates[best];
+}
+
+/**
+ * TuneSite implementations
+ */
+
+TuneSite::TuneSite(std::string kernel, std::vector<TuneConfig> candidates)
+    : kernel_{std::move(kernel)}, candidates_{std::move(candidates)} {
+  if (candidates_.empty()) {
+    throw std::runtime_error("autotune: " + kernel_ + " has no candidates");
+  }
+}
+
+bool TuneSite::find(std::initializer_list<size_t> dims, size_t& index) {
+  const int threads = get_num_threads();
+  const uint64_t gen = generation.load(std::memory_order_acquire);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& e : entries_) {
+    if (e.threads != threads || e.generation != gen ||
+        e.buckets.size() != dims.size() ||
+        !std::equal(dims.begin(), dims.end(), e.buckets.begin(),
+                    [](size_t d, size_t b) { return bucket(d) == b; })) {
+      continue;
+    }
+    index = e.index;
+    return true;
+  }
+  return false;
+}
+
+const TuneConfig& TuneSite::tune(
+    std::initializer_list<size_t> dims,
+    const std::function<void(const TuneConfig&)>& run) {
+  const int threads = get_num_threads();
+  const uint64_t gen = generation.load(std::memory_order_acquire);
+
+  TuneConfig winner = autotune(kernel_, shape_class(dims), candidates_, run);
+  size_t index = std::find(candidates_.begin(), candidates_.end(), winner) -
+                 candidates_.begin();
+
+  // with tuning off this is the default, turning tuning on bumps the
+  // generation so it gets tuned then
+  std::vector<size_t> buckets;
+  for (size_t d : dims) buckets.push_back(bucket(d));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // entries of an old generation are dead, drop them
+  entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                [gen](const Entry& e) {
+                                  return e.generation != gen;
+                                }),
+                 entries_.end());
+  entries_.push_back({std::move(buckets), threads, gen, index});
+  return candidates_[index];
+}
+
+std::string shape_class(std::initializer_list<size_t> dims) {
+  std::string out;
+  for (size_t d : dims) {
+    if (!out.empty()) out += "x";
+    out += std::to_string(bucket(d));
+  }
+  return out;
+}
+
+void set_autotune_enabled(bool enabled) {
+  tuning.store(enabled, std::memory_order_relaxed);
+  // call sites may hold defaults picked while tuning was off
+  generation.fetch_add(1, std::memory_order_release);
+}
+
+bool autotune_enabled() { return tuning.load(std::memory_order_relaxed); }
+
+void set_autotune_cache(const std::string& path) {
+  auto& c = cache();
+  std::lock_guard<std::mutex> lock(c.mutex);
+  c.path = path;
+  c.loaded = false;
+  c.winners.clear();
+  generation.fetch_add(1, std::memory_order_release);
+}
+
+std::string autotune_cache() {
+  auto& c = cache();
+  std::lock_guard<std::mutex> lock(c.mutex);
+  return c.path;
+}
+
+}  // namespace abyss::backend
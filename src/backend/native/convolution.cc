@@ -0,0 +1,379 @@
+#include "convolution.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "autotune.h"
+#include "matmul.h"
+#include "parallel.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// minimum output elements per thread
+constexpr size_t kGrain = 4096;
+
+size_t grain_for(size_t work_per_item, size_t grain = kGrain) {
+  return std::max<size_t>(1, grain / std::max<size_t>(1, work_per_item));
+}
+
+bool is_depthwise(const Conv2dGeometry& g) {
+  return g.groups == g.in_channels && g.groups == g.out_channels;
+}
+
+bool is_pointwise(const Conv2dGeometry& g) {
+  return g.kernel_h == 1 && g.kernel_w == 1 && g.stride_h == 1 &&
+         g.stride_w == 1 && g.pad_h == 0 && g.pad_w == 0;
+}
+
+/**
+ * @brief output indices `o` in [begin, end) with 0 <= offset + o * stride <
+ * size, so the inner loops run without bound checks.
+ */
+void valid_range(int offset, int stride, int size, int out_size, int& begin,
+                 int& end) {
+  begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  end = offset >= size ? 0 : std::min(out_size, (size - 1 - offset) / stride + 1);
+  begin = std::min(begin, out_size);
+  end = std::max(end, begin);
+}
+
+/**
+ * depthwise direct kernels
+ *
+ * Each (sample, channel) plane is independent. For every kernel tap the
+ * valid output span of a row is an axpy over contiguous memory (strided on
+ * the input when stride > 1), which the compiler vectorizes.
+ */
+
+void depthwise_forward(const double* input, const double* weight,
+                       const Conv2dGeometry& g, size_t grain, double* output) {
+  const size_t in_plane = size_t(g.height) * g.width;
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+  const size_t planes = size_t(g.batch) * g.in_channels;
+
+  parallel_for(0, planes, grain_for(out_plane, grain),
+               [&](size_t first, size_t last) {
+    for (size_t p = first; p < last; p++) {
+      const double* in = input + p * in_plane;
+      const double* w = weight + (p % g.in_channels) * g.kernel_h * g.kernel_w;
+      double* out = output + p * out_plane;
+      std::fill_n(out, out_plane, 0.0);
+
+      for (int kw = 0; kw < g.kernel_w; kw++) {
+        const int iw0 = kw * g.dilation_w - g.pad_w;
+        int ow_begin, ow_end;
+        valid_range(iw0, g.stride_w, g.width, g.out_width, ow_begin, ow_end);
+        const int span = ow_end - ow_begin;
+        const int iw_begin = iw0 + ow_begin * g.stride_w;
+
+        for (int oh = 0; oh < g.out_height; oh++) {
+          double* out_row = out + oh * g.out_width;
+          for (int kh = 0; kh < g.kernel_h; kh++) {
+            const int ih = oh * g.stride_h - g.pad_h + kh * g.dilation_h;
+            if (ih < 0 || ih >= g.height) continue;
+
+            const double wv = w[kh * g.kernel_w + kw];
+            const double* in_row = in + ih * g.width + iw_begin;
+            for (int i = 0; i < span; i++) {
+              out_row[ow_begin + i] += wv * in_row[i * g.stride_w];
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+void depthwise_backward_input(const double* grad_output, const double* weight,
+                              const Conv2dGeometry& g, double* grad_input) {
+  const size_t in_plane = size_t(g.height) * g.width;
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+  const size_t planes = size_t(g.batch) * g.in_channels;
+
+  parallel_for(0, planes, grain_for(out_plane), [&](size_t first, size_t last) {
+    for (size_t p = first; p < last; p++) {
+      const double* go = grad_output + p * out_plane;
+      const double* w = weight + (p % g.in_channels) * g.kernel_h * g.kernel_w;
+      double* gi = grad_input + p * in_plane;
+      std::fill_n(gi, in_plane, 0.0);
+
+      for (int kw = 0; kw < g.kernel_w; kw++) {
+        const int iw0 = kw * g.dilation_w - g.pad_w;
+        int ow_begin, ow_end;
+        valid_range(iw0, g.stride_w, g.width, g.out_width, ow_begin, ow_end);
+        const int span = ow_end - ow_begin;
+        const int iw_begin = iw0 + ow_begin * g.stride_w;
+
+        for (int oh = 0; oh < g.out_height; oh++) {
+          const double* go_row = go + oh * g.out_width;
+          for (int kh = 0; kh < g.kernel_h; kh++) {
+            const int ih = oh * g.stride_h - g.pad_h + kh * g.dilation_h;
+            if (ih < 0 || ih >= g.height) continue;
+
+            const double wv = w[kh * g.kernel_w + kw];
+            double* gi_row = gi + ih * g.width + iw_begin;
+            for (int i = 0; i < span; i++) {
+              gi_row[i * g.stride_w] += wv * go_row[ow_begin + i];
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+void depthwise_backward_weight(const double* grad_output, const double* input,
+                               const Conv2dGeometry& g, double* grad_weight) {
+  const size_t in_plane = size_t(g.height) * g.width;
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+  const size_t kernel_size = size_t(g.kernel_h) * g.kernel_w;
+
+  // one thread per channel, the batch is summed inside so no reduction races
+  parallel_for(0, g.in_channels, grain_for(g.batch * out_plane * kernel_size),
+               [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++) {
+      double* gw = grad_weight + c * kernel_size;
+      std::fill_n(gw, kernel_size, 0.0);
+
+      for (int n = 0; n < g.batch; n++) {
+        const size_t p = size_t(n) * g.in_channels + c;
+        const double* in = input + p * in_plane;
+        const double* go = grad_output + p * out_plane;
+
+        for (int kh = 0; kh < g.kernel_h; kh++) {
+          for (int kw = 0; kw < g.kernel_w; kw++) {
+            const int iw0 = kw * g.dilation_w - g.pad_w;
+            int ow_begin, ow_end;
+            valid_range(iw0, g.stride_w, g.width, g.out_width, ow_begin,
+                        ow_end);
+            const int span = ow_end - ow_begin;
+            const int iw_begin = iw0 + ow_begin * g.stride_w;
+
+            double acc = 0.0;
+            for (int oh = 0; oh < g.out_height; oh++) {
+              const int ih = oh * g.stride_h - g.pad_h + kh * g.dilation_h;
+              if (ih < 0 || ih >= g.height) continue;
+
+              const double* go_row = go + oh * g.out_width + ow_begin;
+              const double* in_row = in + ih * g.width + iw_begin;
+              for (int i = 0; i < span; i++) {
+                acc += go_row[i] * in_row[i * g.stride_w];
+              }
+            }
+            gw[kh * g.kernel_w + kw] += acc;
+          }
+        }
+      }
+    }
+  });
+}
+
+}  // namespace
+
+void im2col(const double* im, const Conv2dGeometry& g, int channels,
+            double* col) {
+  const size_t kernel_size = size_t(g.kernel_h) * g.kernel_w;
+  const size_t cols = size_t(g.out_height) * g.out_width;
+
+  // every row of the column matrix is one (channel, kh, kw) tap
+  parallel_for(0, channels * kernel_size, grain_for(cols),
+               [&](size_t first, size_t last) {
+    for (size_t row = first; row < last; row++) {
+      const int c = row / kernel_size;
+      const int kh = (row % kernel_size) / g.kernel_w;
+      const int kw = row % g.kernel_w;
+      const double* plane = im + size_t(c) * g.height * g.width;
+      double* dst = col + row * cols;
+
+      const int iw0 = kw * g.dilation_w - g.pad_w;
+      int ow_begin, ow_end;
+      valid_range(iw0, g.stride_w, g.width, g.out_width, ow_begin, ow_end);
+      const int span = ow_end - ow_begin;
+      const int iw_begin = iw0 + ow_begin * g.stride_w;
+
+      for (int oh = 0; oh < g.out_height; oh++) {
+        double* dst_row = dst + oh * g.out_width;
+        const int ih = oh * g.stride_h - g.pad_h + kh * g.dilation_h;
+        if (ih < 0 || ih >= g.height) {
+          std::fill_n(dst_row, g.out_width, 0.0);
+          continue;
+        }
+
+        const double* src_row = plane + ih * g.width + iw_begin;
+        std::fill_n(dst_row, ow_begin, 0.0);
+        for (int i = 0; i < span; i++) {
+          dst_row[ow_begin + i] = src_row[i * g.stride_w];
+        }
+        std::fill(dst_row + ow_end, dst_row + g.out_width, 0.0);
+      }
+    }
+  });
+}
+
+void col2im(const double* col, const Conv2dGeometry& g, int channels,
+            double* im) {
+  const size_t kernel_size = size_t(g.kernel_h) * g.kernel_w;
+  const size_t cols = size_t(g.out_height) * g.out_width;
+
+  // taps of the same channel overlap, so threads own whole channels
+  parallel_for(0, channels, grain_for(kernel_size * cols),
+               [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++) {
+      double* plane = im + c * g.height * g.width;
+
+      for (size_t k = 0; k < kernel_size; k++) {
+        const int kh = k / g.kernel_w;
+        const int kw = k % g.kernel_w;
+        const double* src = col + (c * kernel_size + k) * cols;
+
+        const int iw0 = kw * g.dilation_w - g.pad_w;
+        int ow_begin, ow_end;
+        valid_range(iw0, g.stride_w, g.width, g.out_width, ow_begin, ow_end);
+        const int span = ow_end - ow_begin;
+        const int iw_begin = iw0 + ow_begin * g.stride_w;
+
+        for (int oh = 0; oh < g.out_height; oh++) {
+          const int ih = oh * g.stride_h - g.pad_h + kh * g.dilation_h;
+          if (ih < 0 || ih >= g.height) continue;
+
+          const double* src_row = src + oh * g.out_width + ow_begin;
+          double* dst_row = plane + ih * g.width + iw_begin;
+          for (int i = 0; i < span; i++) {
+            dst_row[i * g.stride_w] += src_row[i];
+          }
+        }
+      }
+    }
+  });
+}
+
+void conv2d(const double* input, const double* weight, const Conv2dGeometry& g,
+            double* output) {
+  if (is_depthwise(g)) {
+    // planes are small, how many threads pay off depends on the machine
+    static TuneSite site(
+        "depthwise_conv2d",
+        {{long(kGrain)}, {long(kGrain) / 4}, {long(kGrain) * 4}});
+    long grain = site({size_t(g.batch) * g.in_channels,
+                       size_t(g.out_height) * g.out_width,
+                       size_t(g.kernel_h) * g.kernel_w},
+                      [&](const TuneConfig& c) {
+                        depthwise_forward(input, weight, g, c[0], output);
+                      })[0];
+    depthwise_forward(input, weight, g, grain, output);
+    return;
+  }
+
+  const int in_group = g.in_channels / g.groups;
+  const int out_group = g.out_channels / g.groups;
+  const int k = in_group * g.kernel_h * g.kernel_w;
+  const int cols = g.out_height * g.out_width;
+  const size_t in_plane = size_t(g.height) * g.width;
+
+  // 1x1 convolutions read the input as the column matrix directly
+  std::vector<double> col(is_pointwise(g) ? 0 : size_t(k) * cols);
+
+  for (int n = 0; n < g.batch; n++) {
+    for (int grp = 0; grp < g.groups; grp++) {
+      const double* in = input + (size_t(n) * g.in_channels + grp * in_group) * in_plane;
+      const double* w = weight + size_t(grp) * out_group * k;
+      double* out = output + (size_t(n) * g.out_channels + grp * out_group) * cols;
+
+      const double* B = in;
+      if (!col.empty()) {
+        im2col(in, g, in_group, col.data());
+        B = col.data();
+      }
+      gemm(false, false, out_group, cols, k, 1.0, w, B, 0.0, out);
+    }
+  }
+}
+
+void conv2d_backward_input(const double* grad_output, const double* weight,
+                           const Conv2dGeometry& g, double* grad_input) {
+  if (is_depthwise(g)) {
+    depthwise_backward_input(grad_output, weight, g, grad_input);
+    return;
+  }
+
+  const int in_group = g.in_channels / g.groups;
+  const int out_group = g.out_channels / g.groups;
+  const int k = in_group * g.kernel_h * g.kernel_w;
+  const int cols = g.out_height * g.out_width;
+  const size_t in_plane = size_t(g.height) * g.width;
+  const bool pointwise = is_pointwise(g);
+
+  std::vector<double> col(pointwise ? 0 : size_t(k) * cols);
+
+  for (int n = 0; n < g.batch; n++) {
+    for (int grp = 0; grp < g.groups; grp++) {
+      const double* go = grad_output + (size_t(n) * g.out_channels + grp * out_group) * cols;
+      const double* w = weight + size_t(grp) * out_group * k;
+      double* gi = grad_input + (size_t(n) * g.in_channels + grp * in_group) * in_plane;
+
+      if (pointwise) {
+        gemm(true, false, k, cols, out_group, 1.0, w, go, 0.0, gi);
+        continue;
+      }
+
+      gemm(true, false, k, cols, out_group, 1.0, w, go, 0.0, col.data());
+      std::fill_n(gi, size_t(in_group) * in_plane, 0.0);
+      col2im(col.data(), g, in_group, gi);
+    }
+  }
+}
+
+void conv2d_backward_weight(const double* grad_output, const double* input,
+                            const Conv2dGeometry& g, double* grad_weight) {
+  if (is_depthwise(g)) {
+    depthwise_backward_weight(grad_output, input, g, grad_weight);
+    return;
+  }
+
+  const int in_group = g.in_channels / g.groups;
+  const int out_group = g.out_channels / g.groups;
+  const int k = in_group * g.kernel_h * g.kernel_w;
+  const int cols = g.out_height * g.out_width;
+  const size_t in_plane = size_t(g.height) * g.width;
+
+  std::vector<double> col(is_pointwise(g) ? 0 : size_t(k) * cols);
+
+  for (int n = 0; n < g.batch; n++) {
+    for (int grp = 0; grp < g.groups; grp++) {
+      const double* go = grad_output + (size_t(n) * g.out_channels + grp * out_group) * cols;
+      const double* in = input + (size_t(n) * g.in_channels + grp * in_group) * in_plane;
+      double* gw = grad_weight + size_t(grp) * out_group * k;
+
+      const double* B = in;
+      if (!col.empty()) {
+        im2col(in, g, in_group, col.data());
+        B = col.data();
+      }
+      // the first sample initializes, the rest accumulate
+      gemm(false, true, out_group, k, cols, 1.0, go, B, n == 0 ? 0.0 : 1.0, gw);
+    }
+  }
+}
+
+void conv2d_backward_bias(const double* grad_output, const Conv2dGeometry& g,
+                          double* grad_bias) {
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+
+  parallel_for(0, g.out_channels, grain_for(g.batch * out_plane),
+               [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++) {
+      double acc = 0.0;
+      for (int n = 0; n < g.batch; n++) {
+        const double* go = grad_output + (size_t(n) * g.out_channels + c) * out_plane;
+        for (size_t i = 0; i < out_plane; i++) {
+          acc += go[i];
+        }
+      }
+      grad_bias[c] = acc;
+    }
+  });
+}
+
+}  // namespace abyss::backend
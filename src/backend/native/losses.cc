@@ -0,0 +1,118 @@
+#include "losses.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "parallel.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// independent (max, sum) accumulators per row so the loop can be unrolled
+constexpr size_t kLanes = 4;
+// minimum elements per thread
+constexpr size_t kGrain = 4096;
+
+/**
+ * @brief log(sum(exp(row))) in a single pass.
+ */
+double logsumexp(const double* row, size_t n) {
+  constexpr double kLowest = -std::numeric_limits<double>::infinity();
+  double m[kLanes] = {kLowest, kLowest, kLowest, kLowest};
+  double s[kLanes] = {0, 0, 0, 0};
+
+  size_t j = 0;
+  for (; j + kLanes <= n; j += kLanes) {
+    for (size_t l = 0; l < kLanes; l++) {
+      double x = row[j + l];
+      if (x > m[l]) {
+        s[l] = s[l] * std::exp(m[l] - x) + 1.0;
+        m[l] = x;
+      } else {
+        s[l] += std::exp(x - m[l]);
+      }
+    }
+  }
+  for (; j < n; j++) {
+    double x = row[j];
+    if (x > m[0]) {
+      s[0] = s[0] * std::exp(m[0] - x) + 1.0;
+      m[0] = x;
+    } else {
+      s[0] += std::exp(x - m[0]);
+    }
+  }
+
+  // merge the lanes
+  double max = *std::max_element(m, m + kLanes);
+  double sum = 0;
+  for (size_t l = 0; l < kLanes; l++) {
+    if (s[l] != 0) sum += s[l] * std::exp(m[l] - max);
+  }
+
+  return max + std::log(sum);
+}
+
+size_t row_grain(size_t classes) {
+  return std::max<size_t>(1, kGrain / std::max<size_t>(1, classes));
+}
+
+}  // namespace
+
+void cross_entropy(const double* logits, const int32_t* target, size_t batch,
+                   size_t classes, double* out_data) {
+  std::vector<double> losses(batch);
+
+  parallel_for(0, batch, row_grain(classes), [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      const double* row = logits + i * classes;
+      losses[i] = logsumexp(row, classes) - row[target[i]];
+    }
+  });
+
+  // summed in order, so the result does not depend on the thread count
+  double total = 0;
+  for (auto loss : losses) total += loss;
+
+  *out_data = total / batch;
+}
+
+void cross_entropy_backward(const double* logits, const int32_t* target,
+                            size_t batch, size_t classes, double scale,
+                            double* out_data) {
+  parallel_for(0, batch, row_grain(classes), [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      const double* row = logits + i * classes;
+      double* grad = out_data + i * classes;
+
+      double lse = logsumexp(row, classes);
+      for (size_t j = 0; j < classes; j++) {
+        grad[j] = scale * std::exp(row[j] - lse);
+      }
+      grad[target[i]] -= scale;
+    }
+  });
+}
+
+void nll_loss(const double* input, const int32_t* target, size_t batch,
+              size_t classes, double* out_data) {
+  double total = 0;
+  for (size_t i = 0; i < batch; i++) total -= input[i * classes + target[i]];
+
+  *out_data = total / batch;
+}
+
+void nll_loss_backward(const int32_t* target, size_t batch, size_t classes,
+                       double scale, double* out_data) {
+  parallel_for(0, batch, row_grain(classes), [&](size_t first, size_t last) {
+    std::fill(out_data + first * classes, out_data + last * classes, 0.0);
+    for (size_t i = first; i < last; i++) {
+      out_data[i * classes + target[i]] = -scale;
+    }
+  });
+}
+
+}  // namespace abyss::backend
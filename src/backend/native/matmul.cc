@@ -3,6 +3,8 @@
 #include <cblas.h>
 #include <algorithm>
 
+#include "autotune.h"
+
 namespace abyss::backend {
 
 /**
@@ -110,4 +112,66 @@ void matmul(const double* A, const double* B, int m, int k, int n,
               A, k, 0.0f, C, n);
 }
 
-}  // namespace abyss::backend
\ No newline at end of file
+void gemm(bool trans_a, bool trans_b, int m, int n, int k, double alpha,
+          const double* A, const double* B, double beta, double* C) noexcept {
+  const int lda = trans_a ? m : k;
+  const int ldb = trans_b ? k : n;
+
+  cblas_dgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans,
+              trans_b ? CblasTrans : CblasNoTrans, m, n, k, alpha, A, lda, B,
+              ldb, beta, C, n);
+}
+
+namespace {
+// output elements per panel, sized to stay in L2 between GEMM and epilogue
+constexpr long kPanelSize = 16384;
+
+void linear_panels(const double* weight, const double* input,
+                   const double* bias, Activation act, int m, int k, int n,
+                   long panel_size, double* output, uint8_t* mask) {
+  // whole mask bytes per panel, 0 runs the epilogue once over everything
+  int panel_rows = m;
+  if (act != Activation::kIdentity && panel_size > 0) {
+    panel_rows = std::max<int>(8, panel_size / std::max(n, 1) / 8 * 8);
+  }
+
+  for (int r0 = 0; r0 < m; r0 += panel_rows) {
+    const int rows = std::min(panel_rows, m - r0);
+    double* C = output + size_t(r0) * n;
+
+    if (bias != nullptr) {
+      for (int i = 0; i < rows; i++) {
+        std::fill_n(C + size_t(i) * n, n, bias[r0 + i]);
+      }
+    }
+    gemm(false, false, rows, n, k, 1.0, weight + size_t(r0) * k, input,
+         bias != nullptr ? 1.0 : 0.0, C);
+
+    if (act != Activation::kIdentity) {
+      const size_t offset = size_t(r0) * n;
+      activation(act, C, BiasLayout{}, size_t(rows) * n, C,
+                 mask != nullptr ? mask + offset / 8 : nullptr);
+    }
+  }
+}
+}  // namespace
+
+void linear(const double* weight, const double* input, const double* bias,
+            Activation act, int m, int k, int n, double* output,
+            uint8_t* mask) {
+  long panel_size = kPanelSize;
+  // the epilogue is the only thing panels change
+  if (act != Activation::kIdentity) {
+    // L2 sizes differ between machines
+    static TuneSite site(
+        "linear", {{kPanelSize}, {kPanelSize / 4}, {kPanelSize * 4}, {0}});
+    panel_size = site({size_t(m), size_t(k), size_t(n)},
+                      [&](const TuneConfig& c) {
+                        linear_panels(weight, input, bias, act, m, k, n, c[0],
+                                      output, mask);
+                      })[0];
+  }
+  linear_panels(weight, input, bias, act, m, k, n, panel_size, output, mask);
+}
+
+}  // namespace abyss::backend
@@ -0,0 +1,256 @@
+#include "normalization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "parallel.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// minimum elements per thread
+constexpr size_t kGrain = 4096;
+
+size_t grain_for(size_t work_per_item) {
+  return std::max<size_t>(1, kGrain / std::max<size_t>(1, work_per_item));
+}
+
+/**
+ * @brief running mean and sum of squared deviations (Welford).
+ */
+struct Welford {
+  double mean = 0.0;
+  double m2 = 0.0;
+  size_t count = 0;
+
+  /**
+   * @brief fold in a contiguous segment.
+   *
+   * Four interleaved accumulators keep the update loop free of a serial
+   * dependency, they are combined with Chan's pairwise formula.
+   */
+  void update(const double* x, size_t n) {
+    constexpr size_t kLanes = 4;
+    double lane_mean[kLanes] = {0, 0, 0, 0};
+    double lane_m2[kLanes] = {0, 0, 0, 0};
+
+    size_t steps = n / kLanes;
+    for (size_t s = 0; s < steps; s++) {
+      const double inv = 1.0 / (s + 1);
+      for (size_t l = 0; l < kLanes; l++) {
+        double v = x[s * kLanes + l];
+        double delta = v - lane_mean[l];
+        lane_mean[l] += delta * inv;
+        lane_m2[l] += delta * (v - lane_mean[l]);
+      }
+    }
+    if (steps > 0) {
+      for (size_t l = 0; l < kLanes; l++) {
+        merge({lane_mean[l], lane_m2[l], steps});
+      }
+    }
+    for (size_t i = steps * kLanes; i < n; i++) {
+      count++;
+      double delta = x[i] - mean;
+      mean += delta / count;
+      m2 += delta * (x[i] - mean);
+    }
+  }
+
+  void merge(const Welford& other) {
+    if (other.count == 0) return;
+
+    size_t total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * (double(count) * other.count / total);
+    count = total;
+  }
+
+  // population variance, what normalization divides by
+  double variance() const { return count > 0 ? m2 / count : 0.0; }
+};
+
+}  // namespace
+
+void batch_norm(const double* input, const double* weight, const double* bias,
+                double* running_mean, double* running_var, int batch,
+                int channels, size_t spatial, bool training, double momentum,
+                double eps, double* save_mean, double* save_invstd,
+                double* output) {
+  const size_t per_channel = size_t(batch) * spatial;
+
+  parallel_for(0, channels, grain_for(per_channel),
+               [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++) {
+      double mean, var;
+      if (training) {
+        Welford stats;
+        for (int n = 0; n < batch; n++) {
+          stats.update(input + (size_t(n) * channels + c) * spatial, spatial);
+        }
+        mean = stats.mean;
+        var = stats.variance();
+
+        if (running_mean != nullptr) {
+          running_mean[c] = (1 - momentum) * running_mean[c] + momentum * mean;
+        }
+        if (running_var != nullptr) {
+          // the running estimate is unbiased
+          double unbiased = per_channel > 1 ? stats.m2 / (per_channel - 1) : var;
+          running_var[c] = (1 - momentum) * running_var[c] + momentum * unbiased;
+        }
+      } else {
+        mean = running_mean[c];
+        var = running_var[c];
+      }
+
+      const double invstd = 1.0 / std::sqrt(var + eps);
+      if (save_mean != nullptr) save_mean[c] = mean;
+      if (save_invstd != nullptr) save_invstd[c] = invstd;
+
+      // normalize and affine folded into one multiply-add
+      const double scale = (weight != nullptr ? weight[c] : 1.0) * invstd;
+      const double shift = (bias != nullptr ? bias[c] : 0.0) - mean * scale;
+      for (int n = 0; n < batch; n++) {
+        const size_t offset = (size_t(n) * channels + c) * spatial;
+        const double* x = input + offset;
+        double* y = output + offset;
+        for (size_t i = 0; i < spatial; i++) {
+          y[i] = x[i] * scale + shift;
+        }
+      }
+    }
+  });
+}
+
+void batch_norm_backward(const double* grad_output, const double* input,
+                         const double* weight, const double* mean,
+                         const double* invstd, int batch, int channels,
+                         size_t spatial, bool training, double* grad_input,
+                         double* grad_weight, double* grad_bias) {
+  const size_t per_channel = size_t(batch) * spatial;
+
+  parallel_for(0, channels, grain_for(per_channel),
+               [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++) {
+      const double mu = mean[c];
+      const double is = invstd[c];
+
+      // sum(dy) and sum(dy * x_hat)
+      double sum_dy = 0.0;
+      double sum_dy_xhat = 0.0;
+      for (int n = 0; n < batch; n++) {
+        const size_t offset = (size_t(n) * channels + c) * spatial;
+        const double* dy = grad_output + offset;
+        const double* x = input + offset;
+        for (size_t i = 0; i < spatial; i++) {
+          sum_dy += dy[i];
+          sum_dy_xhat += dy[i] * (x[i] - mu);
+        }
+      }
+      sum_dy_xhat *= is;
+
+      if (grad_weight != nullptr) grad_weight[c] = sum_dy_xhat;
+      if (grad_bias != nullptr) grad_bias[c] = sum_dy;
+      if (grad_input == nullptr) continue;
+
+      const double scale = (weight != nullptr ? weight[c] : 1.0) * is;
+      // with batch statistics the mean and variance also depend on x
+      const double mean_dy = training ? sum_dy / per_channel : 0.0;
+      const double mean_dy_xhat = training ? sum_dy_xhat / per_channel : 0.0;
+      for (int n = 0; n < batch; n++) {
+        const size_t offset = (size_t(n) * channels + c) * spatial;
+        const double* dy = grad_output + offset;
+        const double* x = input + offset;
+        double* dx = grad_input + offset;
+        for (size_t i = 0; i < spatial; i++) {
+          const double xhat = (x[i] - mu) * is;
+          dx[i] = scale * (dy[i] - mean_dy - xhat * mean_dy_xhat);
+        }
+      }
+    }
+  });
+}
+
+void layer_norm(const double* input, const double* weight, const double* bias,
+                size_t rows, size_t cols, double eps, double* save_mean,
+                double* save_invstd, double* output) {
+  parallel_for(0, rows, grain_for(cols), [&](size_t first, size_t last) {
+    for (size_t r = first; r < last; r++) {
+      const double* x = input + r * cols;
+      double* y = output + r * cols;
+
+      Welford stats;
+      stats.update(x, cols);
+      const double mean = stats.mean;
+      const double invstd = 1.0 / std::sqrt(stats.variance() + eps);
+      if (save_mean != nullptr) save_mean[r] = mean;
+      if (save_invstd != nullptr) save_invstd[r] = invstd;
+
+      for (size_t j = 0; j < cols; j++) {
+        double v = (x[j] - mean) * invstd;
+        if (weight != nullptr) v *= weight[j];
+        if (bias != nullptr) v += bias[j];
+        y[j] = v;
+      }
+    }
+  });
+}
+
+void layer_norm_backward(const double* grad_output, const double* input,
+                         const double* weight, const double* mean,
+                         const double* invstd, size_t rows, size_t cols,
+                         double* grad_input, double* grad_weight,
+                         double* grad_bias) {
+  if (grad_input != nullptr) {
+    parallel_for(0, rows, grain_for(cols), [&](size_t first, size_t last) {
+      for (size_t r = first; r < last; r++) {
+        const double* dy = grad_output + r * cols;
+        const double* x = input + r * cols;
+        double* dx = grad_input + r * cols;
+        const double mu = mean[r];
+        const double is = invstd[r];
+
+        // g = dy * weight, then the same projection as batch norm
+        double sum_g = 0.0;
+        double sum_g_xhat = 0.0;
+        for (size_t j = 0; j < cols; j++) {
+          double g = weight != nullptr ? dy[j] * weight[j] : dy[j];
+          sum_g += g;
+          sum_g_xhat += g * (x[j] - mu) * is;
+        }
+        const double mean_g = sum_g / cols;
+        const double mean_g_xhat = sum_g_xhat / cols;
+        for (size_t j = 0; j < cols; j++) {
+          double g = weight != nullptr ? dy[j] * weight[j] : dy[j];
+          double xhat = (x[j] - mu) * is;
+          dx[j] = is * (g - mean_g - xhat * mean_g_xhat);
+        }
+      }
+    });
+  }
+
+  if (grad_weight == nullptr && grad_bias == nullptr) return;
+
+  // column blocks, every thread walks all rows of its own columns
+  parallel_for(0, cols, grain_for(rows), [&](size_t first, size_t last) {
+    if (grad_weight != nullptr) std::fill(grad_weight + first, grad_weight + last, 0.0);
+    if (grad_bias != nullptr) std::fill(grad_bias + first, grad_bias + last, 0.0);
+
+    for (size_t r = 0; r < rows; r++) {
+      const double* dy = grad_output + r * cols;
+      const double* x = input + r * cols;
+      const double mu = mean[r];
+      const double is = invstd[r];
+      for (size_t j = first; j < last; j++) {
+        if (grad_weight != nullptr) grad_weight[j] += dy[j] * (x[j] - mu) * is;
+        if (grad_bias != nullptr) grad_bias[j] += dy[j];
+      }
+    }
+  });
+}
+
+}  // namespace abyss::backend
@@ -0,0 +1,205 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace abyss::backend {
+
+namespace {
+
+// set for pool workers and for the caller while it is inside a parallel region
+thread_local bool in_parallel_region = false;
+
+int default_num_threads() {
+  if (const char* env = std::getenv("ABYSS_NUM_THREADS")) {
+    int n = std::atoi(env);
+    if (n > 0) return n;
+  }
+
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief a minimal fork-join pool.
+ *
+ * The calling thread always takes part in the work, so a pool of size `n`
+ * only owns `n - 1` worker threads. Only one parallel region runs at a time,
+ * concurrent callers fall back to running their range inline.
+ */
+class ThreadPool {
+ public:
+  static ThreadPool& instance() {
+    static ThreadPool pool(default_num_threads());
+
+    return pool;
+  }
+
+  ~ThreadPool() { shutdown(); }
+
+  int size() const { return num_threads_; }
+
+  void resize(int n) {
+    std::lock_guard<std::mutex> region(region_mutex_);
+    shutdown();
+    start(n);
+  }
+
+  /**
+   * @brief run `task(i)` for every `i` in `[0, n_chunks)`.
+   *
+   * @return false if the pool is busy, the caller should run inline instead.
+   */
+  bool run(size_t n_chunks, const std::function<void(size_t)>& task) {
+    std::unique_lock<std::mutex> region(region_mutex_, std::try_to_lock);
+    if (!region.owns_lock()) return false;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = &task;
+      n_chunks_ = n_chunks;
+      next_ = 0;
+      pending_ = n_chunks;
+      error_ = nullptr;
+      generation_++;
+    }
+    cv_.notify_all();
+
+    in_parallel_region = true;
+    work(&task, n_chunks);
+    in_parallel_region = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_ == 0 && active_ == 0; });
+    task_ = nullptr;
+
+    if (error_) std::rethrow_exception(error_);
+
+    return true;
+  }
+
+ private:
+  int num_threads_ = 1;
+  std::vector<std::thread> workers_;
+
+  std::mutex region_mutex_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+
+  const std::function<void(size_t)>* task_ = nullptr;
+  size_t n_chunks_ = 0;
+  std::atomic<size_t> next_{0};
+  size_t pending_ = 0;
+  size_t active_ = 0;
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+
+  explicit ThreadPool(int n) { start(n); }
+
+  void start(int n) {
+    num_threads_ = std::max(1, n);
+    stop_ = false;
+    for (int i = 1; i < num_threads_; i++) {
+      workers_.emplace_back([this] { loop(); });
+    }
+  }
+
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) w.join();
+    workers_.clear();
+  }
+
+  void loop() {
+    in_parallel_region = true;
+
+    uint64_t seen = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      seen = generation_;
+    }
+
+    while (true) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+
+      seen = generation_;
+      if (task_ == nullptr) continue;
+
+      auto task = task_;
+      size_t n_chunks = n_chunks_;
+      active_++;
+      lock.unlock();
+
+      work(task, n_chunks);
+
+      lock.lock();
+      active_--;
+      if (active_ == 0) done_cv_.notify_all();
+    }
+  }
+
+  void work(const std::function<void(size_t)>* task, size_t n_chunks) {
+    size_t i = 0;
+    while ((i = next_.fetch_add(1)) < n_chunks) {
+      try {
+        (*task)(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) error_ = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_--;
+      if (pending_ == 0) done_cv_.notify_all();
+    }
+  }
+};
+
+}  // namespace
+
+void set_num_threads(int n) {
+  ThreadPool::instance().resize(n < 1 ? default_num_threads() : n);
+}
+
+int get_num_threads() { return ThreadPool::instance().size(); }
+
+void parallel_for(size_t begin, size_t end, size_t grain,
+                  const std::function<void(size_t, size_t)>& fn) {
+  if (end <= begin) return;
+
+  const size_t range = end - begin;
+  grain = std::max<size_t>(grain, 1);
+
+  auto& pool = ThreadPool::instance();
+  size_t n_chunks = std::min<size_t>(pool.size(), (range + grain - 1) / grain);
+
+  if (n_chunks <= 1 || in_parallel_region) {
+    fn(begin, end);
+    return;
+  }
+
+  auto chunk = [&](size_t i) {
+    size_t first = begin + range * i / n_chunks;
+    size_t last = begin + range * (i + 1) / n_chunks;
+    fn(first, last);
+  };
+
+  if (!pool.run(n_chunks, chunk)) {
+    fn(begin, end);
+  }
+}
+
+}  // namespace abyss::backend
@@ -0,0 +1,157 @@
+#include "pooling.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "parallel.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// minimum output elements per thread
+constexpr size_t kGrain = 4096;
+
+size_t plane_grain(const Pool2dGeometry& g) {
+  return std::max<size_t>(1, kGrain / (size_t(g.out_height) * g.out_width));
+}
+
+/**
+ * @brief clipped window of output `o` along one axis.
+ */
+void window(int o, int stride, int pad, int kernel, int size, int& begin,
+            int& end) {
+  begin = o * stride - pad;
+  end = std::min(begin + kernel, size);
+  begin = std::max(begin, 0);
+}
+
+}  // namespace
+
+void max_pool2d(const double* input, const Pool2dGeometry& g, double* output,
+                int32_t* indices) {
+  const size_t in_plane = size_t(g.height) * g.width;
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+  const size_t planes = size_t(g.batch) * g.channels;
+
+  parallel_for(0, planes, plane_grain(g), [&](size_t first, size_t last) {
+    for (size_t p = first; p < last; p++) {
+      const double* in = input + p * in_plane;
+      double* out = output + p * out_plane;
+      int32_t* idx = indices + p * out_plane;
+
+      for (int oh = 0; oh < g.out_height; oh++) {
+        int h_begin, h_end;
+        window(oh, g.stride_h, g.pad_h, g.kernel_h, g.height, h_begin, h_end);
+
+        for (int ow = 0; ow < g.out_width; ow++) {
+          int w_begin, w_end;
+          window(ow, g.stride_w, g.pad_w, g.kernel_w, g.width, w_begin, w_end);
+
+          double best = -std::numeric_limits<double>::infinity();
+          int32_t best_id = h_begin * g.width + w_begin;
+          for (int h = h_begin; h < h_end; h++) {
+            for (int w = w_begin; w < w_end; w++) {
+              double v = in[h * g.width + w];
+              if (v > best) {
+                best = v;
+                best_id = h * g.width + w;
+              }
+            }
+          }
+
+          out[oh * g.out_width + ow] = best;
+          idx[oh * g.out_width + ow] = best_id;
+        }
+      }
+    }
+  });
+}
+
+void max_pool2d_backward(const double* grad_output, const int32_t* indices,
+                         const Pool2dGeometry& g, double* grad_input) {
+  const size_t in_plane = size_t(g.height) * g.width;
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+  const size_t planes = size_t(g.batch) * g.channels;
+
+  // windows of one plane may overlap, so threads own whole planes
+  parallel_for(0, planes, plane_grain(g), [&](size_t first, size_t last) {
+    for (size_t p = first; p < last; p++) {
+      const double* go = grad_output + p * out_plane;
+      const int32_t* idx = indices + p * out_plane;
+      double* gi = grad_input + p * in_plane;
+
+      std::fill_n(gi, in_plane, 0.0);
+      for (size_t i = 0; i < out_plane; i++) {
+        gi[idx[i]] += go[i];
+      }
+    }
+  });
+}
+
+void avg_pool2d(const double* input, const Pool2dGeometry& g, double* output) {
+  const size_t in_plane = size_t(g.height) * g.width;
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+  const size_t planes = size_t(g.batch) * g.channels;
+  const double scale = 1.0 / (g.kernel_h * g.kernel_w);
+
+  parallel_for(0, planes, plane_grain(g), [&](size_t first, size_t last) {
+    for (size_t p = first; p < last; p++) {
+      const double* in = input + p * in_plane;
+      double* out = output + p * out_plane;
+
+      for (int oh = 0; oh < g.out_height; oh++) {
+        int h_begin, h_end;
+        window(oh, g.stride_h, g.pad_h, g.kernel_h, g.height, h_begin, h_end);
+
+        for (int ow = 0; ow < g.out_width; ow++) {
+          int w_begin, w_end;
+          window(ow, g.stride_w, g.pad_w, g.kernel_w, g.width, w_begin, w_end);
+
+          double acc = 0.0;
+          for (int h = h_begin; h < h_end; h++) {
+            for (int w = w_begin; w < w_end; w++) {
+              acc += in[h * g.width + w];
+            }
+          }
+          out[oh * g.out_width + ow] = acc * scale;
+        }
+      }
+    }
+  });
+}
+
+void avg_pool2d_backward(const double* grad_output, const Pool2dGeometry& g,
+                         double* grad_input) {
+  const size_t in_plane = size_t(g.height) * g.width;
+  const size_t out_plane = size_t(g.out_height) * g.out_width;
+  const size_t planes = size_t(g.batch) * g.channels;
+  const double scale = 1.0 / (g.kernel_h * g.kernel_w);
+
+  parallel_for(0, planes, plane_grain(g), [&](size_t first, size_t last) {
+    for (size_t p = first; p < last; p++) {
+      const double* go = grad_output + p * out_plane;
+      double* gi = grad_input + p * in_plane;
+      std::fill_n(gi, in_plane, 0.0);
+
+      for (int oh = 0; oh < g.out_height; oh++) {
+        int h_begin, h_end;
+        window(oh, g.stride_h, g.pad_h, g.kernel_h, g.height, h_begin, h_end);
+
+        for (int ow = 0; ow < g.out_width; ow++) {
+          int w_begin, w_end;
+          window(ow, g.stride_w, g.pad_w, g.kernel_w, g.width, w_begin, w_end);
+
+          const double v = go[oh * g.out_width + ow] * scale;
+          for (int h = h_begin; h < h_end; h++) {
+            for (int w = w_begin; w < w_end; w++) {
+              gi[h * g.width + w] += v;
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+}  // namespace abyss::backend
@@ -0,0 +1,95 @@
+#include "random.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "parallel.h"
+#include "philox.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// counters handled per inner block (kept on the stack)
+constexpr size_t kBlock = 256;
+// minimum counters per thread
+constexpr size_t kGrain = 16 * kBlock;
+
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+constexpr double kInv2Pow53 = 1.0 / 9007199254740992.0;
+
+// 53 random bits mapped to [0, 1)
+inline double to_unit(uint64_t bits) { return (bits >> 11) * kInv2Pow53; }
+// 53 random bits mapped to (0, 1], safe for log()
+inline double to_open_unit(uint64_t bits) {
+  return ((bits >> 11) + 1) * kInv2Pow53;
+}
+
+/**
+ * @brief generate `n` samples, two per counter.
+ *
+ * The work is split on counter boundaries so the result is independent of the
+ * thread count. Each block first draws the raw bits, then maps them with
+ * `transform` in a separate loop the compiler can vectorize.
+ */
+template <typename Transform>
+void fill(uint64_t seed, uint64_t offset, size_t n, double* out_data,
+          Transform transform) {
+  const size_t n_pairs = (n + 1) / 2;
+
+  parallel_for(0, n_pairs, kGrain, [&](size_t first, size_t last) {
+    uint64_t bits1[kBlock];
+    uint64_t bits2[kBlock];
+    double x[kBlock];
+    double y[kBlock];
+
+    for (size_t p = first; p < last; p += kBlock) {
+      const size_t count = std::min(kBlock, last - p);
+
+      for (size_t i = 0; i < count; i++) {
+        auto r = Philox4x32::generate(offset + p + i, seed);
+        bits1[i] = (static_cast<uint64_t>(r[0]) << 32) | r[1];
+        bits2[i] = (static_cast<uint64_t>(r[2]) << 32) | r[3];
+      }
+
+      transform(bits1, bits2, count, x, y);
+
+      for (size_t i = 0; i < count; i++) {
+        size_t e = 2 * (p + i);
+        out_data[e] = x[i];
+        if (e + 1 < n) out_data[e + 1] = y[i];
+      }
+    }
+  });
+}
+
+}  // namespace
+
+void normal(uint64_t seed, uint64_t offset, size_t n, double* out_data) {
+  // Box-Muller transform
+  auto box_muller = [](const uint64_t* bits1, const uint64_t* bits2,
+                       size_t count, double* x, double* y) {
+    for (size_t i = 0; i < count; i++) {
+      double r = std::sqrt(-2.0 * std::log(to_open_unit(bits1[i])));
+      double theta = kTwoPi * to_unit(bits2[i]);
+      x[i] = r * std::cos(theta);
+      y[i] = r * std::sin(theta);
+    }
+  };
+
+  fill(seed, offset, n, out_data, box_muller);
+}
+
+void uniform(uint64_t seed, uint64_t offset, size_t n, double* out_data) {
+  auto unit = [](const uint64_t* bits1, const uint64_t* bits2, size_t count,
+                 double* x, double* y) {
+    for (size_t i = 0; i < count; i++) {
+      x[i] = to_unit(bits1[i]);
+      y[i] = to_unit(bits2[i]);
+    }
+  };
+
+  fill(seed, offset, n, out_data, unit);
+}
+
+}  // namespace abyss::backend
@@ -0,0 +1,85 @@
+#include "transpose.h"
+
+#include <algorithm>
+
+#include "parallel.h"
+
+namespace abyss::backend {
+
+namespace {
+
+// tile edge, a 64 x 64 tile of doubles is 32 KiB for input and output
+constexpr size_t kTile = 64;
+// minimum elements per thread
+constexpr size_t kGrain = 1 << 15;
+
+/**
+ * @brief transpose a B x B block through a local array.
+ *
+ * The fixed trip counts let the compiler keep the block in vector registers
+ * and turn the exchange into shuffles.
+ */
+template <typename T, size_t B>
+inline void transpose_block(const T* in, size_t ld_in, T* out, size_t ld_out) {
+  T block[B][B];
+  for (size_t r = 0; r < B; r++) {
+    for (size_t c = 0; c < B; c++) block[c][r] = in[r * ld_in + c];
+  }
+  for (size_t c = 0; c < B; c++) {
+    for (size_t r = 0; r < B; r++) out[c * ld_out + r] = block[c][r];
+  }
+}
+
+template <typename T, size_t B>
+void transpose_tile(const T* in, size_t ld_in, size_t rows, size_t cols,
+                    T* out, size_t ld_out) {
+  const size_t full_rows = rows - rows % B;
+  const size_t full_cols = cols - cols % B;
+
+  for (size_t c = 0; c < full_cols; c += B) {
+    for (size_t r = 0; r < full_rows; r += B) {
+      transpose_block<T, B>(in + r * ld_in + c, ld_in, out + c * ld_out + r,
+                            ld_out);
+    }
+  }
+  // ragged edges
+  for (size_t c = 0; c < cols; c++) {
+    size_t r = c < full_cols ? full_rows : 0;
+    for (; r < rows; r++) out[c * ld_out + r] = in[r * ld_in + c];
+  }
+}
+
+template <typename T>
+void transpose_impl(const T* in, size_t ld_in, size_t rows, size_t cols,
+                    T* out, size_t ld_out) {
+  // a block is one 256 bit register per row
+  constexpr size_t B = 32 / sizeof(T);
+
+  // threads own bands of output rows, each band is filled tile by tile
+  const size_t col_tiles = (cols + kTile - 1) / kTile;
+  const size_t grain = std::max<size_t>(1, kGrain / (kTile * rows + 1));
+  parallel_for(0, col_tiles, grain, [&](size_t first, size_t last) {
+    for (size_t t = first; t < last; t++) {
+      size_t c = t * kTile;
+      for (size_t r = 0; r < rows; r += kTile) {
+        transpose_tile<T, B>(in + r * ld_in + c, ld_in,
+                             std::min(kTile, rows - r),
+                             std::min(kTile, cols - c), out + c * ld_out + r,
+                             ld_out);
+      }
+    }
+  });
+}
+
+}  // namespace
+
+void transpose(const double* in, size_t ld_in, size_t rows, size_t cols,
+               double* out, size_t ld_out) {
+  transpose_impl(in, ld_in, rows, cols, out, ld_out);
+}
+void transpose(const int32_t* in, size_t ld_in, size_t rows, size_t cols,
+               int32_t* out, size_t ld_out) {
+  transpose_impl(in, ld_in, rows, cols, out, ld_out);
+}
+
+}  // namespace abyss::backend
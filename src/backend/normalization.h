@@ -0,0 +1,62 @@
+#ifndef ABYSS_BACKEND_NORMALIZATION_H
+#define ABYSS_BACKEND_NORMALIZATION_H
+
+#include <cstddef>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * Normalization kernels
+ *
+ * Statistics are gathered in a single pass with Welford's update, and
+ * normalization and the affine transform are applied in the same sweep as
+ * `x * scale + shift`. `weight` and `bias` may be `nullptr` (no affine).
+ */
+
+/**
+ * @brief batch normalization over (batch, channels, spatial) data.
+ *
+ * With `training` the statistics of the batch are used and written to
+ * `save_mean`/`save_invstd`, and the running statistics (if given) are moved
+ * by `momentum`. Otherwise the running statistics normalize the input.
+ */
+ABYSS_EXPORT void batch_norm(const double* input, const double* weight,
+                             const double* bias, double* running_mean,
+                             double* running_var, int batch, int channels,
+                             size_t spatial, bool training, double momentum,
+                             double eps, double* save_mean, double* save_invstd,
+                             double* output);
+
+/**
+ * @brief gradients of `batch_norm`, one sweep per channel for the two sums
+ * and one for the input gradient.
+ *
+ * `grad_weight` and `grad_bias` may be `nullptr`.
+ */
+ABYSS_EXPORT void batch_norm_backward(const double* grad_output,
+                                      const double* input, const double* weight,
+                                      const double* mean, const double* invstd,
+                                      int batch, int channels, size_t spatial,
+                                      bool training, double* grad_input,
+                                      double* grad_weight, double* grad_bias);
+
+/**
+ * @brief layer normalization of each row of a (rows, cols) matrix.
+ */
+ABYSS_EXPORT void layer_norm(const double* input, const double* weight,
+                             const double* bias, size_t rows, size_t cols,
+                             double eps, double* save_mean, double* save_invstd,
+                             double* output);
+
+ABYSS_EXPORT void layer_norm_backward(const double* grad_output,
+                                      const double* input, const double* weight,
+                                      const double* mean, const double* invstd,
+                                      size_t rows, size_t cols,
+                                      double* grad_input, double* grad_weight,
+                                      double* grad_bias);
+
+}  // namespace abyss::backend
+
+#endif
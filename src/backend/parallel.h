@@ -0,0 +1,35 @@
+#ifndef ABYSS_BACKEND_PARALLEL_H
+#define ABYSS_BACKEND_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * @brief set the number of threads used by the native kernels.
+ *
+ * A value smaller than 1 resets the pool to `std::thread::hardware_concurrency`.
+ */
+ABYSS_EXPORT void set_num_threads(int n);
+ABYSS_EXPORT int get_num_threads();
+
+/**
+ * @brief split `[begin, end)` into chunks and run them on the thread pool.
+ *
+ * Chunks are never smaller than `grain` elements, so small ranges run inline
+ * on the calling thread. Nested calls (from inside a chunk) also run inline.
+ *
+ * @param[in] begin start of the range
+ * @param[in] end end of the range (exclusive)
+ * @param[in] grain minimum number of elements per chunk
+ * @param[in] fn callable that processes the sub range `[first, last)`
+ */
+ABYSS_EXPORT void parallel_for(size_t begin, size_t end, size_t grain,
+                               const std::function<void(size_t, size_t)>& fn);
+
+}  // namespace abyss::backend
+
+#endif
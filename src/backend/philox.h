@@ -0,0 +1,69 @@
+#ifndef ABYSS_BACKEND_PHILOX_H
+#define ABYSS_BACKEND_PHILOX_H
+
+/**
+ * @file Philox4x32-10 counter-based random number generator.
+ *
+ * Salmon et al. "Parallel Random Numbers: As Easy as 1, 2, 3" (SC'11).
+ * The output is a pure function of (key, counter), so any element range can
+ * be generated independently of the others.
+ */
+
+#include <array>
+#include <cstdint>
+
+namespace abyss::backend {
+
+class Philox4x32 {
+ public:
+  using counter_type = std::array<uint32_t, 4>;
+  using key_type = std::array<uint32_t, 2>;
+
+  static constexpr int kRounds = 10;
+
+  static counter_type generate(counter_type ctr, key_type key) {
+    for (int r = 0; r < kRounds; r++) {
+      if (r != 0) {
+        key[0] += kWeyl0;
+        key[1] += kWeyl1;
+      }
+      ctr = round(ctr, key);
+    }
+
+    return ctr;
+  }
+
+  /**
+   * @brief convenience overload with a 64-bit seed and a 64-bit counter.
+   */
+  static counter_type generate(uint64_t counter, uint64_t seed) {
+    counter_type ctr = {static_cast<uint32_t>(counter),
+                        static_cast<uint32_t>(counter >> 32), 0, 0};
+    key_type key = {static_cast<uint32_t>(seed),
+                    static_cast<uint32_t>(seed >> 32)};
+
+    return generate(ctr, key);
+  }
+
+ private:
+  static constexpr uint32_t kMult0 = 0xD2511F53;
+  static constexpr uint32_t kMult1 = 0xCD9E8D57;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+  static counter_type round(const counter_type& ctr, const key_type& key) {
+    uint64_t prod0 = static_cast<uint64_t>(kMult0) * ctr[0];
+    uint64_t prod1 = static_cast<uint64_t>(kMult1) * ctr[2];
+
+    uint32_t hi0 = static_cast<uint32_t>(prod0 >> 32);
+    uint32_t lo0 = static_cast<uint32_t>(prod0);
+    uint32_t hi1 = static_cast<uint32_t>(prod1 >> 32);
+    uint32_t lo1 = static_cast<uint32_t>(prod1);
+
+    return {hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0};
+  }
+};
+
+}  // namespace abyss::backend
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef ABYSS_BACKEND_POOLING_H
+#define ABYSS_BACKEND_POOLING_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * @brief shapes and hyper-parameters of a 2d pooling on NCHW data.
+ */
+struct Pool2dGeometry {
+  int batch;
+  int channels;
+  int height;
+  int width;
+  int out_height;
+  int out_width;
+  int kernel_h;
+  int kernel_w;
+  int stride_h;
+  int stride_w;
+  int pad_h;
+  int pad_w;
+};
+
+/**
+ * @brief max over each window, padded positions never win.
+ *
+ * @param[inout] indices position of the maximum inside its input plane
+ * (`h * width + w`), kept for the backward pass
+ */
+ABYSS_EXPORT void max_pool2d(const double* input, const Pool2dGeometry& g,
+                             double* output, int32_t* indices);
+
+/**
+ * @brief routes each output gradient to the input that won the window.
+ */
+ABYSS_EXPORT void max_pool2d_backward(const double* grad_output,
+                                      const int32_t* indices,
+                                      const Pool2dGeometry& g,
+                                      double* grad_input);
+
+/**
+ * @brief mean over each window, padded positions count as zeros.
+ */
+ABYSS_EXPORT void avg_pool2d(const double* input, const Pool2dGeometry& g,
+                             double* output);
+
+ABYSS_EXPORT void avg_pool2d_backward(const double* grad_output,
+                                      const Pool2dGeometry& g,
+                                      double* grad_input);
+
+}  // namespace abyss::backend
+
+#endif
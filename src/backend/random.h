@@ -0,0 +1,36 @@
+#ifndef ABYSS_BACKEND_RANDOM_H
+#define ABYSS_BACKEND_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * @brief fill an array with samples from the standard normal distribution.
+ *
+ * Every Philox counter yields one Box-Muller pair, so element `i` is always
+ * produced by counter `offset + i / 2`. The output does not depend on the
+ * number of threads or on how the range is split.
+ *
+ * @param[in] seed generator key
+ * @param[in] offset first counter to use
+ * @param[in] n number of samples
+ * @param[inout] out_data output data array
+ */
+ABYSS_EXPORT void normal(uint64_t seed, uint64_t offset, size_t n,
+                         double* out_data);
+
+/**
+ * @brief fill an array with samples from the uniform distribution [0, 1).
+ *
+ * Uses the same counter layout as `normal` (two samples per counter).
+ */
+ABYSS_EXPORT void uniform(uint64_t seed, uint64_t offset, size_t n,
+                          double* out_data);
+
+}  // namespace abyss::backend
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef ABYSS_BACKEND_TRANSPOSE_H
+#define ABYSS_BACKEND_TRANSPOSE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "abyss_export.h"
+
+namespace abyss::backend {
+
+/**
+ * @brief out[c * ld_out + r] = in[r * ld_in + c] for a `rows` x `cols` block.
+ *
+ * Works on tiles that fit the L1 cache, each tile is moved in small square
+ * blocks held in registers, and tiles run in parallel. `in` and `out` must not
+ * overlap.
+ *
+ * @param[in] in input block, rows are `ld_in` elements apart
+ * @param[in] ld_in leading dimension of the input
+ * @param[in] rows input rows (output columns)
+ * @param[in] cols input columns (output rows)
+ * @param[out] out output block, rows are `ld_out` elements apart
+ * @param[in] ld_out leading dimension of the output
+ */
+ABYSS_EXPORT void transpose(const double* in, size_t ld_in, size_t rows,
+                            size_t cols, double* out, size_t ld_out);
+ABYSS_EXPORT void transpose(const int32_t* in, size_t ld_in, size_t rows,
+                            size_t cols, int32_t* out, size_t ld_out);
+
+}  // namespace abyss::backend
+
+#endif
@@ -0,0 +1,130 @@
+#include "distributed/data_parallel.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include "utils/worker.h"
+
+namespace abyss::distributed {
+
+/**
+ * @brief bucketed gradient averaging, shared with the gradient hooks which
+ * may outlive the wrapper.
+ */
+struct DistributedDataParallel::Reducer {
+  ProcessGroup* group;
+  std::vector<Tensor> params;
+
+  std::vector<std::vector<size_t>> buckets;
+  std::vector<size_t> bucket_of;
+
+  // state of the current step
+  std::vector<bool> ready;
+  std::vector<size_t> pending;
+  // buckets are launched in order so every rank issues the same collectives
+  size_t next_bucket = 0;
+
+  std::mutex mutex;
+  utils::BackgroundWorker worker;
+
+  Reducer(ProcessGroup& g, std::vector<Tensor> parameters)
+      : group{&g}, params{std::move(parameters)} {
+    // gradients of the last layers are ready first
+    const size_t capacity = group->bucket_size();
+    size_t filled = capacity;
+    bucket_of.resize(params.size());
+    for (size_t i = params.size(); i-- > 0;) {
+      if (filled + params[i].size() > capacity && filled > 0) {
+        buckets.emplace_back();
+        filled = 0;
+      }
+      buckets.back().push_back(i);
+      bucket_of[i] = buckets.size() - 1;
+      filled += params[i].size();
+    }
+    reset();
+  }
+
+  void reset() {
+    ready.assign(params.size(), false);
+    pending.resize(buckets.size());
+    for (size_t b = 0; b < buckets.size(); b++) {
+      pending[b] = buckets[b].size();
+    }
+    next_bucket = 0;
+  }
+
+  // requires `mutex`
+  void launch(size_t b) {
+    std::vector<Tensor> grads;
+    for (size_t i : buckets[b]) grads.push_back(params[i].grad());
+
+    ProcessGroup* g = group;
+    worker.submit([g, grads]() mutable {
+      g->all_reduce(grads, ReduceOp::kAverage);
+    });
+  }
+
+  // requires `mutex`
+  void launch_ready() {
+    while (next_bucket < buckets.size() && pending[next_bucket] == 0) {
+      launch(next_bucket++);
+    }
+  }
+};
+
+DistributedDataParallel::DistributedDataParallel(nn::Module& module,
+                                                 ProcessGroup& group)
+    : module_{module} {
+  std::vector<Tensor> params;
+  for (auto& p : module.parameters()) {
+    if (p.flags(core::FlagId::kRequiresGrad)) params.push_back(p);
+  }
+
+  // replicas start from the same weights
+  group.broadcast(params, 0);
+
+  reducer_ = std::make_shared<Reducer>(group, params);
+  std::weak_ptr<Reducer> weak = reducer_;
+  for (size_t i = 0; i < params.size(); i++) {
+    params[i].register_hook([weak, i](Tensor&) {
+      auto reducer = weak.lock();
+      if (!reducer) return;
+
+      std::lock_guard<std::mutex> lock(reducer->mutex);
+      // its bucket may already be averaging the gradient being accumulated
+      if (reducer->ready[i]) {
+        throw std::runtime_error(
+            "DistributedDataParallel: backward ran twice without synchronize, "
+            "gradient accumulation is not supported");
+      }
+      reducer->ready[i] = true;
+      reducer->pending[reducer->bucket_of[i]]--;
+      reducer->launch_ready();
+    });
+  }
+}
+
+DistributedDataParallel::~DistributedDataParallel() {
+  try {
+    reducer_->worker.wait();
+  } catch (...) {
+    // errors are reported by `synchronize`
+  }
+}
+
+Tensor DistributedDataParallel::forward(Tensor input) { return module_(input); }
+
+void DistributedDataParallel::synchronize() {
+  {
+    std::lock_guard<std::mutex> lock(reducer_->mutex);
+    while (reducer_->next_bucket < reducer_->buckets.size()) {
+      reducer_->launch(reducer_->next_bucket++);
+    }
+    reducer_->reset();
+  }
+  reducer_->worker.wait();
+}
+
+}  // namespace abyss::distributed
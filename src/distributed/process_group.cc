@@ -0,0 +1,265 @@
+#include "distributed/process_group.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "core/dispatcher.h"
+#include "core/utility.h"
+
+namespace abyss::distributed {
+
+namespace {
+
+// a rank that has not shown up by then is most likely dead
+constexpr auto kTimeout = std::chrono::minutes(5);
+constexpr size_t kHeaderBytes = 256;
+
+std::runtime_error system_error(const std::string& what) {
+  return std::runtime_error("distributed: " + what + ": " +
+                            std::strerror(errno));
+}
+
+/**
+ * @brief (pointer, length) of a contiguous float64 tensor, `write` announces
+ * that the collective overwrites it.
+ */
+std::pair<double*, size_t> span(Tensor& tensor, bool write = true) {
+  if (tensor.dtype() != kFloat64) {
+    throw std::runtime_error("distributed: only float64 tensors are supported");
+  }
+  core::DataDispatcher<Tensor> dp = tensor;
+  if (!core::is_contiguous(dp.desc())) {
+    throw std::runtime_error("distributed: tensors must be contiguous");
+  }
+  if (write) dp.data()->prepare_write();
+
+  return {core::array_cast<double>(dp)->data() + dp.desc().offset,
+          tensor.size()};
+}
+
+/**
+ * @brief visit the pieces of the concatenated spans that fall into
+ * `[begin, begin + n)`, `fn(data, length, position in the window)`.
+ */
+template <typename Callable>
+void for_each_piece(const std::vector<std::pair<double*, size_t>>& spans,
+                    size_t begin, size_t n, Callable fn) {
+  size_t start = 0;
+  for (auto& s : spans) {
+    size_t first = std::max(start, begin);
+    size_t last = std::min(start + s.second, begin + n);
+    if (first < last) {
+      fn(s.first + (first - start), last - first, first - begin);
+    }
+    start += s.second;
+    if (start >= begin + n) break;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief lives at the start of the segment, zero filled by ftruncate.
+ */
+struct ProcessGroup::Header {
+  // (world size, bucket size) of the first rank to attach
+  std::atomic<uint64_t> config;
+  alignas(64) std::atomic<uint32_t> arrived;
+  alignas(64) std::atomic<uint32_t> generation;
+};
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory atomics have to be lock free");
+
+ProcessGroup::ProcessGroup(const std::string& name, int rank, int world_size,
+                           size_t bucket_bytes)
+    : rank_{rank},
+      world_size_{world_size},
+      bucket_size_{bucket_bytes / sizeof(double)} {
+  static_assert(sizeof(Header) <= kHeaderBytes, "header does not fit");
+  if (world_size < 1 || rank < 0 || rank >= world_size) {
+    throw std::runtime_error("distributed: invalid rank or world size");
+  }
+  if (bucket_size_ < size_t(world_size)) {
+    throw std::runtime_error("distributed: bucket is too small");
+  }
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd < 0) throw system_error("shm_open " + name);
+
+  mapped_bytes_ = kHeaderBytes + world_size * bucket_size_ * sizeof(double);
+  if (ftruncate(fd, mapped_bytes_) != 0) {
+    close(fd);
+    throw system_error("ftruncate");
+  }
+  segment_ = mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  fd, 0);
+  close(fd);
+  if (segment_ == MAP_FAILED) {
+    segment_ = nullptr;
+    throw system_error("mmap");
+  }
+  header_ = reinterpret_cast<Header*>(segment_);
+
+  uint64_t config = (uint64_t(world_size) << 48) | bucket_size_;
+  uint64_t expected = 0;
+  if (!header_->config.compare_exchange_strong(expected, config) &&
+      expected != config) {
+    munmap(segment_, mapped_bytes_);
+    throw std::runtime_error(
+        "distributed: ranks disagree on world size or bucket size");
+  }
+
+  // every rank has mapped the segment, the name is not needed anymore
+  barrier();
+  if (rank_ == 0) shm_unlink(name.c_str());
+}
+
+ProcessGroup::~ProcessGroup() {
+  if (segment_) munmap(segment_, mapped_bytes_);
+}
+
+int ProcessGroup::rank() const { return rank_; }
+int ProcessGroup::world_size() const { return world_size_; }
+size_t ProcessGroup::bucket_size() const { return bucket_size_; }
+
+double* ProcessGroup::slot(int rank) const {
+  auto base = reinterpret_cast<char*>(segment_) + kHeaderBytes;
+  return reinterpret_cast<double*>(base) + rank * bucket_size_;
+}
+
+void ProcessGroup::barrier() {
+  uint32_t generation = header_->generation.load(std::memory_order_acquire);
+  if (header_->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+      uint32_t(world_size_)) {
+    // reset before releasing anyone, so the next barrier starts from zero
+    header_->arrived.store(0, std::memory_order_relaxed);
+    header_->generation.fetch_add(1, std::memory_order_release);
+    return;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + kTimeout;
+  while (header_->generation.load(std::memory_order_acquire) == generation) {
+    std::this_thread::yield();
+    if (std::chrono::steady_clock::now() > deadline) {
+      throw std::runtime_error("distributed: timed out waiting for other ranks");
+    }
+  }
+}
+
+/**
+ * Ring all-reduce of the first `n` elements of every slot.
+ *
+ * The buffer is split into `world_size` chunks. In the reduce-scatter phase
+ * every rank adds the chunk its left neighbour has just reduced into its own
+ * slot, after `world_size - 1` steps rank r holds the full sum of chunk
+ * r + 1. The all-gather phase then passes the reduced chunks around the
+ * ring. Each step reads a different chunk than the neighbour is writing, so
+ * one barrier per step is enough.
+ */
+void ProcessGroup::ring_reduce(size_t n) {
+  const int world = world_size_;
+  auto chunk = [n, world](int c, size_t& first, size_t& last) {
+    c = (c % world + world) % world;
+    first = n * c / world;
+    last = n * (c + 1) / world;
+  };
+
+  double* own = slot(rank_);
+  const double* left = slot((rank_ + world - 1) % world);
+
+  for (int step = 0; step < world - 1; step++) {
+    size_t first, last;
+    chunk(rank_ - step - 1, first, last);
+    for (size_t i = first; i < last; i++) own[i] += left[i];
+    barrier();
+  }
+  for (int step = 0; step < world - 1; step++) {
+    size_t first, last;
+    chunk(rank_ - step, first, last);
+    std::copy(left + first, left + last, own + first);
+    barrier();
+  }
+}
+
+void ProcessGroup::all_reduce(std::vector<Tensor>& tensors, ReduceOp op) {
+  std::vector<std::pair<double*, size_t>> spans;
+  size_t total = 0;
+  for (auto& t : tensors) {
+    spans.emplace_back(span(t));
+    total += spans.back().second;
+  }
+
+  const double scale = op == ReduceOp::kAverage ? 1.0 / world_size_ : 1.0;
+  double* own = slot(rank_);
+  for (size_t begin = 0; begin < total; begin += bucket_size_) {
+    size_t n = std::min(bucket_size_, total - begin);
+
+    for_each_piece(spans, begin, n, [own](double* data, size_t len, size_t at) {
+      std::copy(data, data + len, own + at);
+    });
+    if (world_size_ > 1) {
+      barrier();
+      ring_reduce(n);
+    }
+    for_each_piece(spans, begin, n,
+                   [own, scale](double* data, size_t len, size_t at) {
+                     for (size_t i = 0; i < len; i++) {
+                       data[i] = own[at + i] * scale;
+                     }
+                   });
+  }
+}
+
+void ProcessGroup::all_reduce(Tensor& tensor, ReduceOp op) {
+  std::vector<Tensor> tensors{tensor};
+  all_reduce(tensors, op);
+}
+
+void ProcessGroup::broadcast(std::vector<Tensor>& tensors, int root) {
+  if (root < 0 || root >= world_size_) {
+    throw std::runtime_error("distributed: invalid root");
+  }
+
+  std::vector<std::pair<double*, size_t>> spans;
+  size_t total = 0;
+  for (auto& t : tensors) {
+    spans.emplace_back(span(t, rank_ != root && world_size_ > 1));
+    total += spans.back().second;
+  }
+  if (world_size_ == 1) return;
+
+  const double* source = slot(root);
+  for (size_t begin = 0; begin < total; begin += bucket_size_) {
+    size_t n = std::min(bucket_size_, total - begin);
+
+    if (rank_ == root) {
+      for_each_piece(spans, begin, n,
+                     [&](double* data, size_t len, size_t at) {
+                       std::copy(data, data + len, slot(root) + at);
+                     });
+    }
+    barrier();
+    if (rank_ != root) {
+      for_each_piece(spans, begin, n,
+                     [source](double* data, size_t len, size_t at) {
+                       std::copy(source + at, source + at + len, data);
+                     });
+    }
+    // the root slot is reused by the next bucket
+    barrier();
+  }
+}
+
+}  // namespace abyss::distributed
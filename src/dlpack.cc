@@ -0,0 +1,134 @@
+#include "dlpack.h"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/dispatcher.h"
+#include "core/utility.h"
+
+namespace abyss {
+
+namespace {
+
+// owns what an exported DLManagedTensor points to
+struct ExportContext {
+  Tensor tensor;
+  std::vector<int64_t> shape;
+  std::vector<int64_t> strides;
+  DLManagedTensor managed;
+};
+
+void delete_export(DLManagedTensor* self) {
+  delete static_cast<ExportContext*>(self->manager_ctx);
+}
+
+DLDataType to_dl_dtype(ScalarType dtype) {
+  if (dtype == kBool) return {kDLBool, 8, 1};
+  if (dtype == kUint8) return {kDLUInt, 8, 1};
+  if (dtype == kInt32) return {kDLInt, 32, 1};
+  if (dtype == kFloat64) return {kDLFloat, 64, 1};
+  throw std::runtime_error("dlpack: unsupported dtype");
+}
+
+ScalarType from_dl_dtype(DLDataType dtype) {
+  if (dtype.lanes == 1) {
+    if (dtype.code == kDLBool && dtype.bits == 8) return kBool;
+    if (dtype.code == kDLUInt && dtype.bits == 8) return kUint8;
+    if (dtype.code == kDLInt && dtype.bits == 32) return kInt32;
+    if (dtype.code == kDLFloat && dtype.bits == 64) return kFloat64;
+  }
+  throw std::runtime_error(
+      "dlpack: unsupported dtype (code " + std::to_string(dtype.code) +
+      ", bits " + std::to_string(dtype.bits) + ", lanes " +
+      std::to_string(dtype.lanes) + ")");
+}
+
+void* storage(const core::DataDispatcher<Tensor>& dp, ScalarType dtype) {
+  if (dtype == kBool) return core::array_cast<bool>(dp)->data();
+  if (dtype == kUint8) return core::array_cast<uint8_t>(dp)->data();
+  if (dtype == kInt32) return core::array_cast<int32_t>(dp)->data();
+  return core::array_cast<double>(dp)->data();
+}
+
+int to_dim(int64_t value) {
+  if (value < 0 || value > std::numeric_limits<int>::max()) {
+    throw std::runtime_error("dlpack: shape and strides must be in [0, " +
+                             std::to_string(std::numeric_limits<int>::max()) +
+                             "], got " + std::to_string(value));
+  }
+  return static_cast<int>(value);
+}
+
+}  // namespace
+
+DLManagedTensor* to_dlpack(const Tensor& tensor) {
+  DLDataType dtype = to_dl_dtype(tensor.dtype());
+
+  auto* ctx = new ExportContext{tensor.detach(), {}, {}, {}};
+  core::DataDispatcher<Tensor> dp = ctx->tensor;
+  // the consumer gets write access to the storage
+  dp.data()->prepare_write();
+
+  const core::ArrayDesc& desc = dp.desc();
+  ctx->shape.assign(desc.shape.begin(), desc.shape.end());
+  ctx->strides.assign(desc.strides.begin(), desc.strides.end());
+
+  DLTensor& out = ctx->managed.dl_tensor;
+  out.data = storage(dp, tensor.dtype());
+  out.device = {kDLCPU, 0};
+  out.ndim = static_cast<int32_t>(ctx->shape.size());
+  out.dtype = dtype;
+  out.shape = ctx->shape.data();
+  out.strides = ctx->strides.data();
+  out.byte_offset = desc.offset * tensor.dtype().itemsize();
+
+  ctx->managed.manager_ctx = ctx;
+  ctx->managed.deleter = delete_export;
+  return &ctx->managed;
+}
+
+Tensor from_dlpack(DLManagedTensor* managed) {
+  if (managed == nullptr) throw std::runtime_error("dlpack: null tensor");
+
+  // our own export, hand back the tensor it came from
+  if (managed->deleter == delete_export) {
+    Tensor out = static_cast<ExportContext*>(managed->manager_ctx)->tensor;
+    managed->deleter(managed);
+    return out;
+  }
+
+  const DLTensor& in = managed->dl_tensor;
+  if (in.device.device_type != kDLCPU) {
+    throw std::runtime_error("dlpack: only CPU tensors can be imported");
+  }
+  ScalarType dtype = from_dl_dtype(in.dtype);
+  if (in.ndim < 0) throw std::runtime_error("dlpack: negative ndim");
+  if (in.ndim > 0 && in.shape == nullptr) {
+    throw std::runtime_error("dlpack: missing shape");
+  }
+
+  std::vector<int> shape(in.ndim);
+  for (int i = 0; i < in.ndim; i++) shape[i] = to_dim(in.shape[i]);
+
+  std::vector<int> strides;
+  if (in.strides == nullptr) {
+    strides = core::shape2strides(shape);
+  } else {
+    strides.resize(in.ndim);
+    for (int i = 0; i < in.ndim; i++) strides[i] = to_dim(in.strides[i]);
+  }
+
+  char* data = static_cast<char*>(in.data);
+  if (data != nullptr) data += in.byte_offset;
+
+  Tensor::Deleter deleter;
+  if (managed->deleter != nullptr) {
+    deleter = [managed](void*) { managed->deleter(managed); };
+  }
+  return Tensor::from_blob(data, std::move(shape), std::move(strides), dtype,
+                           std::move(deleter));
+}
+
+}  // namespace abyss
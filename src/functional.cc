@@ -1,6 +1,7 @@
 #include "functional.h"
 
 #include <algorithm>
+#include <atomic>
 #include <exception>
 #include <functional>
 #include <stdexcept>
@@ -14,6 +15,7 @@
 #include "ops/matrix_ops.h"
 #include "ops/dtype_ops.h"
 #include "autograd/functors.h"
+#include "backend/parallel.h"
 
 namespace abyss {
 Tensor empty(std::vector<int> shape, ScalarType dtype) {
@@ -63,19 +65,40 @@ Tensor full(std::vector<int> shape, Tensor fill_value,
 //   return arange(0, stop, 1, dtype);
 // }
 Tensor randn(std::vector<int> shape, ScalarType dtype) {
+  return randn(shape, default_generator(), dtype);
+}
+Tensor randn(std::vector<int> shape, Generator& generator, ScalarType dtype) {
   using namespace core;
   if (dtype == kNone) {
     dtype = stypeof<double>();
   }
   TypeDispatcher<ScalarType> stype = dtype;
 
-  RandNormalVisitor randn_vis(shape);
+  // every counter produces two samples
+  uint64_t offset = generator.advance((shape2size(shape) + 1) / 2);
+  RandNormalVisitor randn_vis(shape, generator.seed(), offset);
   stype.accept(&randn_vis);
-  
 
   return randn_vis;
 }
 
+Tensor rand(std::vector<int> shape, ScalarType dtype) {
+  return rand(shape, default_generator(), dtype);
+}
+Tensor rand(std::vector<int> shape, Generator& generator, ScalarType dtype) {
+  using namespace core;
+  if (dtype == kNone) {
+    dtype = stypeof<double>();
+  }
+  TypeDispatcher<ScalarType> stype = dtype;
+
+  uint64_t offset = generator.advance((shape2size(shape) + 1) / 2);
+  RandUniformVisitor rand_vis(shape, generator.seed(), offset);
+  stype.accept(&rand_vis);
+
+  return rand_vis;
+}
+
 Tensor concat(std::vector<Tensor> tensors, int axis) {
   if (axis < 0)
     throw std::runtime_error("concat currently supports axis >= 0.");
@@ -87,7 +110,12 @@ Tensor concat(std::vector<Tensor> tensors, int axis) {
   for (int i = 1; i < tensors.size(); i++) {
     ConcatVisitor concat_visitor(out.shape(), tensors[i].shape(), axis);
     // out.data()->accept(&concat_visitor, tensors[i].data());
+    // the visitor walks the storage, views are made dense first
     DataDispatcher<Tensor> dtsr = tensors[i];
+    if (dtsr.desc().offset != 0 || !is_contiguous(dtsr.desc()) ||
+        dtsr.data()->size() != tensors[i].size()) {
+      dtsr = tensors[i].copy();
+    }
     out.accept(&concat_visitor, &dtsr);
     // assign result back to the output tensor
     out = concat_visitor;
@@ -208,4 +236,129 @@ Tensor negative(Tensor a) {
   return negate_fn.call(a);
 }
 
+Tensor relu(Tensor a) {
+  return bias_activation(a, Tensor(), 0, Activation::kReLU);
+}
+Tensor gelu(Tensor a) {
+  return bias_activation(a, Tensor(), 0, Activation::kGELU);
+}
+Tensor sigmoid(Tensor a) {
+  return bias_activation(a, Tensor(), 0, Activation::kSigmoid);
+}
+Tensor tanh(Tensor a) {
+  return bias_activation(a, Tensor(), 0, Activation::kTanh);
+}
+
+namespace {
+Tensor& activation_(Tensor& a, Activation act) {
+  autograd::ActivationFn activation_fn;
+
+  a = activation_fn.call(a, Tensor(), act, 0, true);
+  return a;
+}
+}  // namespace
+
+Tensor& relu_(Tensor& a) { return activation_(a, Activation::kReLU); }
+Tensor& sigmoid_(Tensor& a) { return activation_(a, Activation::kSigmoid); }
+Tensor& tanh_(Tensor& a) { return activation_(a, Activation::kTanh); }
+
+Tensor bias_activation(Tensor input, Tensor bias, int axis, Activation act) {
+  autograd::ActivationFn activation_fn;
+
+  return activation_fn.call(input, bias, act, axis, false);
+}
+
+Tensor linear(Tensor input, Tensor weight, Tensor bias, Activation act) {
+  autograd::LinearFn linear_fn;
+
+  return linear_fn.call(input, weight, bias, act);
+}
+
+Tensor conv2d(Tensor input, Tensor weight, Tensor bias, int stride,
+              int padding, int dilation, int groups) {
+  autograd::Conv2dFn conv2d_fn;
+
+  core::Conv2dParams params;
+  params.stride = {stride, stride};
+  params.padding = {padding, padding};
+  params.dilation = {dilation, dilation};
+  params.groups = groups;
+
+  return conv2d_fn.call(input, weight, bias, params);
+}
+
+namespace {
+core::Pool2dParams pool2d_params(int kernel_size, int stride, int padding) {
+  core::Pool2dParams params;
+  params.kernel = {kernel_size, kernel_size};
+  if (stride == 0) stride = kernel_size;
+  params.stride = {stride, stride};
+  params.padding = {padding, padding};
+
+  return params;
+}
+}  // namespace
+
+Tensor max_pool2d(Tensor input, int kernel_size, int stride, int padding) {
+  autograd::MaxPool2dFn max_pool2d_fn;
+
+  return max_pool2d_fn.call(input, pool2d_params(kernel_size, stride, padding));
+}
+
+Tensor avg_pool2d(Tensor input, int kernel_size, int stride, int padding) {
+  autograd::AvgPool2dFn avg_pool2d_fn;
+
+  return avg_pool2d_fn.call(input, pool2d_params(kernel_size, stride, padding));
+}
+
+Tensor batch_norm(Tensor input, Tensor running_mean, Tensor running_var,
+                  Tensor weight, Tensor bias, bool training, double momentum,
+                  double eps) {
+  autograd::BatchNormFn batch_norm_fn;
+
+  return batch_norm_fn.call(input, weight, bias, running_mean, running_var,
+                            training, momentum, eps);
+}
+
+Tensor layer_norm(Tensor input, std::vector<int> normalized_shape,
+                  Tensor weight, Tensor bias, double eps) {
+  const auto& shape = input.shape();
+  if (normalized_shape.empty() || normalized_shape.size() > shape.size() ||
+      !std::equal(normalized_shape.begin(), normalized_shape.end(),
+                  shape.end() - normalized_shape.size())) {
+    throw std::runtime_error("layer_norm: normalized shape does not match input");
+  }
+
+  autograd::LayerNormFn layer_norm_fn;
+
+  return layer_norm_fn.call(input, weight, bias,
+                            static_cast<int>(normalized_shape.size()), eps);
+}
+
+Tensor cross_entropy(Tensor input, Tensor target) {
+  autograd::CrossEntropyFn cross_entropy_fn;
+
+  return cross_entropy_fn.call(input, target);
+}
+
+Tensor nll_loss(Tensor input, Tensor target) {
+  autograd::NLLLossFn nll_loss_fn;
+
+  return nll_loss_fn.call(input, target);
+}
+
+void set_num_threads(int n) { backend::set_num_threads(n); }
+int get_num_threads() { return backend::get_num_threads(); }
+
+namespace {
+std::atomic<bool> copy_on_write{false};
+}  // namespace
+
+void set_copy_on_write(bool enabled) {
+  copy_on_write.store(enabled, std::memory_order_relaxed);
+}
+bool copy_on_write_enabled() {
+  return copy_on_write.load(std::memory_order_relaxed);
+}
+
 }  // namespace abyss
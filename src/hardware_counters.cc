@@ -0,0 +1,134 @@
+#include "profiler.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace abyss::profiler {
+
+const char* counter_name(Counter counter) {
+  switch (counter) {
+    case Counter::kCycles:
+      return "cycles";
+    case Counter::kInstructions:
+      return "instructions";
+    case Counter::kLLCMisses:
+      return "LLC-misses";
+    case Counter::kBranchMisses:
+      return "branch-misses";
+    case Counter::kDTLBMisses:
+      return "dTLB-misses";
+  }
+  return "unknown";
+}
+
+#ifdef __linux__
+
+namespace {
+
+perf_event_attr counter_attr(Counter counter) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+
+  auto cache_miss = [](uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  };
+  switch (counter) {
+    case Counter::kCycles:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case Counter::kInstructions:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case Counter::kLLCMisses:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache_miss(PERF_COUNT_HW_CACHE_LL);
+      break;
+    case Counter::kBranchMisses:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    case Counter::kDTLBMisses:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache_miss(PERF_COUNT_HW_CACHE_DTLB);
+      break;
+  }
+  // user space only, which is all an unprivileged process may count
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return attr;
+}
+
+int open_counter(perf_event_attr& attr, int group) {
+  // this thread, any cpu
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+}  // namespace
+
+HardwareCounters::HardwareCounters() {
+  fds_.fill(-1);
+  for (int i = 0; i < kNumCounters; i++) {
+    auto counter = static_cast<Counter>(i);
+    auto attr = counter_attr(counter);
+    // the group starts disabled and is enabled once complete
+    attr.disabled = leader_ < 0 ? 1 : 0;
+    int fd = open_counter(attr, leader_);
+    // not supported here, the others may still be
+    if (fd < 0) continue;
+
+    if (leader_ < 0) leader_ = fd;
+    members_[num_members_] = counter;
+    fds_[num_members_++] = fd;
+    available_ |= 1u << i;
+  }
+  if (leader_ >= 0) {
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+HardwareCounters::~HardwareCounters() {
+  for (int i = 0; i < num_members_; i++) close(fds_[i]);
+}
+
+CounterValues HardwareCounters::read() const {
+  CounterValues out;
+  if (leader_ < 0) return out;
+
+  // layout of a group read: nr, time_enabled, time_running, values[nr]
+  uint64_t buffer[3 + kNumCounters] = {};
+  if (::read(leader_, buffer, sizeof(buffer)) < 0) return out;
+  uint64_t enabled = buffer[1], running = buffer[2];
+  // the group never got onto the PMU (e.g. a VM without counters)
+  if (running == 0) return out;
+
+  // scale when the PMU was shared with other groups
+  double scale = double(enabled) / running;
+  for (int i = 0; i < num_members_ && i < int(buffer[0]); i++) {
+    out.values[int(members_[i])] = uint64_t(buffer[3 + i] * scale);
+  }
+  out.available = available_;
+  return out;
+}
+
+#else
+
+HardwareCounters::HardwareCounters() { fds_.fill(-1); }
+HardwareCounters::~HardwareCounters() {}
+CounterValues HardwareCounters::read() const { return {}; }
+
+#endif
+
+}  // namespace abyss::profiler
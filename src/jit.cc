@@ -0,0 +1,681 @@
+#include "jit.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "autograd/grad_mode.h"
+#include "core/dispatcher.h"
+#include "core/utility.h"
+#include "functional.h"
+#include "operators.h"
+#include "profiler.h"
+
+namespace abyss::jit {
+
+/**
+ * expressions
+ */
+
+struct Expr::Node {
+  Op op;
+  int index = 0;
+  double value = 0;
+  std::vector<Expr> args;
+};
+
+Expr::Expr(std::shared_ptr<const Node> node) : node_{std::move(node)} {}
+
+Expr::Expr(double value)
+    : node_{std::make_shared<Node>(Node{Op::kConstant, 0, value, {}})} {}
+
+Expr Expr::input(int index) {
+  if (index < 0) {
+    throw std::runtime_error("jit: input indices start at 0");
+  }
+  return Expr(std::make_shared<Node>(Node{Op::kInput, index, 0, {}}));
+}
+
+Expr Expr::apply(Op op, std::vector<Expr> args) {
+  size_t arity = op == Op::kNeg || op == Op::kExp || op == Op::kLog ? 1 : 2;
+  if (op == Op::kInput || op == Op::kConstant || args.size() != arity) {
+    throw std::runtime_error("jit: wrong number of arguments for an op");
+  }
+  return Expr(std::make_shared<Node>(Node{op, 0, 0, std::move(args)}));
+}
+
+Expr::Op Expr::op() const { return node_->op; }
+int Expr::index() const { return node_->index; }
+double Expr::value() const { return node_->value; }
+const std::vector<Expr>& Expr::args() const { return node_->args; }
+
+int Expr::num_inputs() const {
+  int n = op() == Op::kInput ? index() + 1 : 0;
+  for (const auto& arg : args()) n = std::max(n, arg.num_inputs());
+  return n;
+}
+
+namespace {
+const char* op_name(Expr::Op op) {
+  switch (op) {
+    case Expr::Op::kAdd:
+      return "add";
+    case Expr::Op::kSub:
+      return "sub";
+    case Expr::Op::kMul:
+      return "mul";
+    case Expr::Op::kDiv:
+      return "div";
+    case Expr::Op::kNeg:
+      return "neg";
+    case Expr::Op::kExp:
+      return "exp";
+    case Expr::Op::kLog:
+      return "log";
+    default:
+      return "";
+  }
+}
+}  // namespace
+
+std::string Expr::str() const {
+  std::ostringstream os;
+  switch (op()) {
+    case Op::kInput:
+      os << "x" << index();
+      break;
+    case Op::kConstant:
+      os << value();
+      break;
+    default:
+      os << op_name(op()) << "(";
+      for (size_t i = 0; i < args().size(); i++) {
+        os << (i > 0 ? ", " : "") << args()[i].str();
+      }
+      os << ")";
+  }
+  return os.str();
+}
+
+Expr operator+(Expr a, Expr b) { return Expr::apply(Expr::Op::kAdd, {a, b}); }
+Expr operator-(Expr a, Expr b) { return Expr::apply(Expr::Op::kSub, {a, b}); }
+Expr operator*(Expr a, Expr b) { return Expr::apply(Expr::Op::kMul, {a, b}); }
+Expr operator/(Expr a, Expr b) { return Expr::apply(Expr::Op::kDiv, {a, b}); }
+Expr operator-(Expr a) { return Expr::apply(Expr::Op::kNeg, {a}); }
+Expr exp(Expr a) { return Expr::apply(Expr::Op::kExp, {a}); }
+Expr log(Expr a) { return Expr::apply(Expr::Op::kLog, {a}); }
+
+/**
+ * interpreter
+ */
+
+Tensor interpret(const Expr& expr, const std::vector<Tensor>& inputs) {
+  using Op = Expr::Op;
+  if (expr.op() == Op::kInput) {
+    if (expr.index() >= int(inputs.size())) {
+      throw std::runtime_error("jit: expression reads a missing input");
+    }
+    return inputs[expr.index()];
+  }
+  if (expr.op() == Op::kConstant) return Tensor(expr.value());
+
+  Tensor a = interpret(expr.args()[0], inputs);
+  switch (expr.op()) {
+    case Op::kNeg:
+      return -a;
+    case Op::kExp:
+      return abyss::exp(a);
+    case Op::kLog:
+      return abyss::log(a);
+    default:
+      break;
+  }
+
+  Tensor b = interpret(expr.args()[1], inputs);
+  switch (expr.op()) {
+    case Op::kAdd:
+      return a + b;
+    case Op::kSub:
+      return a - b;
+    case Op::kMul:
+      return a * b;
+    default:
+      return a / b;
+  }
+}
+
+/**
+ * code generation
+ */
+
+namespace {
+
+using KernelFn = void (*)(const void* const* inputs, const long* strides,
+                          const long* shape, void* output);
+
+constexpr const char* kFlags =
+    "-O3 -march=native -std=c++17 -shared -fPIC -ffp-contract=off";
+
+/**
+ * @brief what a kernel is specialized on besides the expression.
+ */
+struct Signature {
+  std::vector<bool> is_double;  // per input, int32 otherwise
+  std::vector<bool> flat;       // per input, indexed like the output
+  int rank = 1;
+};
+
+std::string literal(double value) {
+  char buffer[64];
+  // hexadecimal keeps every bit of the constant
+  std::snprintf(buffer, sizeof(buffer), "%a", value);
+  return std::string("(") + buffer + ")";
+}
+
+/**
+ * @brief C++ for `expr`, the result is double unless every operand is int32,
+ * which mirrors the dtypes the tensor ops produce.
+ */
+std::string emit(const Expr& expr, const Signature& sig, bool& is_double) {
+  using Op = Expr::Op;
+  switch (expr.op()) {
+    case Op::kInput:
+      is_double = sig.is_double[expr.index()];
+      return "x" + std::to_string(expr.index());
+    case Op::kConstant:
+      is_double = true;
+      return literal(expr.value());
+    default:
+      break;
+  }
+
+  bool a_double = false, b_double = false;
+  std::string a = emit(expr.args()[0], sig, a_double);
+  if (expr.args().size() == 1) {
+    is_double = a_double;
+    if (expr.op() == Op::kNeg) return "(-" + a + ")";
+    std::string fn = expr.op() == Op::kExp ? "std::exp" : "std::log";
+    // integer tensors keep their dtype and truncate
+    return is_double ? fn + "(" + a + ")" : "int32_t(" + fn + "(" + a + "))";
+  }
+
+  std::string b = emit(expr.args()[1], sig, b_double);
+  is_double = a_double || b_double;
+  const char* op = expr.op() == Op::kAdd   ? " + "
+                   : expr.op() == Op::kSub ? " - "
+                   : expr.op() == Op::kMul ? " * "
+                                           : " / ";
+  return "(" + a + op + b + ")";
+}
+
+std::string generate(const Expr& expr, const Signature& sig, bool& is_double) {
+  const int n = int(sig.is_double.size());
+  const int rank = sig.rank;
+  std::string value = emit(expr, sig, is_double);
+  auto type = [](bool d) { return d ? "double" : "int32_t"; };
+
+  std::ostringstream os;
+  os << "// " << expr.str() << "\n"
+     << "#include <cmath>\n#include <cstdint>\n\n"
+     << "extern \"C\" void abyss_fused(const void* const* inputs, "
+        "const long* strides, const long* shape, void* output) {\n";
+  for (int k = 0; k < n; k++) {
+    os << "  const " << type(sig.is_double[k]) << "* __restrict in" << k
+       << " = static_cast<const " << type(sig.is_double[k]) << "*>(inputs["
+       << k << "]);\n";
+  }
+  os << "  " << type(is_double) << "* __restrict out = static_cast<"
+     << type(is_double) << "*>(output);\n";
+  for (int k = 0; k < n; k++) {
+    if (sig.flat[k]) continue;
+    for (int d = 0; d < rank; d++) {
+      os << "  const long s" << k << "_" << d << " = strides[" << k * rank + d
+         << "];\n";
+    }
+  }
+
+  // one loop per dimension, running offsets of the output and strided inputs
+  std::string indent = "  ";
+  for (int d = 0; d < rank; d++) {
+    std::string prev = d == 0 ? "0" : std::to_string(d - 1);
+    os << indent << "for (long i" << d << " = 0; i" << d << " < shape[" << d
+       << "]; i" << d << "++) {\n";
+    indent += "  ";
+    os << indent << "const long o" << d << " = "
+       << (d == 0 ? "" : "o" + prev + " * shape[" + std::to_string(d) + "] + ")
+       << "i" << d << ";\n";
+    for (int k = 0; k < n; k++) {
+      if (sig.flat[k]) continue;
+      os << indent << "const long p" << k << "_" << d << " = "
+         << (d == 0 ? "" : "p" + std::to_string(k) + "_" + prev + " + ") << "i"
+         << d << " * s" << k << "_" << d << ";\n";
+    }
+  }
+  const std::string last = std::to_string(rank - 1);
+  for (int k = 0; k < n; k++) {
+    os << indent << "const " << type(sig.is_double[k]) << " x" << k << " = in"
+       << k << "[" << (sig.flat[k] ? "o" + last : "p" + std::to_string(k) + "_" + last)
+       << "];\n";
+  }
+  os << indent << "out[o" << last << "] = " << value << ";\n";
+  for (int d = rank; d > 0; d--) {
+    indent.resize(indent.size() - 2);
+    os << indent << "}\n";
+  }
+  os << "}\n";
+  return os.str();
+}
+
+std::string hash(const std::string& text) {
+  // FNV-1a
+  uint64_t h = 1469598103934665603ull;
+  for (unsigned char c : text) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx",
+                static_cast<unsigned long long>(h));
+  return buffer;
+}
+
+/**
+ * kernel cache
+ */
+
+std::string compiler() {
+  const char* env = std::getenv("ABYSS_JIT_CXX");
+  return env != nullptr ? env : "c++";
+}
+
+/**
+ * @brief what `-march=native` resolves to, so a cache shared between machines
+ * never hands out a kernel built for instructions the host lacks.
+ */
+const std::string& host_cpu() {
+  static const std::string id = [] {
+    std::ostringstream os;
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+      unsigned max_leaf = eax;
+      // vendor
+      os << std::hex << ebx << edx << ecx;
+      // family, model and the feature bits
+      __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+      os << ':' << eax << ':' << ecx << ':' << edx;
+      if (max_leaf >= 7) {
+        __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+        os << ':' << ebx << ':' << ecx << ':' << edx;
+      }
+    }
+#else
+    // the first processor's identity and feature list
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line) && !line.empty()) {
+      for (const char* field : {"model name", "Features", "flags",
+                                "CPU implementer", "CPU part", "isa"}) {
+        if (line.rfind(field, 0) == 0) os << line << '\n';
+      }
+    }
+#endif
+    return os.str();
+  }();
+  return id;
+}
+
+/**
+ * @brief `dir` if it is a directory only the current user can access.
+ */
+bool is_private_dir(const std::string& dir) {
+  struct stat st;
+  return ::lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) &&
+         st.st_uid == ::getuid() && (st.st_mode & 077) == 0;
+}
+
+std::string default_dir() {
+  if (const char* env = std::getenv("ABYSS_JIT_CACHE")) return env;
+  if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+    return std::string(xdg) + "/abyss/jit";
+  }
+  if (const char* home = std::getenv("HOME")) {
+    return std::string(home) + "/.cache/abyss/jit";
+  }
+
+  // /tmp is shared, other users must not be able to plant kernels we load
+  std::string dir = "/tmp/abyss-jit-" + std::to_string(::getuid());
+  ::mkdir(dir.c_str(), 0700);
+  if (is_private_dir(dir)) return dir;
+
+  // someone else owns the name, keep kernels for this process only
+  char tmp[] = "/tmp/abyss-jit-XXXXXX";
+  if (::mkdtemp(tmp) != nullptr) return tmp;
+  throw std::runtime_error(
+      "jit: no private cache directory, set ABYSS_JIT_CACHE");
+}
+
+void make_dirs(const std::string& dir) {
+  for (size_t pos = dir.find('/', 1); pos != std::string::npos;
+       pos = dir.find('/', pos + 1)) {
+    ::mkdir(dir.substr(0, pos).c_str(), 0755);
+  }
+  ::mkdir(dir.c_str(), 0755);
+}
+
+std::vector<std::string> split(const std::string& text) {
+  std::vector<std::string> words;
+  std::istringstream is(text);
+  for (std::string word; is >> word;) words.push_back(word);
+  return words;
+}
+
+/**
+ * @brief run the compiler without a shell, its diagnostics go to `log`.
+ */
+bool compile(const std::string& source, const std::string& output,
+             const std::string& log) {
+  std::vector<std::string> args = split(compiler());
+  if (args.empty()) return false;
+  for (auto& flag : split(kFlags)) args.push_back(flag);
+  args.insert(args.end(), {"-o", output, source});
+
+  std::vector<char*> argv;
+  for (auto& arg : args) argv.push_back(arg.data());
+  argv.push_back(nullptr);
+
+  // everything the child needs is prepared before the fork, other threads
+  // may hold locks it would otherwise wait on forever
+  int fd = ::open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) return false;
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::dup2(fd, STDERR_FILENO);
+    ::execvp(argv[0], argv.data());
+    ::_exit(127);
+  }
+  ::close(fd);
+  if (pid < 0) return false;
+
+  int status = 0;
+  while (::waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) return false;
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+KernelFn open_kernel(const std::string& path) {
+  // kernels stay loaded for the life of the process
+  void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) return nullptr;
+  return reinterpret_cast<KernelFn>(dlsym(handle, "abyss_fused"));
+}
+
+struct Kernel {
+  enum class State { kBuilding, kReady, kFailed };
+  State state = State::kBuilding;
+  KernelFn fn = nullptr;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::string dir = default_dir();
+  // bumped by `set_cache_dir` so builds for the old directory are dropped
+  uint64_t generation = 0;
+  std::unordered_map<std::string, Kernel> kernels;
+  std::vector<std::future<void>> builds;
+  Stats stats;
+
+  ~Registry() {
+    for (auto& build : builds) build.wait();
+  }
+};
+
+Registry& registry() {
+  static Registry instance;
+  return instance;
+}
+
+std::atomic<bool> jit_enabled{[] {
+  const char* env = std::getenv("ABYSS_JIT");
+  return env != nullptr && std::string(env) == "1";
+}()};
+std::atomic<size_t> compiled_calls{0};
+std::atomic<size_t> interpreted_calls{0};
+
+void build(std::string dir, std::string key, std::string source,
+           uint64_t generation) {
+  make_dirs(dir);
+  std::string base = dir + "/" + key;
+  // built aside and renamed so other processes never load a partial file
+  std::string tmp = base + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream file(tmp + ".cc");
+    file << source;
+  }
+  bool ok = compile(tmp + ".cc", tmp + ".so", base + ".log");
+  KernelFn fn = nullptr;
+  if (ok) {
+    std::rename((tmp + ".cc").c_str(), (base + ".cc").c_str());
+    std::rename((tmp + ".so").c_str(), (base + ".so").c_str());
+    std::remove((base + ".log").c_str());
+    fn = open_kernel(base + ".so");
+  } else {
+    // the log is kept next to the source to see what went wrong
+    std::rename((tmp + ".cc").c_str(), (base + ".cc").c_str());
+  }
+
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (r.generation != generation) return;
+  auto& kernel = r.kernels[key];
+  kernel.fn = fn;
+  kernel.state = fn != nullptr ? Kernel::State::kReady : Kernel::State::kFailed;
+  (fn != nullptr ? r.stats.compiled : r.stats.failed)++;
+}
+
+/**
+ * @brief the kernel for `source` if it is ready, starts building it if not.
+ */
+KernelFn find_kernel(const std::string& source) {
+  std::string key = hash(compiler() + kFlags + host_cpu() + source);
+
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  auto it = r.kernels.find(key);
+  if (it != r.kernels.end()) return it->second.fn;
+
+  auto& kernel = r.kernels[key];
+  std::string path = r.dir + "/" + key + ".so";
+  if (::access(path.c_str(), R_OK) == 0) {
+    kernel.fn = open_kernel(path);
+    if (kernel.fn != nullptr) {
+      kernel.state = Kernel::State::kReady;
+      r.stats.loaded++;
+      return kernel.fn;
+    }
+  }
+
+  // finished builds are only collected by `wait`, drop them here as well
+  r.builds.erase(std::remove_if(r.builds.begin(), r.builds.end(),
+                                [](const std::future<void>& f) {
+                                  return f.wait_for(std::chrono::seconds(0)) ==
+                                         std::future_status::ready;
+                                }),
+                 r.builds.end());
+  r.builds.push_back(std::async(std::launch::async, build, r.dir, key, source,
+                                r.generation));
+  return nullptr;
+}
+
+bool is_dense(const core::ArrayDesc& desc) {
+  return desc.strides == core::shape2strides(desc.shape);
+}
+
+/**
+ * @brief shape the inputs broadcast to, empty if they do not.
+ */
+std::vector<int> broadcast_shape(const std::vector<core::ArrayDesc>& descs) {
+  size_t rank = 0;
+  for (const auto& d : descs) rank = std::max(rank, d.shape.size());
+
+  std::vector<int> shape(rank, 1);
+  for (const auto& d : descs) {
+    size_t lead = rank - d.shape.size();
+    for (size_t i = 0; i < d.shape.size(); i++) {
+      int& dim = shape[lead + i];
+      if (d.shape[i] == dim || d.shape[i] == 1) continue;
+      if (dim != 1) return {};
+      dim = d.shape[i];
+    }
+  }
+  return shape;
+}
+
+const void* data_of(core::DataDispatcher<Tensor>& dp) {
+  size_t offset = dp.desc().offset;
+  if (auto* a = core::array_cast<double>(dp)) return a->data() + offset;
+  if (auto* a = core::array_cast<int32_t>(dp)) return a->data() + offset;
+  return nullptr;
+}
+
+}  // namespace
+
+/**
+ * FusedKernel implementations
+ */
+
+FusedKernel::FusedKernel(Expr expr) : expr_{std::move(expr)} {}
+
+Tensor FusedKernel::operator()(const std::vector<Tensor>& inputs) const {
+  auto fallback = [&] {
+    interpreted_calls++;
+    return interpret(expr_, inputs);
+  };
+
+  const int n = expr_.num_inputs();
+  if (!is_enabled() || n == 0 || int(inputs.size()) < n) return fallback();
+
+  std::vector<core::DataDispatcher<Tensor>> dps(inputs.begin(),
+                                                inputs.begin() + n);
+  std::vector<core::ArrayDesc> descs;
+  Signature sig;
+  std::vector<const void*> data;
+  for (int k = 0; k < n; k++) {
+    // the interpreter records what backward needs
+    if (autograd::GradMode::is_enabled() &&
+        inputs[k].flags(core::FlagId::kRequiresGrad)) {
+      return fallback();
+    }
+    data.push_back(data_of(dps[k]));
+    if (data.back() == nullptr) return fallback();
+    sig.is_double.push_back(inputs[k].dtype() == kFloat64);
+    descs.push_back(dps[k].desc());
+  }
+
+  std::vector<int> shape = broadcast_shape(descs);
+  // let the interpreter report the mismatch
+  if (shape.empty()) return fallback();
+
+  bool all_flat = true;
+  for (const auto& d : descs) {
+    sig.flat.push_back(d.shape == shape && is_dense(d));
+    all_flat &= sig.flat.back();
+  }
+
+  // a single loop when nothing needs strides
+  std::vector<long> loop_shape;
+  std::vector<long> strides;
+  if (all_flat) {
+    loop_shape = {long(core::shape2size(shape))};
+  } else {
+    loop_shape.assign(shape.begin(), shape.end());
+    for (const auto& d : descs) {
+      size_t lead = shape.size() - d.shape.size();
+      for (size_t i = 0; i < shape.size(); i++) {
+        // broadcast dimensions repeat their element
+        bool repeated = i < lead || d.shape[i - lead] != shape[i];
+        strides.push_back(repeated ? 0 : d.strides[i - lead]);
+      }
+    }
+  }
+  sig.rank = int(loop_shape.size());
+
+  bool is_double = false;
+  std::string source = generate(expr_, sig, is_double);
+  KernelFn fn = find_kernel(source);
+  if (fn == nullptr) return fallback();
+
+  compiled_calls++;
+  Tensor output = empty(shape, is_double ? kFloat64 : kInt32);
+  core::DataDispatcher<Tensor> out = output;
+  size_t size = core::shape2size(shape);
+  profiler::RecordScope scope("kernel", "jit_fused", double(size));
+  fn(data.data(), strides.data(), loop_shape.data(),
+     const_cast<void*>(data_of(out)));
+  return output;
+}
+
+/**
+ * settings
+ */
+
+void set_enabled(bool enabled) {
+  jit_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_enabled() { return jit_enabled.load(std::memory_order_relaxed); }
+
+void set_cache_dir(const std::string& dir) {
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.dir = dir;
+  r.generation++;
+  r.kernels.clear();
+}
+
+std::string cache_dir() {
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  return r.dir;
+}
+
+void wait() {
+  auto& r = registry();
+  std::vector<std::future<void>> builds;
+  {
+    std::lock_guard<std::mutex> lock(r.mutex);
+    builds.swap(r.builds);
+  }
+  for (auto& build : builds) build.wait();
+}
+
+Stats stats() {
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  Stats out = r.stats;
+  out.compiled_calls = compiled_calls.load();
+  out.interpreted_calls = interpreted_calls.load();
+  return out;
+}
+
+}  // namespace abyss::jit
@@ -0,0 +1,248 @@
+#include "memory_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "autograd/function.h"
+#include "autograd/graph.h"
+#include "core/dispatcher.h"
+#include "profiler.h"
+
+namespace abyss::memory {
+
+namespace {
+std::atomic<size_t> live_bytes{0};
+std::atomic<size_t> peak_bytes{0};
+std::atomic<size_t> allocations{0};
+std::atomic<size_t> frees{0};
+
+thread_local const char* thread_site = nullptr;
+
+/**
+ * @brief live buffers by site, only kept while tracking.
+ */
+struct SiteTable {
+  std::mutex mutex;
+  std::vector<SiteStats> sites;
+  std::unordered_map<std::string, size_t> by_name;
+  // buffer -> (site, bytes)
+  std::unordered_map<const void*, std::pair<size_t, size_t>> buffers;
+
+  size_t site_id(const char* label) {
+    std::string name = label != nullptr ? label : "unlabelled";
+    auto it = by_name.find(name);
+    if (it != by_name.end()) return it->second;
+
+    sites.push_back({name});
+    by_name.emplace(name, sites.size() - 1);
+    return sites.size() - 1;
+  }
+
+  void clear() {
+    sites.clear();
+    by_name.clear();
+    buffers.clear();
+  }
+};
+
+SiteTable& site_table() {
+  static SiteTable table;
+  return table;
+}
+
+const void* storage(core::DataDispatcher<Tensor>& dp) {
+  if (auto* a = core::array_cast<double>(dp)) return a->data();
+  if (auto* a = core::array_cast<int32_t>(dp)) return a->data();
+  if (auto* a = core::array_cast<uint8_t>(dp)) return a->data();
+  if (auto* a = core::array_cast<bool>(dp)) return a->data();
+  return nullptr;
+}
+}  // namespace
+
+/**
+ * allocator hooks
+ */
+
+namespace detail {
+
+std::atomic<bool> tracking_sites{false};
+
+void on_allocate(const void* ptr, size_t nbytes) {
+  size_t live = live_bytes.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  size_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+
+  if (profiler::is_enabled()) profiler::detail::count_allocation(nbytes);
+
+  auto& table = site_table();
+  if (is_tracking_sites()) {
+    std::lock_guard<std::mutex> lock(table.mutex);
+    size_t id = table.site_id(thread_site);
+    auto& site = table.sites[id];
+    site.live_bytes += nbytes;
+    site.peak_bytes = std::max(site.peak_bytes, site.live_bytes);
+    site.allocations++;
+    table.buffers[ptr] = {id, nbytes};
+  }
+}
+
+void on_free(const void* ptr, size_t nbytes) {
+  if (ptr == nullptr) return;
+  live_bytes.fetch_sub(nbytes, std::memory_order_relaxed);
+  frees.fetch_add(1, std::memory_order_relaxed);
+
+  auto& table = site_table();
+  if (is_tracking_sites()) {
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.buffers.find(ptr);
+    if (it != table.buffers.end()) {
+      table.sites[it->second.first].live_bytes -= it->second.second;
+      table.buffers.erase(it);
+    }
+  }
+}
+
+const char* current_site() { return thread_site; }
+void set_current_site(const char* site) { thread_site = site; }
+
+}  // namespace detail
+
+/**
+ * counters
+ */
+
+Stats stats() {
+  Stats out;
+  out.live_bytes = live_bytes.load(std::memory_order_relaxed);
+  out.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+  out.allocations = allocations.load(std::memory_order_relaxed);
+  out.frees = frees.load(std::memory_order_relaxed);
+  return out;
+}
+
+void reset_peak() {
+  peak_bytes.store(live_bytes.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+
+  auto& table = site_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  for (auto& site : table.sites) site.peak_bytes = site.live_bytes;
+}
+
+void track_sites(bool enable) {
+  auto& table = site_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  detail::tracking_sites.store(enable, std::memory_order_relaxed);
+  if (!enable) table.clear();
+}
+
+std::vector<SiteStats> site_stats() {
+  auto& table = site_table();
+  std::vector<SiteStats> out;
+  {
+    std::lock_guard<std::mutex> lock(table.mutex);
+    out = table.sites;
+  }
+  std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+    return a.live_bytes > b.live_bytes;
+  });
+  return out;
+}
+
+/**
+ * snapshots
+ */
+
+Snapshot snapshot() {
+  Snapshot snap;
+  snap.stats = stats();
+
+  auto& table = site_table();
+  std::unordered_map<std::string, size_t> graph_by_site;
+  std::unordered_set<const void*> seen;
+  for (const auto& edge : autograd::Graph::instance().edges()) {
+    for (auto& tensor : edge.second.saved_tensors()) {
+      core::DataDispatcher<Tensor> dp = tensor;
+      if (dp.data() == nullptr) continue;
+
+      SavedTensor saved;
+      saved.node = edge.first->name();
+      saved.shape = tensor.shape();
+      saved.dtype = profiler::detail::dtype_name(tensor.dtype().id());
+      saved.nbytes = dp.data()->nbytes();
+
+      const void* ptr = storage(dp);
+      if (is_tracking_sites()) {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto it = table.buffers.find(ptr);
+        if (it != table.buffers.end()) {
+          saved.site = table.sites[it->second.first].site;
+        }
+      }
+
+      // buffers saved by several nodes are only counted once
+      if (seen.insert(ptr).second) {
+        snap.graph_bytes += saved.nbytes;
+        if (!saved.site.empty()) graph_by_site[saved.site] += saved.nbytes;
+      }
+      snap.saved.emplace_back(std::move(saved));
+    }
+  }
+  std::sort(snap.saved.begin(), snap.saved.end(),
+            [](const auto& a, const auto& b) { return a.nbytes > b.nbytes; });
+
+  // buffers allocated outside the accounting (e.g. borrowed) may be saved
+  snap.free_bytes = snap.stats.live_bytes -
+                    std::min(snap.graph_bytes, snap.stats.live_bytes);
+
+  snap.sites = site_stats();
+  for (auto& site : snap.sites) {
+    auto it = graph_by_site.find(site.site);
+    if (it != graph_by_site.end()) site.graph_bytes = it->second;
+  }
+
+  return snap;
+}
+
+std::ostream& operator<<(std::ostream& os, const Snapshot& snapshot) {
+  const auto& s = snapshot.stats;
+  os << "live " << s.live_bytes << " B (graph " << snapshot.graph_bytes
+     << " B, free-standing " << snapshot.free_bytes << " B), peak "
+     << s.peak_bytes << " B, " << s.allocations << " allocations, " << s.frees
+     << " frees\n";
+
+  if (!snapshot.sites.empty()) {
+    os << std::left << std::setw(32) << "site" << std::right << std::setw(14)
+       << "live" << std::setw(14) << "graph" << std::setw(14) << "peak"
+       << std::setw(10) << "allocs" << "\n";
+    for (const auto& site : snapshot.sites) {
+      os << std::left << std::setw(32) << site.site.substr(0, 31) << std::right
+         << std::setw(14) << site.live_bytes << std::setw(14)
+         << site.graph_bytes << std::setw(14) << site.peak_bytes
+         << std::setw(10) << site.allocations << "\n";
+    }
+  }
+
+  if (!snapshot.saved.empty()) {
+    os << "saved tensors:\n";
+    for (const auto& saved : snapshot.saved) {
+      os << "  " << saved.node << " " << saved.dtype << "(";
+      for (size_t i = 0; i < saved.shape.size(); i++) {
+        os << (i > 0 ? ", " : "") << saved.shape[i];
+      }
+      os << ") " << saved.nbytes << " B";
+      if (!saved.site.empty()) os << " from " << saved.site;
+      os << "\n";
+    }
+  }
+  return os;
+}
+
+}  // namespace abyss::memory
@@ -11,4 +11,16 @@ Tensor LogSoftmax::forward(Tensor input) {
   return log(exp(input) / sum(exp(input), axis_));
 }
 
+ReLU::ReLU(bool inplace) : inplace_{inplace} {}
+
+Tensor ReLU::forward(Tensor input) {
+  return inplace_ ? relu_(input) : relu(input);
+}
+
+Tensor GELU::forward(Tensor input) { return gelu(input); }
+
+Tensor Sigmoid::forward(Tensor input) { return sigmoid(input); }
+
+Tensor Tanh::forward(Tensor input) { return tanh(input); }
+
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "nn/convolution.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "functional.h"
+#include "operators.h"
+
+namespace abyss::nn {
+
+Conv2d::Conv2d(int in_channels, int out_channels, int kernel_size, int stride,
+               int padding, int dilation, int groups, bool bias)
+    : stride_{stride}, padding_{padding}, dilation_{dilation}, groups_{groups} {
+  if (groups < 1 || in_channels % groups != 0 || out_channels % groups != 0) {
+    throw std::runtime_error("channels must be divisible by groups");
+  }
+
+  // keep the output variance independent of the receptive field size
+  int fan_in = in_channels / groups * kernel_size * kernel_size;
+  weight_ = make_parameter(
+      randn({out_channels, in_channels / groups, kernel_size, kernel_size}) *
+      Tensor(1.0 / std::sqrt(fan_in)));
+  if (bias) {
+    bias_ = make_parameter(full({out_channels}, 0.0), true);
+  }
+}
+
+Tensor Conv2d::forward(Tensor input) {
+  return conv2d(input, weight_, bias_, stride_, padding_, dilation_, groups_);
+}
+
+}  // namespace abyss::nn
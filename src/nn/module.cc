@@ -4,10 +4,12 @@
 #include "operators.h"
 
 namespace abyss::nn {
-std::vector<Tensor> Module::parameters_;
-std::unordered_map<std::string, Tensor*> Module::states_;
+thread_local std::vector<Tensor> Module::parameters_;
+thread_local std::unordered_map<std::string, Tensor*> Module::states_;
 
 Tensor& make_parameter(Tensor data, bool requires_grad) {
+  // initializers may be computed (e.g. scaled), parameters are still leaves
+  data.set_flag(abyss::core::FlagId::kIsLeaf, true);
   data.set_flag(abyss::core::FlagId::kRequiresGrad, requires_grad);
   Module::parameters_.emplace_back(data);
 
@@ -16,6 +18,10 @@ Tensor& make_parameter(Tensor data, bool requires_grad) {
 
 std::vector<Tensor>& Module::parameters() { return parameters_; }
 
+void Module::train(bool mode) { training_ = mode; }
+void Module::eval() { train(false); }
+bool Module::is_training() const { return training_; }
+
 // Tensor Module::operator()(Tensor input_batch) {
 //   Tensor out;
 //   // loop through batch
@@ -32,14 +38,21 @@ std::vector<Tensor>& Module::parameters() { return parameters_; }
 //   return out;
 // }
 
-Linear::Linear(int in_features, int out_features, bool bias) {
+Linear::Linear(int in_features, int out_features, bool bias,
+               Activation activation)
+    : activation_{activation} {
   weight_ = make_parameter(randn({out_features, in_features}));
-  bias_ = full({in_features, 1}, 0.0);
+  bias_ = full({out_features, 1}, 0.0);
   if (bias) {
     bias_ = make_parameter(bias_, true);
   }
 }
 
-Tensor Linear::forward(Tensor input) { return matmul(weight_, input) + bias_; }
+Tensor Linear::forward(Tensor input) {
+  if (input.ndims() != 2) {
+    return bias_activation(matmul(weight_, input), bias_, 0, activation_);
+  }
+  return linear(input, weight_, bias_, activation_);
+}
 
 }  // namespace abyss::nn
@@ -0,0 +1,43 @@
+#include "nn/normalization.h"
+
+#include <stdexcept>
+
+#include "functional.h"
+
+namespace abyss::nn {
+
+BatchNorm2d::BatchNorm2d(int num_features, double eps, double momentum,
+                         bool affine)
+    : eps_{eps}, momentum_{momentum} {
+  if (affine) {
+    weight_ = make_parameter(full({num_features}, 1.0));
+    bias_ = make_parameter(full({num_features}, 0.0));
+  }
+  // buffers, updated in place but never optimized
+  running_mean_ = full({num_features}, 0.0);
+  running_var_ = full({num_features}, 1.0);
+}
+
+Tensor BatchNorm2d::forward(Tensor input) {
+  if (input.ndims() != 4) {
+    throw std::runtime_error("BatchNorm2d expects input of shape (N, C, H, W)");
+  }
+
+  return batch_norm(input, running_mean_, running_var_, weight_, bias_,
+                    training_, momentum_, eps_);
+}
+
+LayerNorm::LayerNorm(std::vector<int> normalized_shape, double eps,
+                     bool elementwise_affine)
+    : normalized_shape_{normalized_shape}, eps_{eps} {
+  if (elementwise_affine) {
+    weight_ = make_parameter(full(normalized_shape, 1.0));
+    bias_ = make_parameter(full(normalized_shape, 0.0));
+  }
+}
+
+Tensor LayerNorm::forward(Tensor input) {
+  return layer_norm(input, normalized_shape_, weight_, bias_, eps_);
+}
+
+}  // namespace abyss::nn
@@ -0,0 +1,21 @@
+#include "nn/pooling.h"
+
+#include "functional.h"
+
+namespace abyss::nn {
+
+MaxPool2d::MaxPool2d(int kernel_size, int stride, int padding)
+    : kernel_size_{kernel_size}, stride_{stride}, padding_{padding} {}
+
+Tensor MaxPool2d::forward(Tensor input) {
+  return max_pool2d(input, kernel_size_, stride_, padding_);
+}
+
+AvgPool2d::AvgPool2d(int kernel_size, int stride, int padding)
+    : kernel_size_{kernel_size}, stride_{stride}, padding_{padding} {}
+
+Tensor AvgPool2d::forward(Tensor input) {
+  return avg_pool2d(input, kernel_size_, stride_, padding_);
+}
+
+}  // namespace abyss::nn
@@ -0,0 +1,184 @@
+#include "act_ops.h"
+
+#include <stdexcept>
+
+#include "operand.h"
+
+namespace abyss::core {
+
+backend::Activation to_backend(Activation act) {
+  switch (act) {
+    case Activation::kIdentity:
+      return backend::Activation::kIdentity;
+    case Activation::kReLU:
+      return backend::Activation::kReLU;
+    case Activation::kGELU:
+      return backend::Activation::kGELU;
+    case Activation::kSigmoid:
+      return backend::Activation::kSigmoid;
+    case Activation::kTanh:
+      return backend::Activation::kTanh;
+  }
+  throw std::runtime_error("unknown activation");
+}
+
+namespace {
+
+/**
+ * @brief bias operand broadcast along `axis` of `shape`.
+ */
+struct Bias : Operand<double> {
+  size_t channels = 1;
+  size_t inner = 1;
+
+  Bias(const Tensor& bias, const std::vector<int>& shape, int axis) {
+    DataDispatcher<Tensor> dp = bias;
+    if (dp.data() == nullptr) return;
+
+    if (axis < 0) axis += shape.size();
+    if (axis < 0 || axis >= static_cast<int>(shape.size())) {
+      throw std::runtime_error("activation: bias axis out of range");
+    }
+    channels = shape[axis];
+    for (size_t i = axis + 1; i < shape.size(); i++) inner *= shape[i];
+
+    static_cast<Operand<double>&>(*this) =
+        Operand<double>(bias, channels, "activation: bias");
+  }
+
+  backend::BiasLayout layout() const { return {data(), channels, inner}; }
+};
+
+size_t mask_size(size_t n) { return (n + 7) / 8; }
+
+}  // namespace
+
+/**
+ * ActivationVisitor implementation
+ */
+ActivationVisitor::ActivationVisitor(ArrayDesc desc, Activation act,
+                                     ActivationOperands operands, bool inplace)
+    : desc_in_{desc}, act_{act}, operands_{operands}, inplace_{inplace} {}
+
+void ActivationVisitor::visit(ArrayImpl<double>* input) {
+  if (!is_contiguous(desc_in_)) {
+    throw std::runtime_error("activation expects a contiguous input");
+  }
+  const size_t n = shape2size(desc_in_.shape);
+
+  Bias bias(operands_.bias, desc_in_.shape, operands_.axis);
+  Operand<uint8_t> mask(operands_.mask, mask_size(n), "activation: mask");
+
+  std::shared_ptr<Array> out;
+  size_t out_offset = 0;
+  if (inplace_) {
+    out = input->shared_from_this();
+    out_offset = desc_in_.offset;
+  } else {
+    out = std::make_shared<ArrayImpl<double>>(n);
+  }
+
+  auto o = static_cast<ArrayImpl<double>*>(out.get());
+  size_t offset = desc_in_.offset;
+  auto act = to_backend(act_);
+  autograd::run_kernel(
+      "activation",
+      [=]() {
+        backend::activation(act, input->data() + offset, bias.layout(), n,
+                            o->data() + out_offset, mask.data());
+      },
+      {input, bias.array}, {o, mask.array}, n);
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc_in_.shape;
+  desc_.strides = shape2strides(desc_in_.shape);
+  desc_.offset = out_offset;
+  data_ = out;
+}
+
+/**
+ * ActivationBackwardVisitor implementation
+ */
+ActivationBackwardVisitor::ActivationBackwardVisitor(
+    ArrayDesc desc, Activation act, ActivationOperands operands)
+    : desc_in_{desc}, act_{act}, operands_{operands} {}
+
+void ActivationBackwardVisitor::visit(ArrayImpl<double>* output_grad) {
+  if (!is_contiguous(desc_in_)) {
+    throw std::runtime_error("activation expects a contiguous gradient");
+  }
+  const size_t n = shape2size(desc_in_.shape);
+
+  Bias bias(operands_.bias, desc_in_.shape, operands_.axis);
+  Operand<uint8_t> mask(operands_.mask, mask_size(n), "activation: mask");
+  Operand<double> saved(operands_.saved, n, "activation: saved tensor");
+  if (act_ == Activation::kReLU ? mask.array == nullptr
+                                : act_ != Activation::kIdentity &&
+                                      saved.array == nullptr) {
+    throw std::runtime_error("activation: backward is missing saved state");
+  }
+
+  auto out = std::make_shared<ArrayImpl<double>>(n);
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  auto act = to_backend(act_);
+  autograd::run_kernel(
+      "activation_backward",
+      [=]() {
+        backend::activation_backward(act, output_grad->data() + offset,
+                                     saved.data(), bias.layout(), mask.data(),
+                                     n, o->data());
+      },
+      {output_grad, saved.array, bias.array, mask.array}, {o}, n);
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc_in_.shape;
+  desc_.strides = shape2strides(desc_in_.shape);
+  data_ = out;
+}
+
+/**
+ * BiasGradVisitor implementation
+ */
+BiasGradVisitor::BiasGradVisitor(ArrayDesc desc, int axis, DimVector bias_shape)
+    : desc_in_{desc}, axis_{axis}, bias_shape_{bias_shape} {}
+
+void BiasGradVisitor::visit(ArrayImpl<double>* grad) {
+  if (!is_contiguous(desc_in_)) {
+    throw std::runtime_error("activation expects a contiguous gradient");
+  }
+  const size_t n = shape2size(desc_in_.shape);
+
+  int axis = axis_ < 0 ? axis_ + desc_in_.shape.size() : axis_;
+  if (axis < 0 || axis >= static_cast<int>(desc_in_.shape.size())) {
+    throw std::runtime_error("activation: bias axis out of range");
+  }
+  const size_t channels = desc_in_.shape[axis];
+  if (shape2size(bias_shape_) != channels) {
+    throw std::runtime_error("activation: invalid bias");
+  }
+  size_t inner = 1;
+  for (size_t i = axis + 1; i < desc_in_.shape.size(); i++) {
+    inner *= desc_in_.shape[i];
+  }
+
+  auto out = std::make_shared<ArrayImpl<double>>(channels);
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  autograd::run_kernel(
+      "bias_backward",
+      [=]() {
+        backend::bias_backward(grad->data() + offset, channels, inner, n,
+                               o->data());
+      },
+      {grad}, {o}, n);
+
+  dtype_ = stypeof<double>();
+  desc_.shape = bias_shape_;
+  desc_.strides = shape2strides(bias_shape_);
+  data_ = out;
+}
+
+}  // namespace abyss::core
@@ -0,0 +1,96 @@
+#ifndef ABYSS_CORE_ACT_OPS_H
+#define ABYSS_CORE_ACT_OPS_H
+
+#include <memory>
+#include <vector>
+
+#include "autograd/capture.h"
+#include "backend/activation.h"
+#include "core/array.h"
+#include "core/dispatcher.h"
+#include "core/utility.h"
+#include "core/visitor.h"
+#include "functional.h"
+#include "tensor.h"
+
+namespace abyss::core {
+
+backend::Activation to_backend(Activation act);
+
+/**
+ * @brief operands of the activation kernels besides the input.
+ *
+ * `bias` (one value per entry of `axis`) is added before the activation,
+ * `mask` is a preallocated uint8 tensor of `(size + 7) / 8` bytes receiving
+ * the ReLU sign bits. Empty tensors are skipped.
+ */
+struct ActivationOperands {
+  Tensor bias;
+  int axis = 0;
+  Tensor mask;
+  // what the backward reads: the output for sigmoid/tanh, the input for GELU
+  Tensor saved;
+};
+
+/**
+ * @brief act(input + bias) in a single pass.
+ *
+ * With `inplace` the result is written into the (contiguous) input buffer and
+ * shares its storage.
+ */
+class ActivationVisitor final : public VisitorBase,
+                                public Tensor,
+                                public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  ActivationVisitor(ArrayDesc desc, Activation act, ActivationOperands operands,
+                    bool inplace = false);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  Activation act_;
+  ActivationOperands operands_;
+  bool inplace_;
+};
+
+/**
+ * @brief gradient w.r.t. the pre-activation `input + bias`.
+ *
+ * ReLU only reads the mask, the other activations `operands.saved`.
+ */
+class ActivationBackwardVisitor final : public VisitorBase,
+                                        public Tensor,
+                                        public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  ActivationBackwardVisitor(ArrayDesc desc, Activation act,
+                            ActivationOperands operands);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  Activation act_;
+  ActivationOperands operands_;
+};
+
+/**
+ * @brief sums a gradient over every axis but `axis`, shaped like `bias_shape`.
+ */
+class BiasGradVisitor final : public VisitorBase,
+                              public Tensor,
+                              public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  BiasGradVisitor(ArrayDesc desc, int axis, DimVector bias_shape);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  int axis_;
+  DimVector bias_shape_;
+};
+
+}  // namespace abyss::core
+
+#endif
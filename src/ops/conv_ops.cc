@@ -0,0 +1,207 @@
+#include "conv_ops.h"
+
+#include <stdexcept>
+
+namespace abyss::core {
+
+backend::Conv2dGeometry conv2d_geometry(const std::vector<int>& input_shape,
+                                        const std::vector<int>& weight_shape,
+                                        const Conv2dParams& params) {
+  if (input_shape.size() != 4 || weight_shape.size() != 4) {
+    throw std::runtime_error(
+        "conv2d expects input (N, C, H, W) and weight (O, C / groups, KH, KW)");
+  }
+  for (int i = 0; i < 2; i++) {
+    if (params.stride[i] < 1 || params.dilation[i] < 1 ||
+        params.padding[i] < 0) {
+      throw std::runtime_error("conv2d: invalid stride, padding or dilation");
+    }
+  }
+
+  backend::Conv2dGeometry g;
+  g.batch = input_shape[0];
+  g.in_channels = input_shape[1];
+  g.height = input_shape[2];
+  g.width = input_shape[3];
+  g.out_channels = weight_shape[0];
+  g.kernel_h = weight_shape[2];
+  g.kernel_w = weight_shape[3];
+  g.stride_h = params.stride[0];
+  g.stride_w = params.stride[1];
+  g.pad_h = params.padding[0];
+  g.pad_w = params.padding[1];
+  g.dilation_h = params.dilation[0];
+  g.dilation_w = params.dilation[1];
+  g.groups = params.groups;
+
+  if (g.groups < 1 || g.in_channels % g.groups != 0 ||
+      g.out_channels % g.groups != 0) {
+    throw std::runtime_error("conv2d: channels must be divisible by groups");
+  }
+  if (weight_shape[1] != g.in_channels / g.groups) {
+    throw std::runtime_error("conv2d: weight does not match input channels");
+  }
+
+  g.out_height = (g.height + 2 * g.pad_h - g.dilation_h * (g.kernel_h - 1) - 1) /
+                     g.stride_h + 1;
+  g.out_width = (g.width + 2 * g.pad_w - g.dilation_w * (g.kernel_w - 1) - 1) /
+                    g.stride_w + 1;
+  if (g.out_height < 1 || g.out_width < 1) {
+    throw std::runtime_error("conv2d: kernel is larger than the padded input");
+  }
+
+  return g;
+}
+
+namespace {
+void check_output_grad(const ArrayDesc& desc, const backend::Conv2dGeometry& g) {
+  if (desc.shape !=
+      std::vector<int>{g.batch, g.out_channels, g.out_height, g.out_width}) {
+    throw std::runtime_error("conv2d: gradient does not match output shape");
+  }
+}
+
+// multiply-adds of the forward pass, each backward product costs the same
+double conv2d_flops(const backend::Conv2dGeometry& g) {
+  return 2.0 * g.batch * g.out_channels * g.out_height * g.out_width *
+         (g.in_channels / g.groups) * g.kernel_h * g.kernel_w;
+}
+}  // namespace
+
+/**
+ * Conv2dVisitor implementation
+ */
+Conv2dVisitor::Conv2dVisitor(ArrayDesc desc1, ArrayDesc desc2,
+                             Conv2dParams params)
+    : desc1_{desc1}, desc2_{desc2}, params_{params} {}
+
+void Conv2dVisitor::visit(ArrayImpl<double>* input, ArrayImpl<double>* weight) {
+  auto g = conv2d_geometry(desc1_.shape, desc2_.shape, params_);
+  std::vector<int> shape{g.batch, g.out_channels, g.out_height, g.out_width};
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset1 = desc1_.offset;
+  size_t offset2 = desc2_.offset;
+  autograd::run_kernel(
+      "conv2d",
+      [=]() {
+        backend::conv2d(input->data() + offset1, weight->data() + offset2, g,
+                        o->data());
+      },
+      {input, weight}, {o}, conv2d_flops(g));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = shape;
+  desc_.strides = shape2strides(shape);
+  data_ = out;
+}
+
+/**
+ * Conv2dInputGradVisitor implementation
+ */
+Conv2dInputGradVisitor::Conv2dInputGradVisitor(ArrayDesc desc1, ArrayDesc desc2,
+                                               std::vector<int> input_shape,
+                                               Conv2dParams params)
+    : desc1_{desc1},
+      desc2_{desc2},
+      input_shape_{input_shape},
+      params_{params} {}
+
+void Conv2dInputGradVisitor::visit(ArrayImpl<double>* output_grad,
+                                   ArrayImpl<double>* weight) {
+  auto g = conv2d_geometry(input_shape_, desc2_.shape, params_);
+  check_output_grad(desc1_, g);
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(input_shape_));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset1 = desc1_.offset;
+  size_t offset2 = desc2_.offset;
+  autograd::run_kernel(
+      "conv2d_backward_input",
+      [=]() {
+        backend::conv2d_backward_input(output_grad->data() + offset1,
+                                       weight->data() + offset2, g, o->data());
+      },
+      {output_grad, weight}, {o}, conv2d_flops(g));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = input_shape_;
+  desc_.strides = shape2strides(input_shape_);
+  data_ = out;
+}
+
+/**
+ * Conv2dWeightGradVisitor implementation
+ */
+Conv2dWeightGradVisitor::Conv2dWeightGradVisitor(ArrayDesc desc1,
+                                                 ArrayDesc desc2,
+                                                 std::vector<int> weight_shape,
+                                                 Conv2dParams params)
+    : desc1_{desc1},
+      desc2_{desc2},
+      weight_shape_{weight_shape},
+      params_{params} {}
+
+void Conv2dWeightGradVisitor::visit(ArrayImpl<double>* output_grad,
+                                    ArrayImpl<double>* input) {
+  auto g = conv2d_geometry(desc2_.shape, weight_shape_, params_);
+  check_output_grad(desc1_, g);
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(weight_shape_));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset1 = desc1_.offset;
+  size_t offset2 = desc2_.offset;
+  autograd::run_kernel(
+      "conv2d_backward_weight",
+      [=]() {
+        backend::conv2d_backward_weight(output_grad->data() + offset1,
+                                        input->data() + offset2, g, o->data());
+      },
+      {output_grad, input}, {o}, conv2d_flops(g));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = weight_shape_;
+  desc_.strides = shape2strides(weight_shape_);
+  data_ = out;
+}
+
+/**
+ * Conv2dBiasGradVisitor implementation
+ */
+Conv2dBiasGradVisitor::Conv2dBiasGradVisitor(ArrayDesc desc) : desc_in_{desc} {}
+
+void Conv2dBiasGradVisitor::visit(ArrayImpl<double>* output_grad) {
+  if (desc_in_.shape.size() != 4) {
+    throw std::runtime_error("conv2d: gradient does not match output shape");
+  }
+
+  // only the output dimensions are read by the bias kernel
+  backend::Conv2dGeometry g{};
+  g.batch = desc_in_.shape[0];
+  g.out_channels = desc_in_.shape[1];
+  g.out_height = desc_in_.shape[2];
+  g.out_width = desc_in_.shape[3];
+
+  auto out = std::make_shared<ArrayImpl<double>>(g.out_channels);
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  autograd::run_kernel(
+      "conv2d_backward_bias",
+      [=]() {
+        backend::conv2d_backward_bias(output_grad->data() + offset, g,
+                                      o->data());
+      },
+      {output_grad}, {o}, shape2size(desc_in_.shape));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = {g.out_channels};
+  desc_.strides = {1};
+  data_ = out;
+}
+
+}  // namespace abyss::core
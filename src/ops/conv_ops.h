@@ -0,0 +1,114 @@
+#ifndef ABYSS_CORE_CONV_OPS_H
+#define ABYSS_CORE_CONV_OPS_H
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "autograd/capture.h"
+#include "backend/convolution.h"
+#include "core/array.h"
+#include "core/utility.h"
+#include "core/visitor.h"
+#include "tensor.h"
+
+namespace abyss::core {
+
+/**
+ * @brief hyper-parameters of a 2d convolution, as (height, width) pairs.
+ */
+struct Conv2dParams {
+  std::array<int, 2> stride = {1, 1};
+  std::array<int, 2> padding = {0, 0};
+  std::array<int, 2> dilation = {1, 1};
+  int groups = 1;
+};
+
+/**
+ * @brief resolve and validate the geometry of a NCHW convolution.
+ *
+ * @param input_shape (batch, in_channels, height, width)
+ * @param weight_shape (out_channels, in_channels / groups, kernel_h, kernel_w)
+ */
+backend::Conv2dGeometry conv2d_geometry(const std::vector<int>& input_shape,
+                                        const std::vector<int>& weight_shape,
+                                        const Conv2dParams& params);
+
+/**
+ * @brief convolution of (input, weight), the bias is added by the caller.
+ *
+ * Both operands must be contiguous.
+ */
+class Conv2dVisitor final
+    : public VisitorBase,
+      public Tensor,
+      public BinaryVisitor<ArrayImpl<double>, ArrayImpl<double>> {
+ public:
+  Conv2dVisitor(ArrayDesc desc1, ArrayDesc desc2, Conv2dParams params);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc1_;
+  ArrayDesc desc2_;
+  Conv2dParams params_;
+};
+
+/**
+ * @brief gradient w.r.t. the input, visits (output_grad, weight).
+ */
+class Conv2dInputGradVisitor final
+    : public VisitorBase,
+      public Tensor,
+      public BinaryVisitor<ArrayImpl<double>, ArrayImpl<double>> {
+ public:
+  Conv2dInputGradVisitor(ArrayDesc desc1, ArrayDesc desc2,
+                         std::vector<int> input_shape, Conv2dParams params);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc1_;
+  ArrayDesc desc2_;
+  std::vector<int> input_shape_;
+  Conv2dParams params_;
+};
+
+/**
+ * @brief gradient w.r.t. the weight, visits (output_grad, input).
+ */
+class Conv2dWeightGradVisitor final
+    : public VisitorBase,
+      public Tensor,
+      public BinaryVisitor<ArrayImpl<double>, ArrayImpl<double>> {
+ public:
+  Conv2dWeightGradVisitor(ArrayDesc desc1, ArrayDesc desc2,
+                          std::vector<int> weight_shape, Conv2dParams params);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc1_;
+  ArrayDesc desc2_;
+  std::vector<int> weight_shape_;
+  Conv2dParams params_;
+};
+
+/**
+ * @brief gradient w.r.t. a per channel bias, visits output_grad.
+ */
+class Conv2dBiasGradVisitor final : public VisitorBase,
+                                    public Tensor,
+                                    public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  explicit Conv2dBiasGradVisitor(ArrayDesc desc);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+};
+
+}  // namespace abyss::core
+
+#endif
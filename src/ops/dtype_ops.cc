@@ -10,6 +10,9 @@ EmptyVisitor::EmptyVisitor(std::vector<int> shape) : shape_{shape} {}
 void EmptyVisitor::visit(DTypeImpl<bool>* dtype) {
   eval(dtype);
 }
+void EmptyVisitor::visit(DTypeImpl<uint8_t>* dtype) {
+  eval(dtype);
+}
 void EmptyVisitor::visit(DTypeImpl<int32_t>* dtype) {
   eval(dtype);
 }
@@ -17,6 +20,18 @@ void EmptyVisitor::visit(DTypeImpl<double>* dtype) {
   eval(dtype);
 }
 
+/**
+ * FromBlobVisitor Implementation
+ */
+FromBlobVisitor::FromBlobVisitor(void* data, ArrayDesc desc,
+                                 std::shared_ptr<void> owner)
+    : blob_{data}, blob_desc_{std::move(desc)}, owner_{std::move(owner)} {}
+
+void FromBlobVisitor::visit(DTypeImpl<bool>* dtype) { eval(dtype); }
+void FromBlobVisitor::visit(DTypeImpl<uint8_t>* dtype) { eval(dtype); }
+void FromBlobVisitor::visit(DTypeImpl<int32_t>* dtype) { eval(dtype); }
+void FromBlobVisitor::visit(DTypeImpl<double>* dtype) { eval(dtype); }
+
 /**
  * FullVisitor Implementation
  */
@@ -58,7 +73,26 @@ void FullVisitor::visit(ArrayImpl<double>* value, DTypeImpl<double>* dtype) {
 //   eval(dtype);
 // }
 
-  RandNormalVisitor::RandNormalVisitor(std::vector<int> shape) : shape_{shape} {}
-  void RandNormalVisitor::visit(DTypeImpl<double>* dtype) { eval(dtype); }
+/**
+ * Random visitors Implementation
+ */
+
+RandomVisitor::RandomVisitor(std::vector<int> shape, uint64_t seed,
+                             uint64_t offset)
+    : shape_{shape}, seed_{seed}, offset_{offset} {}
+
+RandNormalVisitor::RandNormalVisitor(std::vector<int> shape, uint64_t seed,
+                                     uint64_t offset)
+    : RandomVisitor(shape, seed, offset) {}
+void RandNormalVisitor::visit(DTypeImpl<double>* dtype) {
+  eval(dtype, backend::normal);
+}
+
+RandUniformVisitor::RandUniformVisitor(std::vector<int> shape, uint64_t seed,
+                                       uint64_t offset)
+    : RandomVisitor(shape, seed, offset) {}
+void RandUniformVisitor::visit(DTypeImpl<double>* dtype) {
+  eval(dtype, backend::uniform);
+}
 
 }  // namespace abyss::core
\ No newline at end of file
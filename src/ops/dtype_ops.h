@@ -3,10 +3,11 @@
 
 #include <complex>
 #include <memory>
-#include <random>
 #include <vector>
 
 #include "abyss_export.h"
+#include "autograd/capture.h"
+#include "backend/random.h"
 #include "core/array.h"
 #include "core/dtype.h"
 #include "core/traits.h"
@@ -21,6 +22,7 @@ namespace abyss::core {
 class EmptyVisitor final : public VisitorBase,
                            public Tensor,
                            public UnaryVisitor<DTypeImpl<bool>>,
+                           public UnaryVisitor<DTypeImpl<uint8_t>>,
                            public UnaryVisitor<DTypeImpl<int32_t>>,
                            public UnaryVisitor<DTypeImpl<double>> {
  public:
@@ -28,6 +30,7 @@ class EmptyVisitor final : public VisitorBase,
   ~EmptyVisitor() = default;
 
   void visit(DTypeImpl<bool>*) override;
+  void visit(DTypeImpl<uint8_t>*) override;
   void visit(DTypeImpl<int32_t>*) override;
   void visit(DTypeImpl<double>*) override;
 
@@ -58,6 +61,51 @@ class EmptyVisitor final : public VisitorBase,
   }
 };
 
+/**
+ * @brief wraps a foreign buffer as a tensor of the visited dtype.
+ */
+class FromBlobVisitor final : public VisitorBase,
+                              public Tensor,
+                              public UnaryVisitor<DTypeImpl<bool>>,
+                              public UnaryVisitor<DTypeImpl<uint8_t>>,
+                              public UnaryVisitor<DTypeImpl<int32_t>>,
+                              public UnaryVisitor<DTypeImpl<double>> {
+ public:
+  FromBlobVisitor(void* data, ArrayDesc desc, std::shared_ptr<void> owner);
+
+  void visit(DTypeImpl<bool>*) override;
+  void visit(DTypeImpl<uint8_t>*) override;
+  void visit(DTypeImpl<int32_t>*) override;
+  void visit(DTypeImpl<double>*) override;
+
+ private:
+  void* blob_;
+  ArrayDesc blob_desc_;
+  std::shared_ptr<void> owner_;
+
+  template <typename T>
+  void eval(DTypeImpl<T>* dtype) {
+    // elements up to the furthest one the strides reach
+    size_t span = shape2size(blob_desc_.shape) > 0 ? 1 : 0;
+    for (size_t i = 0; span > 0 && i < blob_desc_.shape.size(); i++) {
+      span += size_t(blob_desc_.shape[i] - 1) * blob_desc_.strides[i];
+    }
+
+    dtype_ = dtype;
+    desc_ = blob_desc_;
+    if (blob_ == nullptr) {
+      data_ = std::make_shared<ArrayImpl<T>>(0);
+    } else {
+      data_ = std::make_shared<ArrayImpl<T>>(static_cast<T*>(blob_), span,
+                                             owner_);
+    }
+    flags_[core::FlagId::kIsContiguous] = is_contiguous(desc_);
+    // without a deleter the memory belongs to the caller
+    flags_[core::FlagId::kOwnsData] = owner_ != nullptr;
+    flags_[core::FlagId::kIsLeaf] = true;
+  }
+};
+
 class FullVisitor final
     : public VisitorBase,
       public Tensor,
@@ -91,7 +139,17 @@ class FullVisitor final
     desc_.offset = 0;
     desc_.shape = shape_;
     desc_.strides = shape2strides(shape_);
-    data_ = std::make_shared<ArrayImpl<T2>>(output_size, value->at(0));
+    auto arr = std::make_shared<ArrayImpl<T2>>(output_size);
+
+    ArrayImpl<T2>* out = arr.get();
+    autograd::run_kernel(
+        "full",
+        [=]() {
+          std::fill_n(out->data(), output_size, static_cast<T2>(value->at(0)));
+        },
+        {value}, {out});
+
+    data_ = arr;
     flags_[core::FlagId::kIsContiguous] = true;
     flags_[core::FlagId::kOwnsData] = true;
     flags_[core::FlagId::kIsLeaf] = true;
@@ -132,18 +190,22 @@ class FullVisitor final
 //     data_ = std::make_shared<ArrayImpl<TgtTp>>(out);
 //   }
 // };
-class RandNormalVisitor : public VisitorBase,
-                          public Tensor,
-                          public UnaryVisitor<DTypeImpl<double>> {
+/**
+ * @brief parent class for random factories.
+ *
+ * The samples are produced by a counter-based backend function, so a visitor
+ * only needs the seed and the first counter reserved from a `Generator`.
+ */
+class RandomVisitor : public VisitorBase,
+                      public Tensor,
+                      public UnaryVisitor<DTypeImpl<double>> {
  public:
-  RandNormalVisitor(std::vector<int> shape);
-  void visit(DTypeImpl<double>* dtype) override;
-
- private:
-  std::vector<int> shape_;
+  RandomVisitor(std::vector<int> shape, uint64_t seed, uint64_t offset);
 
-  template <typename TgtTp>
-  void eval(DTypeImpl<TgtTp>* dtype) {
+ protected:
+  template <typename TgtTp,
+            typename Callable = void(uint64_t, uint64_t, size_t, TgtTp*)>
+  void eval(DTypeImpl<TgtTp>* dtype, Callable fn) {
     dtype_ = dtype;
     desc_.offset = 0;
     desc_.shape = shape_;
@@ -152,21 +214,33 @@ class RandNormalVisitor : public VisitorBase,
     size_t output_size = shape2size(shape_);
     auto arr = std::make_shared<ArrayImpl<TgtTp>>(output_size);
 
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    // rng.seed(0); // currently don't know how to set seed by user
-    std::normal_distribution<TgtTp> dist(0, 1);
+    fn(seed_, offset_, output_size, arr->data());
 
-    for (size_t i = 0; i < output_size; i++) {
-      arr->at(i) = dist(rng);
-    }
-    
     data_ = arr;
 
     flags_[core::FlagId::kIsContiguous] = true;
     flags_[core::FlagId::kOwnsData] = true;
     flags_[core::FlagId::kIsLeaf] = true;
   }
+
+ private:
+  std::vector<int> shape_;
+  uint64_t seed_;
+  uint64_t offset_;
+};
+
+class RandNormalVisitor final : public RandomVisitor {
+ public:
+  RandNormalVisitor(std::vector<int> shape, uint64_t seed, uint64_t offset);
+
+  void visit(DTypeImpl<double>* dtype) override;
+};
+
+class RandUniformVisitor final : public RandomVisitor {
+ public:
+  RandUniformVisitor(std::vector<int> shape, uint64_t seed, uint64_t offset);
+
+  void visit(DTypeImpl<double>* dtype) override;
 };
 
 }  // namespace abyss::core
@@ -0,0 +1,143 @@
+#include "loss_ops.h"
+
+namespace abyss::core {
+
+ClassificationLossVisitor::ClassificationLossVisitor(ArrayDesc desc1,
+                                                     ArrayDesc desc2)
+    : desc1_{desc1}, desc2_{desc2} {}
+
+/**
+ * CrossEntropyVisitor implementation
+ */
+CrossEntropyVisitor::CrossEntropyVisitor(ArrayDesc desc1, ArrayDesc desc2)
+    : ClassificationLossVisitor(desc1, desc2) {}
+
+void CrossEntropyVisitor::visit(ArrayImpl<double>* input,
+                                ArrayImpl<int32_t>* target) {
+  check(target);
+
+  auto out = std::make_shared<ArrayImpl<double>>(1);
+
+  ArrayImpl<double>* o = out.get();
+  size_t batch = batch_;
+  size_t classes = classes_;
+  size_t input_offset = desc1_.offset;
+  size_t target_offset = desc2_.offset;
+  autograd::run_kernel(
+      "cross_entropy",
+      [=]() {
+        backend::cross_entropy(input->data() + input_offset,
+                               target->data() + target_offset, batch, classes,
+                               o->data());
+      },
+      {input, target}, {o}, 4.0 * batch * classes);
+
+  dtype_ = stypeof<double>();
+  desc_.shape = {1};
+  desc_.strides = {1};
+  data_ = out;
+}
+
+/**
+ * CrossEntropyBackwardVisitor implementation
+ */
+CrossEntropyBackwardVisitor::CrossEntropyBackwardVisitor(ArrayDesc desc1,
+                                                         ArrayDesc desc2,
+                                                         double scale)
+    : ClassificationLossVisitor(desc1, desc2), scale_{scale} {}
+
+void CrossEntropyBackwardVisitor::visit(ArrayImpl<double>* input,
+                                        ArrayImpl<int32_t>* target) {
+  check(target);
+
+  auto out = std::make_shared<ArrayImpl<double>>(batch_ * classes_);
+
+  ArrayImpl<double>* o = out.get();
+  size_t batch = batch_;
+  size_t classes = classes_;
+  size_t input_offset = desc1_.offset;
+  size_t target_offset = desc2_.offset;
+  // the mean reduction is folded into the scale
+  double scale = scale_ / batch_;
+  autograd::run_kernel(
+      "cross_entropy_backward",
+      [=]() {
+        backend::cross_entropy_backward(input->data() + input_offset,
+                                        target->data() + target_offset, batch,
+                                        classes, scale, o->data());
+      },
+      {input, target}, {o}, 4.0 * batch * classes);
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc1_.shape;
+  desc_.strides = shape2strides(desc_.shape);
+  data_ = out;
+}
+
+/**
+ * NLLLossVisitor implementation
+ */
+NLLLossVisitor::NLLLossVisitor(ArrayDesc desc1, ArrayDesc desc2)
+    : ClassificationLossVisitor(desc1, desc2) {}
+
+void NLLLossVisitor::visit(ArrayImpl<double>* input,
+                           ArrayImpl<int32_t>* target) {
+  check(target);
+
+  auto out = std::make_shared<ArrayImpl<double>>(1);
+
+  ArrayImpl<double>* o = out.get();
+  size_t batch = batch_;
+  size_t classes = classes_;
+  size_t input_offset = desc1_.offset;
+  size_t target_offset = desc2_.offset;
+  autograd::run_kernel(
+      "nll_loss",
+      [=]() {
+        backend::nll_loss(input->data() + input_offset,
+                          target->data() + target_offset, batch, classes,
+                          o->data());
+      },
+      {input, target}, {o}, double(batch));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = {1};
+  desc_.strides = {1};
+  data_ = out;
+}
+
+/**
+ * NLLLossBackwardVisitor implementation
+ */
+NLLLossBackwardVisitor::NLLLossBackwardVisitor(ArrayDesc desc1,
+                                               ArrayDesc desc2, double scale)
+    : ClassificationLossVisitor(desc1, desc2), scale_{scale} {}
+
+// the gradient only depends on the input's shape
+void NLLLossBackwardVisitor::visit(ArrayImpl<double>*,
+                                   ArrayImpl<int32_t>* target) {
+  check(target);
+
+  auto out = std::make_shared<ArrayImpl<double>>(batch_ * classes_);
+
+  ArrayImpl<double>* o = out.get();
+  size_t batch = batch_;
+  size_t classes = classes_;
+  size_t target_offset = desc2_.offset;
+  // the mean reduction is folded into the scale
+  double scale = scale_ / batch_;
+  autograd::run_kernel(
+      "nll_loss_backward",
+      [=]() {
+        backend::nll_loss_backward(target->data() + target_offset, batch,
+                                   classes, scale, o->data());
+      },
+      {target}, {o}, double(batch));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc1_.shape;
+  desc_.strides = shape2strides(desc_.shape);
+  data_ = out;
+}
+
+}  // namespace abyss::core
@@ -0,0 +1,104 @@
+#ifndef ABYSS_CORE_LOSS_OPS_H
+#define ABYSS_CORE_LOSS_OPS_H
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "autograd/capture.h"
+#include "backend/losses.h"
+#include "core/array.h"
+#include "core/utility.h"
+#include "core/visitor.h"
+#include "tensor.h"
+
+namespace abyss::core {
+
+/**
+ * @brief parent class for fused losses over (batch, classes) scores and
+ * integral class ids.
+ *
+ * Both inputs must be contiguous, callers copy strided views first.
+ */
+class ClassificationLossVisitor
+    : public VisitorBase,
+      public Tensor,
+      public BinaryVisitor<ArrayImpl<double>, ArrayImpl<int32_t>> {
+ public:
+  ClassificationLossVisitor(ArrayDesc desc1, ArrayDesc desc2);
+
+ protected:
+  ArrayDesc desc1_;
+  ArrayDesc desc2_;
+  size_t batch_ = 0;
+  size_t classes_ = 0;
+
+  /**
+   * @brief validate the shapes (from the descriptors) and the class ids.
+   */
+  void check(ArrayImpl<int32_t>* target) {
+    if (desc1_.shape.size() != 2 || desc2_.shape.size() != 1 ||
+        desc1_.shape[0] != desc2_.shape[0]) {
+      throw std::runtime_error(
+          "expects input of shape (batch, classes) and target of shape "
+          "(batch)");
+    }
+    if (!is_contiguous(desc1_) || !is_contiguous(desc2_)) {
+      throw std::runtime_error("loss inputs must be contiguous");
+    }
+
+    batch_ = desc1_.shape[0];
+    classes_ = desc1_.shape[1];
+
+    const int32_t* ids = target->data() + desc2_.offset;
+    for (size_t i = 0; i < batch_; i++) {
+      if (ids[i] < 0 || ids[i] >= static_cast<int>(classes_)) {
+        throw std::out_of_range("class id out of range");
+      }
+    }
+  }
+};
+
+class CrossEntropyVisitor final : public ClassificationLossVisitor {
+ public:
+  CrossEntropyVisitor(ArrayDesc desc1, ArrayDesc desc2);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<int32_t>*) override;
+};
+
+/**
+ * @brief gradient w.r.t. the input, scaled by the incoming loss gradient.
+ */
+class CrossEntropyBackwardVisitor final : public ClassificationLossVisitor {
+ public:
+  CrossEntropyBackwardVisitor(ArrayDesc desc1, ArrayDesc desc2, double scale);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<int32_t>*) override;
+
+ private:
+  double scale_;
+};
+
+class NLLLossVisitor final : public ClassificationLossVisitor {
+ public:
+  NLLLossVisitor(ArrayDesc desc1, ArrayDesc desc2);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<int32_t>*) override;
+};
+
+/**
+ * @brief gradient w.r.t. the input, scaled by the incoming loss gradient.
+ */
+class NLLLossBackwardVisitor final : public ClassificationLossVisitor {
+ public:
+  NLLLossBackwardVisitor(ArrayDesc desc1, ArrayDesc desc2, double scale);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<int32_t>*) override;
+
+ private:
+  double scale_;
+};
+
+}  // namespace abyss::core
+
+#endif
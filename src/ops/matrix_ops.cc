@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <exception>
+#include <stdexcept>
 
 
 namespace abyss::core {
@@ -71,4 +72,69 @@ void MatmulVisitor::visit(ArrayImpl<double>* a, ArrayImpl<double>* b) {
   eval(a, b);
 }
 
+/**
+ * LinearVisitor implementation
+ */
+LinearVisitor::LinearVisitor(ArrayDesc desc1, ArrayDesc desc2, Activation act,
+                             ActivationOperands operands)
+    : desc1_{desc1}, desc2_{desc2}, act_{act}, operands_{operands} {}
+
+void LinearVisitor::visit(ArrayImpl<double>* weight, ArrayImpl<double>* input) {
+  if (desc1_.shape.size() != 2 || desc2_.shape.size() != 2 ||
+      desc1_.shape[1] != desc2_.shape[0]) {
+    throw std::runtime_error(
+        "linear expects weight (out, in) and input (in, batch)");
+  }
+  if (!is_contiguous(desc1_) || !is_contiguous(desc2_)) {
+    throw std::runtime_error("linear expects contiguous operands");
+  }
+  const int m = desc1_.shape[0];
+  const int k = desc1_.shape[1];
+  const int n = desc2_.shape[1];
+
+  DataDispatcher<Tensor> bias_dp = operands_.bias;
+  DataDispatcher<Tensor> mask_dp = operands_.mask;
+  ArrayImpl<double>* bias = nullptr;
+  ArrayImpl<uint8_t>* mask = nullptr;
+  size_t bias_offset = 0;
+  size_t mask_offset = 0;
+  if (bias_dp.data() != nullptr) {
+    bias = array_cast<double>(bias_dp);
+    if (bias == nullptr || operands_.bias.size() != size_t(m) ||
+        !is_contiguous(bias_dp.desc())) {
+      throw std::runtime_error("linear: bias must hold one float64 per output");
+    }
+    bias_offset = bias_dp.desc().offset;
+  }
+  if (mask_dp.data() != nullptr) {
+    mask = array_cast<uint8_t>(mask_dp);
+    if (mask == nullptr || operands_.mask.size() != (size_t(m) * n + 7) / 8) {
+      throw std::runtime_error("linear: invalid mask");
+    }
+    mask_offset = mask_dp.desc().offset;
+  }
+
+  std::vector<int> shape{m, n};
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset1 = desc1_.offset;
+  size_t offset2 = desc2_.offset;
+  auto act = to_backend(act_);
+  autograd::run_kernel(
+      "linear",
+      [=]() {
+        backend::linear(weight->data() + offset1, input->data() + offset2,
+                        bias ? bias->data() + bias_offset : nullptr, act, m, k,
+                        n, o->data(),
+                        mask ? mask->data() + mask_offset : nullptr);
+      },
+      {weight, input, bias}, {o, mask}, 2.0 * m * k * n);
+
+  dtype_ = stypeof<double>();
+  desc_.shape = shape;
+  desc_.strides = shape2strides(shape);
+  data_ = out;
+}
+
 }  // namespace abyss::core
@@ -4,12 +4,15 @@
 #include <tuple>
 #include <vector>
 
+#include "act_ops.h"
+#include "autograd/capture.h"
 #include "backend/matmul.h"
 #include "core/array.h"
 #include "core/traits.h"
 #include "core/utility.h"
 #include "core/visitor.h"
 #include "tensor.h"
+#include "util_ops.h"
 
 namespace abyss::core {
 
@@ -54,19 +57,13 @@ class MatmulVisitor final
     bc_desc1.strides = shape2strides(bc_desc1.shape);
     bc_desc2.strides = shape2strides(bc_desc2.shape);
 
-    // broadcast as needed
-    ArrayImpl<T1> a_matched(shape2size(bc_desc1.shape));
-    broadcast_copy(a->begin(), a->end(), desc1_, a_matched.begin(), bc_desc1);
-    ArrayImpl<T2> b_matched(shape2size(bc_desc1.shape));
-    broadcast_copy(b->begin(), b->end(), desc2_, b_matched.begin(), bc_desc2);
+    // broadcast buffers are kept by the kernel so replays do not allocate
+    auto a_matched = std::make_shared<ArrayImpl<T1>>(shape2size(bc_desc1.shape));
+    auto b_matched = std::make_shared<ArrayImpl<T2>>(shape2size(bc_desc2.shape));
 
     size_t output_size = shape2size(desc_.shape);
     auto c = std::make_shared<ArrayImpl<result_t>>(output_size);
 
-    // int n_stacks = std::accumulate(desc_.shape.rbegin() + 2,
-    // desc_.shape.rend(),
-    //                                1, std::multiplies<>());
-
     int n_stacks = 1;
     if (desc_.shape.size() >= 2) {
       n_stacks = std::accumulate(desc_.shape.rbegin() + 2, desc_.shape.rend(),
@@ -83,19 +80,39 @@ class MatmulVisitor final
       cols = *bc_desc2.shape.rbegin();
     }
 
-    auto data_it1 = a_matched.begin(rows * common);
-    auto data_it2 = b_matched.begin(common * cols);
-    auto data_oit = c->begin(rows * cols);
-    for (int i = 0; i < n_stacks; i++) {
-      // actual calculation
-      backend::matmul(&(*data_it1), &(*data_it2), rows, common, cols,
-                      &(*data_oit));
-
-      // advance
-      data_it1++;
-      data_it2++;
-      data_oit++;
-    }
+    ArrayImpl<result_t>* out = c.get();
+    autograd::run_kernel(
+        "matmul",
+        [=, desc1 = desc1_, desc2 = desc2_]() {
+          // transposed operands are packed by the blocked transpose
+          if (desc1.shape == bc_desc1.shape) {
+            materialize(a->data(), desc1, a_matched->data());
+          } else {
+            broadcast_copy(a->begin(), a->end(), desc1, a_matched->begin(),
+                           bc_desc1);
+          }
+          if (desc2.shape == bc_desc2.shape) {
+            materialize(b->data(), desc2, b_matched->data());
+          } else {
+            broadcast_copy(b->begin(), b->end(), desc2, b_matched->begin(),
+                           bc_desc2);
+          }
+
+          auto data_it1 = a_matched->begin(rows * common);
+          auto data_it2 = b_matched->begin(common * cols);
+          auto data_oit = out->begin(rows * cols);
+          for (int i = 0; i < n_stacks; i++) {
+            // actual calculation
+            backend::matmul(&(*data_it1), &(*data_it2), rows, common, cols,
+                            &(*data_oit));
+
+            // advance
+            data_it1++;
+            data_it2++;
+            data_oit++;
+          }
+        },
+        {a, b}, {out}, 2.0 * n_stacks * rows * common * cols);
 
     dtype_ = stypeof<result_t>();
     desc_.strides = shape2strides(desc_.shape);
@@ -163,6 +180,29 @@ class MatmulVisitor final
   }
 };
 
+/**
+ * @brief act(weight * input + bias) of a (m, k) weight and (k, n) input.
+ *
+ * `operands.bias` holds one value per output row, `operands.mask` receives the
+ * ReLU sign bits. Both operands must be contiguous.
+ */
+class LinearVisitor final
+    : public VisitorBase,
+      public Tensor,
+      public BinaryVisitor<ArrayImpl<double>, ArrayImpl<double>> {
+ public:
+  LinearVisitor(ArrayDesc desc1, ArrayDesc desc2, Activation act,
+                ActivationOperands operands);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc1_;
+  ArrayDesc desc2_;
+  Activation act_;
+  ActivationOperands operands_;
+};
+
 }  // namespace abyss::core
 
 #endif
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "abyss_export.h"
+#include "autograd/capture.h"
 #include "backend/reduction.h"
 #include "core/array.h"
 #include "core/traits.h"
@@ -59,23 +60,29 @@ class ConcatVisitor final
     const int gap_a = std::accumulate(shape1_.rbegin(), shape1_.rend() - axis_,
                                       1, std::multiplies<int>());
 
-    // fill a
-    int i = 0;
-    while (i < a->size()) {
-      out->at(i + i / gap_a * gap_b) = a->at(i);
-
-      i++;
-    }
-
-    // fill b
-    i = 0;
-    while (i < b->size()) {
-      out->at(i + (i / gap_b + 1) * gap_a) = b->at(i);
-
-      i++;
-    }
-
-    dtype_ = stypeof<int32_t>();
+    ArrayImpl<OutTp>* o = out.get();
+    autograd::run_kernel(
+        "concat",
+        [=]() {
+          // fill a
+          int i = 0;
+          while (i < a->size()) {
+            o->at(i + i / gap_a * gap_b) = a->at(i);
+
+            i++;
+          }
+
+          // fill b
+          i = 0;
+          while (i < b->size()) {
+            o->at(i + (i / gap_b + 1) * gap_a) = b->at(i);
+
+            i++;
+          }
+        },
+        {a, b}, {o});
+
+    dtype_ = stypeof<OutTp>();
     // output_shape_ = calc_output_shape(shape1_, shape2_, axis_);
     desc_.strides = shape2strides(desc_.shape);
     data_ = out;
@@ -105,36 +112,35 @@ class ReductionVisitor : public VisitorBase,
 
     size_t output_size = shape2size(desc_.shape);
     auto arr = std::make_shared<ArrayImpl<T>>(output_size);
-    arr->zero();
 
     int size = 0;
     int stride = 0;
+    // starting offset of each reduction
+    std::vector<size_t> offsets(output_size, 0);
     if (axis_ == kNoAxis) {
       size = shape2size(in_desc_.shape);
       stride = 1;
-
-      fn(a->data(), stride, size, arr->data());
     } else {
       size = in_desc_.shape[axis_];
       stride = in_desc_.strides[axis_];
       // modify shape so the reduced axis has shape of 1
       // this ensures the coords have the correct dimensions
       in_desc_.shape[axis_] = 1;
-      // calculate
-      for (size_t i = 0; i < output_size; i++) {
-        auto coords = unravel_index(i, in_desc_.shape);
-        size_t offset = in_desc_.offset;
-        // for (size_t j = 0; j < coords.size(); j++) {
-        //   offset += coords[j] * in_desc_.strides[j];
-        // }
-        for (size_t j = 0; j < coords.size(); j++) {
-          offset += coords[j] * in_desc_.strides[j];
-        }
-
-        fn(a->data() + offset, stride, size, arr->data() + i);
-      }
+      offsets = strided_offsets(in_desc_);
     }
 
+    // calculate
+    ArrayImpl<T>* out = arr.get();
+    autograd::run_kernel(
+        "reduction",
+        [=, offsets = std::move(offsets)]() {
+          out->zero();
+          for (size_t i = 0; i < offsets.size(); i++) {
+            fn(a->data() + offsets[i], stride, size, out->data() + i);
+          }
+        },
+        {a}, {out}, double(output_size) * size);
+
     dtype_ = stypeof<T>();
     data_ = arr;
   }
@@ -197,18 +203,17 @@ class AllVisitor final : public VisitorBase,
 
     size_t stride =
         (axis_ == kNoAxis) ? 1 : shape2strides(in_desc_.shape)[axis_];
-    for (size_t i = 0; i < output_size; i++) {
-      // safe boolean conversion (for all arithmetics types)
-      out->at(i) =
-          std::all_of(arr->begin(), arr->end(), [](T a) { return (a != 0); });
-
-      // out->at(i);
-      // auto coords = unravel_index(i, in_desc_.shape);
-      // size_t offset = in_desc_.offset;
-      // for (size_t i = 0; i < in_size; i++) {
-      //   offset +=
-      // }
-    }
+    ArrayImpl<T>* o = out.get();
+    autograd::run_kernel(
+        "all",
+        [=]() {
+          for (size_t i = 0; i < output_size; i++) {
+            // safe boolean conversion (for all arithmetics types)
+            o->at(i) = std::all_of(arr->begin(), arr->end(),
+                                   [](T a) { return (a != 0); });
+          }
+        },
+        {arr}, {o});
 
     dtype_ = stypeof<T>();
     desc_.strides = shape2strides(desc_.shape);
@@ -0,0 +1,224 @@
+#include "norm_ops.h"
+
+#include <stdexcept>
+
+#include "operand.h"
+
+namespace abyss::core {
+
+namespace {
+
+void check_shapes(const ArrayDesc& grad, const ArrayDesc& input) {
+  if (grad.shape != input.shape) {
+    throw std::runtime_error("normalization: gradient does not match input");
+  }
+}
+
+// statistics, normalization and the affine transform, backward is twice that
+double norm_flops(const std::vector<int>& shape) {
+  return 5.0 * shape2size(shape);
+}
+
+size_t trailing_size(const std::vector<int>& shape, int ndim) {
+  if (ndim < 1 || ndim > static_cast<int>(shape.size())) {
+    throw std::runtime_error("layer_norm: invalid normalized shape");
+  }
+  std::vector<int> trailing(shape.end() - ndim, shape.end());
+  return shape2size(trailing);
+}
+
+}  // namespace
+
+/**
+ * BatchNormVisitor implementation
+ */
+BatchNormVisitor::BatchNormVisitor(ArrayDesc desc, NormOperands operands,
+                                   bool training, double momentum, double eps)
+    : desc_in_{desc},
+      operands_{operands},
+      training_{training},
+      momentum_{momentum},
+      eps_{eps} {}
+
+void BatchNormVisitor::visit(ArrayImpl<double>* input) {
+  if (desc_in_.shape.size() < 2) {
+    throw std::runtime_error("batch_norm expects input of shape (N, C, ...)");
+  }
+  const int batch = desc_in_.shape[0];
+  const int channels = desc_in_.shape[1];
+  const size_t spatial = shape2size(desc_in_.shape) / (size_t(batch) * channels);
+
+  Operand<double> weight(operands_.weight, channels, "batch_norm: weight");
+  Operand<double> bias(operands_.bias, channels, "batch_norm: bias");
+  Operand<double> running_mean(operands_.running_mean, channels,
+                               "batch_norm: running_mean");
+  Operand<double> running_var(operands_.running_var, channels,
+                              "batch_norm: running_var");
+  Operand<double> mean(operands_.mean, channels, "batch_norm: mean");
+  Operand<double> invstd(operands_.invstd, channels, "batch_norm: invstd");
+  if (!training_ && (running_mean.array == nullptr || running_var.array == nullptr)) {
+    throw std::runtime_error("batch_norm: evaluation needs running statistics");
+  }
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(desc_in_.shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  bool training = training_;
+  double momentum = momentum_;
+  double eps = eps_;
+  autograd::run_kernel(
+      "batch_norm",
+      [=]() {
+        backend::batch_norm(input->data() + offset, weight.data(), bias.data(),
+                            running_mean.data(), running_var.data(), batch,
+                            channels, spatial, training, momentum, eps,
+                            mean.data(), invstd.data(), o->data());
+      },
+      {input, weight.array, bias.array, running_mean.array, running_var.array},
+      {o, mean.array, invstd.array, running_mean.array, running_var.array},
+      norm_flops(desc_in_.shape));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc_in_.shape;
+  desc_.strides = shape2strides(desc_in_.shape);
+  data_ = out;
+}
+
+/**
+ * BatchNormBackwardVisitor implementation
+ */
+BatchNormBackwardVisitor::BatchNormBackwardVisitor(ArrayDesc desc1,
+                                                   ArrayDesc desc2,
+                                                   NormOperands operands,
+                                                   bool training)
+    : desc1_{desc1}, desc2_{desc2}, operands_{operands}, training_{training} {}
+
+void BatchNormBackwardVisitor::visit(ArrayImpl<double>* output_grad,
+                                     ArrayImpl<double>* input) {
+  check_shapes(desc1_, desc2_);
+  const int batch = desc2_.shape[0];
+  const int channels = desc2_.shape[1];
+  const size_t spatial = shape2size(desc2_.shape) / (size_t(batch) * channels);
+
+  Operand<double> weight(operands_.weight, channels, "batch_norm: weight");
+  Operand<double> mean(operands_.mean, channels, "batch_norm: mean");
+  Operand<double> invstd(operands_.invstd, channels, "batch_norm: invstd");
+  Operand<double> grad_weight(operands_.grad_weight, channels,
+                              "batch_norm: grad_weight");
+  Operand<double> grad_bias(operands_.grad_bias, channels,
+                            "batch_norm: grad_bias");
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(desc2_.shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset1 = desc1_.offset;
+  size_t offset2 = desc2_.offset;
+  bool training = training_;
+  autograd::run_kernel(
+      "batch_norm_backward",
+      [=]() {
+        backend::batch_norm_backward(
+            output_grad->data() + offset1, input->data() + offset2,
+            weight.data(), mean.data(), invstd.data(), batch, channels,
+            spatial, training, o->data(), grad_weight.data(), grad_bias.data());
+      },
+      {output_grad, input, weight.array, mean.array, invstd.array},
+      {o, grad_weight.array, grad_bias.array},
+      2 * norm_flops(desc2_.shape));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc2_.shape;
+  desc_.strides = shape2strides(desc2_.shape);
+  data_ = out;
+}
+
+/**
+ * LayerNormVisitor implementation
+ */
+LayerNormVisitor::LayerNormVisitor(ArrayDesc desc, int normalized_ndim,
+                                   NormOperands operands, double eps)
+    : desc_in_{desc},
+      normalized_ndim_{normalized_ndim},
+      operands_{operands},
+      eps_{eps} {}
+
+void LayerNormVisitor::visit(ArrayImpl<double>* input) {
+  const size_t cols = trailing_size(desc_in_.shape, normalized_ndim_);
+  const size_t rows = shape2size(desc_in_.shape) / cols;
+
+  Operand<double> weight(operands_.weight, cols, "layer_norm: weight");
+  Operand<double> bias(operands_.bias, cols, "layer_norm: bias");
+  Operand<double> mean(operands_.mean, rows, "layer_norm: mean");
+  Operand<double> invstd(operands_.invstd, rows, "layer_norm: invstd");
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(desc_in_.shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  double eps = eps_;
+  autograd::run_kernel(
+      "layer_norm",
+      [=]() {
+        backend::layer_norm(input->data() + offset, weight.data(), bias.data(),
+                            rows, cols, eps, mean.data(), invstd.data(),
+                            o->data());
+      },
+      {input, weight.array, bias.array}, {o, mean.array, invstd.array},
+      norm_flops(desc_in_.shape));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc_in_.shape;
+  desc_.strides = shape2strides(desc_in_.shape);
+  data_ = out;
+}
+
+/**
+ * LayerNormBackwardVisitor implementation
+ */
+LayerNormBackwardVisitor::LayerNormBackwardVisitor(ArrayDesc desc1,
+                                                   ArrayDesc desc2,
+                                                   int normalized_ndim,
+                                                   NormOperands operands)
+    : desc1_{desc1},
+      desc2_{desc2},
+      normalized_ndim_{normalized_ndim},
+      operands_{operands} {}
+
+void LayerNormBackwardVisitor::visit(ArrayImpl<double>* output_grad,
+                                     ArrayImpl<double>* input) {
+  check_shapes(desc1_, desc2_);
+  const size_t cols = trailing_size(desc2_.shape, normalized_ndim_);
+  const size_t rows = shape2size(desc2_.shape) / cols;
+
+  Operand<double> weight(operands_.weight, cols, "layer_norm: weight");
+  Operand<double> mean(operands_.mean, rows, "layer_norm: mean");
+  Operand<double> invstd(operands_.invstd, rows, "layer_norm: invstd");
+  Operand<double> grad_weight(operands_.grad_weight, cols,
+                              "layer_norm: grad_weight");
+  Operand<double> grad_bias(operands_.grad_bias, cols, "layer_norm: grad_bias");
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(desc2_.shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset1 = desc1_.offset;
+  size_t offset2 = desc2_.offset;
+  autograd::run_kernel(
+      "layer_norm_backward",
+      [=]() {
+        backend::layer_norm_backward(
+            output_grad->data() + offset1, input->data() + offset2,
+            weight.data(), mean.data(), invstd.data(), rows, cols, o->data(),
+            grad_weight.data(), grad_bias.data());
+      },
+      {output_grad, input, weight.array, mean.array, invstd.array},
+      {o, grad_weight.array, grad_bias.array},
+      2 * norm_flops(desc2_.shape));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = desc2_.shape;
+  desc_.strides = shape2strides(desc2_.shape);
+  data_ = out;
+}
+
+}  // namespace abyss::core
@@ -0,0 +1,121 @@
+#ifndef ABYSS_CORE_NORM_OPS_H
+#define ABYSS_CORE_NORM_OPS_H
+
+#include <memory>
+#include <vector>
+
+#include "autograd/capture.h"
+#include "backend/normalization.h"
+#include "core/array.h"
+#include "core/dispatcher.h"
+#include "core/utility.h"
+#include "core/visitor.h"
+#include "tensor.h"
+
+namespace abyss::core {
+
+/**
+ * @brief side operands of the normalization kernels.
+ *
+ * All are contiguous float64 tensors of one value per normalized group (or
+ * per normalized element for the affine parameters of layer norm). Empty
+ * tensors are skipped by the kernels.
+ */
+struct NormOperands {
+  Tensor weight;
+  Tensor bias;
+  Tensor running_mean;
+  Tensor running_var;
+  // statistics computed by the forward and reused by the backward
+  Tensor mean;
+  Tensor invstd;
+  // outputs of the backward
+  Tensor grad_weight;
+  Tensor grad_bias;
+};
+
+/**
+ * @brief batch normalization over axis 1 of (N, C, ...) input.
+ */
+class BatchNormVisitor final : public VisitorBase,
+                               public Tensor,
+                               public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  BatchNormVisitor(ArrayDesc desc, NormOperands operands, bool training,
+                   double momentum, double eps);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  NormOperands operands_;
+  bool training_;
+  double momentum_;
+  double eps_;
+};
+
+/**
+ * @brief gradient of batch normalization, visits (output_grad, input).
+ *
+ * The result is the input gradient, the parameter gradients are written to
+ * `grad_weight` and `grad_bias` when given.
+ */
+class BatchNormBackwardVisitor final
+    : public VisitorBase,
+      public Tensor,
+      public BinaryVisitor<ArrayImpl<double>, ArrayImpl<double>> {
+ public:
+  BatchNormBackwardVisitor(ArrayDesc desc1, ArrayDesc desc2,
+                           NormOperands operands, bool training);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc1_;
+  ArrayDesc desc2_;
+  NormOperands operands_;
+  bool training_;
+};
+
+/**
+ * @brief layer normalization over the last `normalized_ndim` axes.
+ */
+class LayerNormVisitor final : public VisitorBase,
+                               public Tensor,
+                               public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  LayerNormVisitor(ArrayDesc desc, int normalized_ndim, NormOperands operands,
+                   double eps);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  int normalized_ndim_;
+  NormOperands operands_;
+  double eps_;
+};
+
+/**
+ * @brief gradient of layer normalization, visits (output_grad, input).
+ */
+class LayerNormBackwardVisitor final
+    : public VisitorBase,
+      public Tensor,
+      public BinaryVisitor<ArrayImpl<double>, ArrayImpl<double>> {
+ public:
+  LayerNormBackwardVisitor(ArrayDesc desc1, ArrayDesc desc2,
+                           int normalized_ndim, NormOperands operands);
+
+  void visit(ArrayImpl<double>*, ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc1_;
+  ArrayDesc desc2_;
+  int normalized_ndim_;
+  NormOperands operands_;
+};
+
+}  // namespace abyss::core
+
+#endif
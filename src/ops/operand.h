@@ -0,0 +1,48 @@
+#ifndef ABYSS_OPS_OPERAND_H
+#define ABYSS_OPS_OPERAND_H
+
+#include <stdexcept>
+#include <string>
+
+#include "core/array.h"
+#include "core/dispatcher.h"
+#include "core/utility.h"
+#include "tensor.h"
+
+namespace abyss::core {
+
+/**
+ * @brief raw view of an optional contiguous side operand (weights, running
+ * statistics, masks, ...) handed to a kernel next to the visited array.
+ *
+ * An undefined tensor gives a null view. Anything else has to be a contiguous
+ * `T` tensor of `expected_size` elements, otherwise the error names the
+ * operand through `what`, e.g. "activation: bias".
+ */
+template <typename T>
+struct Operand {
+  ArrayImpl<T>* array = nullptr;
+  size_t offset = 0;
+
+  Operand() = default;
+  Operand(const Tensor& tensor, size_t expected_size, const std::string& what) {
+    DataDispatcher<Tensor> dp = tensor;
+    if (dp.data() == nullptr) return;
+
+    array = array_cast<T>(dp);
+    if (array == nullptr || tensor.size() != expected_size ||
+        !is_contiguous(dp.desc())) {
+      throw std::runtime_error(what + " must be a contiguous tensor of " +
+                               std::to_string(expected_size) +
+                               " elements of the kernel's dtype");
+    }
+    offset = dp.desc().offset;
+  }
+
+  // fetched when the kernel runs, the buffer may be rebound after capture
+  T* data() const { return array ? array->data() + offset : nullptr; }
+};
+
+}  // namespace abyss::core
+
+#endif
@@ -0,0 +1,185 @@
+#include "pool_ops.h"
+
+#include <stdexcept>
+
+namespace abyss::core {
+
+backend::Pool2dGeometry pool2d_geometry(const std::vector<int>& input_shape,
+                                        const Pool2dParams& params) {
+  if (input_shape.size() != 4) {
+    throw std::runtime_error("pooling expects input of shape (N, C, H, W)");
+  }
+  for (int i = 0; i < 2; i++) {
+    if (params.kernel[i] < 1 || params.stride[i] < 1 ||
+        params.padding[i] < 0 || params.padding[i] > params.kernel[i] / 2) {
+      throw std::runtime_error(
+          "pooling: padding must be at most half of the kernel size");
+    }
+  }
+
+  backend::Pool2dGeometry g;
+  g.batch = input_shape[0];
+  g.channels = input_shape[1];
+  g.height = input_shape[2];
+  g.width = input_shape[3];
+  g.kernel_h = params.kernel[0];
+  g.kernel_w = params.kernel[1];
+  g.stride_h = params.stride[0];
+  g.stride_w = params.stride[1];
+  g.pad_h = params.padding[0];
+  g.pad_w = params.padding[1];
+  g.out_height = (g.height + 2 * g.pad_h - g.kernel_h) / g.stride_h + 1;
+  g.out_width = (g.width + 2 * g.pad_w - g.kernel_w) / g.stride_w + 1;
+  if (g.out_height < 1 || g.out_width < 1) {
+    throw std::runtime_error("pooling: kernel is larger than the padded input");
+  }
+
+  return g;
+}
+
+namespace {
+std::vector<int> output_shape(const backend::Pool2dGeometry& g) {
+  return {g.batch, g.channels, g.out_height, g.out_width};
+}
+
+void check_output_grad(const ArrayDesc& desc, const backend::Pool2dGeometry& g) {
+  if (desc.shape != output_shape(g)) {
+    throw std::runtime_error("pooling: gradient does not match output shape");
+  }
+}
+
+// one operation per window element
+double pool2d_flops(const backend::Pool2dGeometry& g) {
+  return double(g.batch) * g.channels * g.out_height * g.out_width *
+         g.kernel_h * g.kernel_w;
+}
+}  // namespace
+
+/**
+ * MaxPool2dVisitor implementation
+ */
+MaxPool2dVisitor::MaxPool2dVisitor(ArrayDesc desc, Pool2dParams params,
+                                   Tensor indices)
+    : desc_in_{desc}, params_{params}, indices_{indices} {}
+
+void MaxPool2dVisitor::visit(ArrayImpl<double>* input) {
+  auto g = pool2d_geometry(desc_in_.shape, params_);
+  auto shape = output_shape(g);
+
+  auto* indices = array_cast<int32_t>(indices_);
+  if (indices == nullptr || indices_.desc().shape != shape) {
+    throw std::runtime_error("max pooling expects int32 indices of the output shape");
+  }
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  size_t indices_offset = indices_.desc().offset;
+  autograd::run_kernel(
+      "max_pool2d",
+      [=]() {
+        backend::max_pool2d(input->data() + offset, g, o->data(),
+                            indices->data() + indices_offset);
+      },
+      {input}, {o, indices}, pool2d_flops(g));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = shape;
+  desc_.strides = shape2strides(shape);
+  data_ = out;
+}
+
+/**
+ * MaxPool2dBackwardVisitor implementation
+ */
+MaxPool2dBackwardVisitor::MaxPool2dBackwardVisitor(ArrayDesc desc,
+                                                   std::vector<int> input_shape,
+                                                   Pool2dParams params,
+                                                   Tensor indices)
+    : desc_in_{desc},
+      input_shape_{input_shape},
+      params_{params},
+      indices_{indices} {}
+
+void MaxPool2dBackwardVisitor::visit(ArrayImpl<double>* output_grad) {
+  auto g = pool2d_geometry(input_shape_, params_);
+  check_output_grad(desc_in_, g);
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(input_shape_));
+
+  ArrayImpl<double>* o = out.get();
+  ArrayImpl<int32_t>* indices = array_cast<int32_t>(indices_);
+  size_t offset = desc_in_.offset;
+  size_t indices_offset = indices_.desc().offset;
+  autograd::run_kernel(
+      "max_pool2d_backward",
+      [=]() {
+        backend::max_pool2d_backward(output_grad->data() + offset,
+                                     indices->data() + indices_offset, g,
+                                     o->data());
+      },
+      {output_grad, indices}, {o}, shape2size(desc_in_.shape));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = input_shape_;
+  desc_.strides = shape2strides(input_shape_);
+  data_ = out;
+}
+
+/**
+ * AvgPool2dVisitor implementation
+ */
+AvgPool2dVisitor::AvgPool2dVisitor(ArrayDesc desc, Pool2dParams params)
+    : desc_in_{desc}, params_{params} {}
+
+void AvgPool2dVisitor::visit(ArrayImpl<double>* input) {
+  auto g = pool2d_geometry(desc_in_.shape, params_);
+  auto shape = output_shape(g);
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(shape));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  autograd::run_kernel(
+      "avg_pool2d",
+      [=]() { backend::avg_pool2d(input->data() + offset, g, o->data()); },
+      {input}, {o}, pool2d_flops(g));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = shape;
+  desc_.strides = shape2strides(shape);
+  data_ = out;
+}
+
+/**
+ * AvgPool2dBackwardVisitor implementation
+ */
+AvgPool2dBackwardVisitor::AvgPool2dBackwardVisitor(ArrayDesc desc,
+                                                   std::vector<int> input_shape,
+                                                   Pool2dParams params)
+    : desc_in_{desc}, input_shape_{input_shape}, params_{params} {}
+
+void AvgPool2dBackwardVisitor::visit(ArrayImpl<double>* output_grad) {
+  auto g = pool2d_geometry(input_shape_, params_);
+  check_output_grad(desc_in_, g);
+
+  auto out = std::make_shared<ArrayImpl<double>>(shape2size(input_shape_));
+
+  ArrayImpl<double>* o = out.get();
+  size_t offset = desc_in_.offset;
+  autograd::run_kernel(
+      "avg_pool2d_backward",
+      [=]() {
+        backend::avg_pool2d_backward(output_grad->data() + offset, g,
+                                     o->data());
+      },
+      {output_grad}, {o}, pool2d_flops(g));
+
+  dtype_ = stypeof<double>();
+  desc_.shape = input_shape_;
+  desc_.strides = shape2strides(input_shape_);
+  data_ = out;
+}
+
+}  // namespace abyss::core
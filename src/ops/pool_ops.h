@@ -0,0 +1,104 @@
+#ifndef ABYSS_CORE_POOL_OPS_H
+#define ABYSS_CORE_POOL_OPS_H
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "autograd/capture.h"
+#include "backend/pooling.h"
+#include "core/array.h"
+#include "core/dispatcher.h"
+#include "core/utility.h"
+#include "core/visitor.h"
+#include "tensor.h"
+
+namespace abyss::core {
+
+/**
+ * @brief hyper-parameters of a 2d pooling, as (height, width) pairs.
+ */
+struct Pool2dParams {
+  std::array<int, 2> kernel = {1, 1};
+  std::array<int, 2> stride = {1, 1};
+  std::array<int, 2> padding = {0, 0};
+};
+
+/**
+ * @brief resolve and validate the geometry of a NCHW pooling.
+ */
+backend::Pool2dGeometry pool2d_geometry(const std::vector<int>& input_shape,
+                                        const Pool2dParams& params);
+
+/**
+ * @brief max pooling, the winning positions are written to `indices`.
+ *
+ * `indices` is a preallocated int32 tensor of the output shape.
+ */
+class MaxPool2dVisitor final : public VisitorBase,
+                               public Tensor,
+                               public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  MaxPool2dVisitor(ArrayDesc desc, Pool2dParams params, Tensor indices);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  Pool2dParams params_;
+  DataDispatcher<Tensor> indices_;
+};
+
+/**
+ * @brief gradient of max pooling, visits output_grad.
+ */
+class MaxPool2dBackwardVisitor final : public VisitorBase,
+                                       public Tensor,
+                                       public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  MaxPool2dBackwardVisitor(ArrayDesc desc, std::vector<int> input_shape,
+                           Pool2dParams params, Tensor indices);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  std::vector<int> input_shape_;
+  Pool2dParams params_;
+  DataDispatcher<Tensor> indices_;
+};
+
+class AvgPool2dVisitor final : public VisitorBase,
+                               public Tensor,
+                               public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  AvgPool2dVisitor(ArrayDesc desc, Pool2dParams params);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  Pool2dParams params_;
+};
+
+/**
+ * @brief gradient of average pooling, visits output_grad.
+ */
+class AvgPool2dBackwardVisitor final : public VisitorBase,
+                                       public Tensor,
+                                       public UnaryVisitor<ArrayImpl<double>> {
+ public:
+  AvgPool2dBackwardVisitor(ArrayDesc desc, std::vector<int> input_shape,
+                           Pool2dParams params);
+
+  void visit(ArrayImpl<double>*) override;
+
+ private:
+  ArrayDesc desc_in_;
+  std::vector<int> input_shape_;
+  Pool2dParams params_;
+};
+
+}  // namespace abyss::core
+
+#endif
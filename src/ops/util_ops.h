@@ -9,6 +9,8 @@
 #include <type_traits>
 #include <vector>
 
+#include "autograd/capture.h"
+#include "backend/transpose.h"
 #include "core/array.h"
 #include "core/utility.h"
 #include "core/dtype.h"
@@ -18,6 +20,50 @@
 
 namespace abyss::core {
 
+// smallest transposed plane worth a call into the blocked kernel
+constexpr size_t kMinTransposePlane = 256;
+
+/**
+ * @brief copy a strided array into dense row-major memory.
+ *
+ * Permuted layouts, where an axis other than the last one has unit stride,
+ * are moved as a batch of 2-d transposes by the cache-blocked backend kernel
+ * instead of element by element.
+ */
+template <typename T>
+void materialize(const T* in, const ArrayDesc& desc, T* out) {
+  const DimVector& shape = desc.shape;
+  if (is_contiguous(desc)) {
+    std::copy_n(in + desc.offset, shape2size(shape), out);
+    return;
+  }
+
+  // the fastest axis of the output (the last one that is not 1) and of the
+  // input
+  int last = shape.size() - 1;
+  while (last >= 0 && shape[last] == 1) last--;
+  int unit = last - 1;
+  while (unit >= 0 && !(shape[unit] > 1 && desc.strides[unit] == 1)) unit--;
+
+  if (unit >= 0 && size_t(shape[unit]) * shape[last] >= kMinTransposePlane) {
+    DimVector out_strides = shape2strides(shape);
+    DimVector batch = shape;
+    batch[unit] = 1;
+    batch[last] = 1;
+    for_each_offset<2>(
+        batch, {&desc.strides, &out_strides}, {desc.offset, 0},
+        [&](const std::array<size_t, 2>& o) {
+          backend::transpose(in + o[0], desc.strides[last], shape[last],
+                             shape[unit], out + o[1], out_strides[unit]);
+        });
+    return;
+  }
+
+  T* it = out;
+  for_each_offset<1>(shape, {&desc.strides}, {desc.offset},
+                     [&](const std::array<size_t, 1>& o) { *it++ = in[o[0]]; });
+}
+
 /**
  * @brief Copy one Array to the other, it does not change the type.
  */
@@ -38,18 +84,12 @@ class CopyVisitor final : public VisitorBase,
   void eval(ArrayImpl<T>* from) {
     auto arr = std::make_shared<ArrayImpl<T>>(shape2size(in_desc_.shape));
 
-    for (size_t o = 0; o < arr->size(); o++) {
-      // calculate the input offset (for non-contiguous Tensors)
-      auto i_indices = unravel_index(o, in_desc_.shape);
-      size_t offset = in_desc_.offset;
-      for (size_t j = 0; j < i_indices.size(); j++) {
-        offset += in_desc_.strides[j] * i_indices[j];
-      }
+    ArrayImpl<T>* to = arr.get();
+    autograd::run_kernel(
+        "copy",
+        [=, desc = in_desc_]() { materialize(from->data(), desc, to->data()); },
+        {from}, {to});
 
-      // copy the data
-      arr->at(o) = from->at(offset);
-    }
-    
     dtype_ = stypeof<T>();
     desc_.offset = 0;
     desc_.shape = in_desc_.shape;
@@ -80,7 +120,21 @@ class AssignToViewVisitor
     if (!is_broadcastable(desc1_.shape, desc2_.shape)) {
       throw std::domain_error("assignment to view must be broadcastable");
     }
-    broadcast_copy(from->begin(), from->end(), desc1_, to->begin(), desc2_);
+    autograd::run_kernel(
+        "assign",
+        [=, from_desc = desc1_, to_desc = desc2_]() {
+          if constexpr (std::is_same<T1, T2>::value) {
+            // plain copies into dense memory, e.g. reshaping a transpose
+            if (from_desc.shape == to_desc.shape && is_contiguous(to_desc)) {
+              materialize(from->data(), from_desc,
+                          to->data() + to_desc.offset);
+              return;
+            }
+          }
+          broadcast_copy(from->begin(), from->end(), from_desc, to->begin(),
+                         to_desc);
+        },
+        {from}, {to});
   }
 };
 
@@ -13,6 +13,7 @@
 #include <vector>
 
 // #include "abyss_export.h"
+#include "autograd/capture.h"
 #include "backend/amath.h"
 #include "backend/arithmetics.h"
 #include "backend/comparison.h"
@@ -91,36 +92,29 @@ class BinaryVectorVisitor
     // generate indices for the backend
     size_t output_size = shape2size(desc_.shape);
 
-    // bundle the properties together so we can iterate over them
-    std::array<size_t, 2> offsets = {desc1_.offset, desc2_.offset};
-    std::array<std::vector<int>, 2> shapes = {desc1_.shape, desc2_.shape};
-    std::array<std::vector<int>, 2> strides = {desc1_.strides, desc2_.strides};
-
-    std::vector<std::vector<size_t>> ids = {
-        std::vector<size_t>(output_size, 0),
-        std::vector<size_t>(output_size, 0)};
-    // std::vector<std::vector<int>> coords = {std::vector<int>(max_dim, 0),
-    // std::vector<int>(max_dim, 0)};
-    std::vector<int> coords(desc_.shape.size(), 0);
-
-    for (size_t i = 0; i < output_size; i++) {
-      // loop through lhs and rhs
-      coords = unravel_index(i, desc_.shape);
-      for (size_t xpr = 0; xpr < 2; xpr++) {
-        size_t offset = offsets[xpr];
-        for (size_t j = 0; j < coords.size(); j++) {
-          offset += coords[j] * strides[xpr][j];
-        }
-
-        ids[xpr][i] = offset;  // store offset
-      }
-    }
+    // walk the output shape with the (broadcast) strides of both inputs
+    std::vector<std::vector<size_t>> ids = {std::vector<size_t>(output_size),
+                                            std::vector<size_t>(output_size)};
+    size_t i = 0;
+    for_each_offset<2>(desc_.shape, {&desc1_.strides, &desc2_.strides},
+                       {desc1_.offset, desc2_.offset},
+                       [&](const std::array<size_t, 2>& offsets) {
+                         ids[0][i] = offsets[0];
+                         ids[1][i] = offsets[1];
+                         i++;
+                       });
 
     // 3. call the backend function and get the result
     auto out = std::make_shared<ArrayImpl<OutTp>>(output_size);
+    ArrayImpl<OutTp>* o = out.get();
 
-    fn(a->data(), ids[0].data(), b->data(), ids[1].data(), output_size,
-       out->data());
+    autograd::run_kernel(
+        "broadcast_eval",
+        [=, ids1 = std::move(ids[0]), ids2 = std::move(ids[1])]() {
+          fn(a->data(), ids1.data(), b->data(), ids2.data(), output_size,
+             o->data());
+        },
+        {a, b}, {o}, output_size);
 
     dtype_ = stypeof<OutTp>();
     data_ = out;
@@ -190,22 +184,21 @@ class UnaryVectorVisitor : public VisitorBase,
     size_t output_size = shape2size(in_desc_.shape);
     auto out = std::make_shared<ArrayImpl<T>>(output_size);
 
-    std::vector<int> coords(in_desc_.shape.size(), 0);
-    std::vector<size_t> ids(output_size, 0);
-    for (size_t i = 0; i < output_size; i++) {
-      coords = unravel_index(i, in_desc_.shape);
-      size_t offset = in_desc_.offset;
-      for (size_t j = 0; j < coords.size(); j++) {
-        offset += coords[j] * in_desc_.strides[j];
-      }
-
-      ids[i] = offset;
-    }
+    std::vector<size_t> ids = strided_offsets(in_desc_);
 
-    fn(arr->data(), ids.data(), output_size, out->data());
+    ArrayImpl<T>* o = out.get();
+    autograd::run_kernel(
+        "unary_eval",
+        [=, ids = std::move(ids)]() {
+          fn(arr->data(), ids.data(), output_size, o->data());
+        },
+        {arr}, {o}, output_size);
 
+    // the output is dense, the view's offset and strides do not carry over
     dtype_ = stypeof<T>();
-    desc_ = in_desc_;
+    desc_.shape = in_desc_.shape;
+    desc_.strides = shape2strides(in_desc_.shape);
+    desc_.offset = 0;
     data_ = out;
   }
 };
@@ -1,25 +1,108 @@
 #include "optimizers.h"
 
+#include <mutex>
+
+#include "autograd/grad_mode.h"
 #include "functional.h"
 #include "operators.h"
+#include "utils/worker.h"
 
 namespace abyss::optim {
 
+/**
+ * @brief state shared with the gradient hooks, which may outlive the
+ * optimizer.
+ */
+struct Optimizer::Overlap {
+  Optimizer* optimizer;
+  bool enabled = false;
+  // set once a parameter got its update of the current step
+  std::vector<bool> updated;
+  std::mutex mutex;
+  utils::BackgroundWorker worker;
+
+  explicit Overlap(Optimizer* opt)
+      : optimizer{opt}, updated(opt->params_.size(), false) {}
+};
+
 Optimizer::Optimizer(std::vector<Tensor>& parameters) : params_{parameters} {}
 
+Optimizer::~Optimizer() {
+  if (overlap_) {
+    overlap_->worker.wait();
+    std::lock_guard<std::mutex> lock(overlap_->mutex);
+    overlap_->optimizer = nullptr;
+  }
+}
+
 void Optimizer::zero_grad() {
+  synchronize();
   for (auto&& p : params_) {
     p.grad() = full(p.shape(), 0, p.dtype());
   }
 }
 
+void Optimizer::step() {
+  synchronize();
+  // the updates themselves must not be recorded in the graph
+  autograd::NoGradGuard no_grad;
+  for (size_t i = 0; i < params_.size(); i++) {
+    if (overlap_ && overlap_->updated[i]) continue;
+    update(params_[i]);
+  }
+  if (overlap_) {
+    overlap_->updated.assign(params_.size(), false);
+  }
+}
+
+void Optimizer::overlap_with_backward(bool enabled) {
+  if (!overlap_) {
+    if (!enabled) return;
+
+    overlap_ = std::make_shared<Overlap>(this);
+    std::weak_ptr<Overlap> weak = overlap_;
+    for (size_t i = 0; i < params_.size(); i++) {
+      params_[i].register_hook([weak, i](Tensor&) {
+        auto state = weak.lock();
+        if (!state) return;
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->enabled || state->optimizer == nullptr ||
+            state->updated[i]) {
+          return;
+        }
+        state->updated[i] = true;
+        state->worker.submit([weak, i]() {
+          auto state = weak.lock();
+          if (!state || state->optimizer == nullptr) return;
+
+          autograd::NoGradGuard no_grad;
+          auto& opt = *state->optimizer;
+          opt.update(opt.params_[i]);
+        });
+      });
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(overlap_->mutex);
+  overlap_->enabled = enabled;
+}
+
+void Optimizer::synchronize() {
+  if (overlap_) {
+    overlap_->worker.wait();
+  }
+}
+
 SGD::SGD(std::vector<Tensor>& parameters, double lr)
     : Optimizer{parameters}, learning_rate_{lr} {}
 
-void SGD::step() {
-  /// @todo threading (or CUDA stream)
-  for (auto& p : params_) {
-    p = p - learning_rate_ * p.grad();
-  }
+void SGD::update(Tensor& p) {
+  // update in place so every copy of the parameter (modules, captured
+  // graphs) sees the new values
+  Tensor updated = p - learning_rate_ * p.grad();
+  p.set_flag(core::FlagId::kIsEditable, true);
+  p = updated;
+  p.set_flag(core::FlagId::kIsEditable, false);
 }
 }  // namespace abyss::optim
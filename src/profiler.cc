@@ -0,0 +1,293 @@
+#include "profiler.h"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace abyss::profiler {
+
+namespace detail {
+std::atomic<bool> enabled{false};
+std::atomic<bool> sample_counters{false};
+}  // namespace detail
+
+namespace {
+std::mutex events_mutex;
+std::vector<Event> recorded_events;
+uint64_t origin_ns = 0;
+bool session_active = false;
+
+std::atomic<int> next_thread_id{0};
+thread_local size_t thread_allocated = 0;
+
+std::string strip_namespaces(const std::string& name) {
+  // keep template arguments intact, only the outer scope is dropped
+  auto end = std::min(name.find('<'), name.size());
+  auto pos = name.rfind("::", end);
+  return pos == std::string::npos ? name : name.substr(pos + 2);
+}
+
+std::string json_escape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\') out.push_back('\\');
+    out.push_back(c);
+  }
+  return out;
+}
+
+std::string format_inputs(const std::vector<Input>& inputs) {
+  std::ostringstream os;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (i > 0) os << ", ";
+    os << inputs[i].dtype << "(";
+    for (size_t d = 0; d < inputs[i].shape.size(); d++) {
+      if (d > 0) os << ", ";
+      os << inputs[i].shape[d];
+    }
+    os << ")";
+  }
+  return os.str();
+}
+}  // namespace
+
+/**
+ * runtime hooks
+ */
+
+namespace detail {
+
+uint64_t now_ns() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int thread_id() {
+  thread_local int id = next_thread_id++;
+  return id;
+}
+
+size_t allocated_bytes() { return thread_allocated; }
+
+void count_allocation(size_t nbytes) { thread_allocated += nbytes; }
+
+void record(Event&& event) {
+  std::lock_guard<std::mutex> lock(events_mutex);
+  // scopes still open when the session stopped are dropped
+  if (!session_active) return;
+  event.start_ns -= std::min(event.start_ns, origin_ns);
+  recorded_events.emplace_back(std::move(event));
+}
+
+HardwareCounters& thread_counters() {
+  thread_local HardwareCounters counters;
+  return counters;
+}
+
+const std::string& type_name(const std::type_info& type) {
+  static std::mutex mutex;
+  static std::unordered_map<std::type_index, std::string> names;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = names.find(type);
+  if (it != names.end()) return it->second;
+
+  int status = 0;
+  char* demangled =
+      abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+  std::string name = status == 0 ? demangled : type.name();
+  std::free(demangled);
+
+  return names.emplace(type, strip_namespaces(name)).first->second;
+}
+
+const char* dtype_name(std::type_index dtype) {
+  if (dtype == typeid(bool)) return "bool";
+  if (dtype == typeid(uint8_t)) return "uint8";
+  if (dtype == typeid(int32_t)) return "int32";
+  if (dtype == typeid(double)) return "float64";
+  if (dtype == typeid(void)) return "none";
+  return "complex128";
+}
+
+}  // namespace detail
+
+/**
+ * RecordScope implementations
+ */
+
+void RecordScope::start(const char* category, const char* name,
+                        double flops) {
+  event_ = std::make_unique<Event>();
+  event_->category = category;
+  event_->name = name;
+  event_->flops = flops;
+  event_->thread_id = detail::thread_id();
+  bytes_at_start_ = detail::allocated_bytes();
+  if (detail::sample_counters.load(std::memory_order_relaxed)) {
+    counters_at_start_ = detail::thread_counters().read();
+  }
+  event_->start_ns = detail::now_ns();
+}
+
+void RecordScope::finish() {
+  event_->duration_ns = detail::now_ns() - event_->start_ns;
+  if (counters_at_start_.available != 0) {
+    event_->counters = detail::thread_counters().read() - counters_at_start_;
+  }
+  event_->bytes_allocated = detail::allocated_bytes() - bytes_at_start_;
+  detail::record(std::move(*event_));
+}
+
+void RecordScope::set_name(const std::string& name) {
+  if (event_) event_->name = name;
+}
+
+void RecordScope::set_flops(double flops) {
+  if (event_) event_->flops = flops;
+}
+
+void RecordScope::add_input(const std::vector<int>& shape,
+                            std::type_index dtype) {
+  if (event_) event_->inputs.push_back({shape, detail::dtype_name(dtype)});
+}
+
+/**
+ * Profile implementations
+ */
+
+Profile::Profile(bool hardware_counters) {
+  std::lock_guard<std::mutex> lock(events_mutex);
+  if (session_active) {
+    throw std::runtime_error("profiler: a profile is already running");
+  }
+  session_active = true;
+  detail::sample_counters.store(hardware_counters, std::memory_order_relaxed);
+  recorded_events.clear();
+  origin_ns = detail::now_ns();
+  detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+Profile::~Profile() { stop(); }
+
+void Profile::stop() {
+  if (!running_) return;
+  running_ = false;
+
+  std::lock_guard<std::mutex> lock(events_mutex);
+  detail::enabled.store(false, std::memory_order_relaxed);
+  detail::sample_counters.store(false, std::memory_order_relaxed);
+  session_active = false;
+  events_ = std::move(recorded_events);
+  recorded_events.clear();
+}
+
+const std::vector<Event>& Profile::events() const { return events_; }
+
+void Profile::export_chrome_trace(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("profiler: cannot open " + path);
+  }
+
+  file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  file << std::fixed << std::setprecision(3);
+  for (size_t i = 0; i < events_.size(); i++) {
+    const auto& e = events_[i];
+    file << (i > 0 ? ",\n" : "\n");
+    // trace timestamps are in microseconds
+    file << "{\"name\": \"" << json_escape(e.name) << "\", \"cat\": \""
+         << e.category << "\", \"ph\": \"X\", \"ts\": " << e.start_ns / 1e3
+         << ", \"dur\": " << e.duration_ns / 1e3
+         << ", \"pid\": 0, \"tid\": " << e.thread_id << ", \"args\": {"
+         << "\"inputs\": \"" << json_escape(format_inputs(e.inputs))
+         << "\", \"bytes\": " << e.bytes_allocated
+         << ", \"flops\": " << e.flops;
+    for (int c = 0; c < kNumCounters; c++) {
+      if (!e.counters.has(Counter(c))) continue;
+      file << ", \"" << counter_name(Counter(c))
+           << "\": " << e.counters.values[c];
+    }
+    if (e.counters.ipc() > 0) file << ", \"ipc\": " << e.counters.ipc();
+    file << "}}";
+  }
+  file << "\n]}\n";
+}
+
+std::string Profile::table() const {
+  struct Row {
+    std::string category;
+    std::string name;
+    size_t calls = 0;
+    uint64_t total_ns = 0;
+    size_t bytes = 0;
+    double flops = 0;
+    CounterValues counters;
+  };
+  std::map<std::pair<std::string, std::string>, Row> rows;
+  for (const auto& e : events_) {
+    auto& row = rows[{e.category, e.name}];
+    row.category = e.category;
+    row.name = e.name;
+    row.calls++;
+    row.total_ns += e.duration_ns;
+    row.bytes += e.bytes_allocated;
+    row.flops += e.flops;
+    // a row only has counters if all of its events had them
+    row.counters.available =
+        row.calls == 1 ? e.counters.available
+                       : row.counters.available & e.counters.available;
+    for (int c = 0; c < kNumCounters; c++) {
+      row.counters.values[c] += e.counters.values[c];
+    }
+  }
+
+  std::vector<Row> sorted;
+  for (auto& kv : rows) sorted.emplace_back(std::move(kv.second));
+  std::sort(sorted.begin(), sorted.end(), [](const Row& a, const Row& b) {
+    return a.total_ns > b.total_ns;
+  });
+
+  std::ostringstream os;
+  os << std::left << std::setw(10) << "category" << std::setw(32) << "name"
+     << std::right << std::setw(8) << "calls" << std::setw(14) << "total (us)"
+     << std::setw(12) << "mean (us)" << std::setw(14) << "bytes"
+     << std::setw(12) << "GFLOP/s" << std::setw(8) << "IPC" << "\n";
+  os << std::fixed << std::setprecision(1);
+  for (const auto& row : sorted) {
+    double total_us = row.total_ns / 1e3;
+    os << std::left << std::setw(10) << row.category << std::setw(32)
+       << row.name.substr(0, 31) << std::right << std::setw(8) << row.calls
+       << std::setw(14) << total_us << std::setw(12) << total_us / row.calls
+       << std::setw(14) << row.bytes << std::setw(12);
+    // only kernels carry estimates
+    if (row.flops > 0 && row.total_ns > 0) {
+      os << std::setprecision(3) << row.flops / row.total_ns
+         << std::setprecision(1);
+    } else {
+      os << "-";
+    }
+    // only profiles with hardware counters
+    os << std::setw(8);
+    if (row.counters.ipc() > 0) {
+      os << std::setprecision(2) << row.counters.ipc() << std::setprecision(1);
+    } else {
+      os << "-";
+    }
+    os << "\n";
+  }
+  return os.str();
+}
+
+}  // namespace abyss::profiler
@@ -0,0 +1,31 @@
+#include "random.h"
+
+#include <random>
+
+namespace abyss {
+
+Generator::Generator(uint64_t seed) : seed_{seed} {}
+
+void Generator::manual_seed(uint64_t seed) {
+  seed_ = seed;
+  offset_ = 0;
+}
+
+uint64_t Generator::seed() const { return seed_; }
+uint64_t Generator::offset() const { return offset_; }
+void Generator::set_offset(uint64_t offset) { offset_ = offset; }
+
+uint64_t Generator::advance(uint64_t n) { return offset_.fetch_add(n); }
+
+Generator& default_generator() {
+  static Generator generator([] {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+  }());
+
+  return generator;
+}
+
+void manual_seed(uint64_t seed) { default_generator().manual_seed(seed); }
+
+}  // namespace abyss
@@ -16,6 +16,7 @@
 #include "core/traits.h"
 // #include "ops/dtype_ops.h"
 #include "ops/conversion_ops.h"
+#include "ops/dtype_ops.h"
 #include "ops/merge_ops.h"
 #include "ops/util_ops.h"
 
@@ -27,7 +28,8 @@ Tensor::Tensor(const Tensor& other)
       data_{other.data_},
       flags_{other.flags_},
       grad_{other.grad_},
-      grad_fn_{other.grad_fn_} {
+      grad_fn_{other.grad_fn_},
+      hooks_{other.hooks_} {
   // unset editable flag when copied
   // flags_ = flags_ & ~TensorFlags::kIsEditable;
   flags_[core::FlagId::kIsEditable] = false;
@@ -39,7 +41,8 @@ Tensor::Tensor(Tensor&& other)
       data_{other.data_},
       flags_{other.flags_},
       grad_{other.grad_},
-      grad_fn_{other.grad_fn_} {
+      grad_fn_{other.grad_fn_},
+      hooks_{other.hooks_} {
   // unset editable flag when copied
   // flags_ = flags_ & ~TensorFlags::kIsEditable;
 }
@@ -57,6 +60,60 @@ Tensor& Tensor::operator=(Tensor copy) {
 }
 
 Tensor Tensor::copy() {
+  if (copy_on_write_enabled() && desc_.offset == 0 &&
+      core::is_contiguous(desc_) && data_->size() == size()) {
+    Tensor out;
+    out.dtype_ = dtype_;
+    out.desc_ = {0, desc_.shape, core::shape2strides(desc_.shape)};
+    out.data_ = data_->share();
+    return out;
+  }
+
+  core::CopyVisitor copy_visitor(desc_);
+  data_->accept(&copy_visitor);
+
+  return copy_visitor;
+}
+
+Tensor Tensor::from_blob(void* data, std::vector<int> shape,
+                         std::vector<int> strides, ScalarType dtype,
+                         Deleter deleter) {
+  if (shape.size() != strides.size()) {
+    throw std::runtime_error("from_blob: shape and strides differ in rank");
+  }
+  for (size_t i = 0; i < shape.size(); i++) {
+    if (shape[i] < 0 || strides[i] < 0) {
+      throw std::runtime_error(
+          "from_blob: shape and strides must not be negative");
+    }
+  }
+  if (dtype == kNone) {
+    throw std::runtime_error("from_blob: the dtype must be given");
+  }
+  if (data == nullptr && core::shape2size(shape) > 0) {
+    throw std::runtime_error("from_blob: null data for a non-empty tensor");
+  }
+
+  std::shared_ptr<void> owner;
+  if (deleter) owner = std::shared_ptr<void>(data, std::move(deleter));
+
+  core::FromBlobVisitor from_blob_visitor(data, {0, shape, strides}, owner);
+  core::TypeDispatcher<ScalarType> dtype_dispatch(dtype);
+  dtype_dispatch.accept(&from_blob_visitor);
+
+  return from_blob_visitor;
+}
+
+Tensor Tensor::from_blob(void* data, std::vector<int> shape, ScalarType dtype,
+                         Deleter deleter) {
+  std::vector<int> strides = core::shape2strides(shape);
+  return from_blob(data, std::move(shape), std::move(strides), dtype,
+                   std::move(deleter));
+}
+
+Tensor Tensor::contiguous() const {
+  if (core::is_contiguous(desc_)) return *this;
+
   core::CopyVisitor copy_visitor(desc_);
   data_->accept(&copy_visitor);
 
@@ -78,6 +135,7 @@ Tensor Tensor::all() const {
 }
 
 ScalarType Tensor::dtype() const { return dtype_; }
+uint64_t Tensor::version() const { return data_ ? data_->version() : 0; }
 core::Array* Tensor::data() const { return data_.get(); }
 core::ArrayDesc Tensor::desc() const { return desc_; }
 
@@ -95,8 +153,8 @@ void Tensor::set_flag(core::FlagId name, bool value) {
 }
 
 size_t Tensor::offset() const { return desc_.offset; }
-const std::vector<int>& Tensor::shape() const { return desc_.shape; }
-const std::vector<int>& Tensor::strides() const { return desc_.strides; }
+const core::DimVector& Tensor::shape() const { return desc_.shape; }
+const core::DimVector& Tensor::strides() const { return desc_.strides; }
 size_t Tensor::size() const { return core::shape2size(desc_.shape); }
 size_t Tensor::nbytes() const { return dtype_.itemsize() * size(); }
 size_t Tensor::ndims() const { return desc_.shape.size(); }
@@ -125,10 +183,12 @@ Tensor& Tensor::reshape(std::vector<int> new_shape) {
   view_->desc_.strides = core::shape2strides(new_shape);
 
   // if (!flags(TensorFlags::kIsContiguous)) {
-  if (!flags(core::FlagId::kIsContiguous)) {
-    core::AssignToViewVisitor assign_to_view(desc_, view_->desc_);
-
-    data_->accept(&assign_to_view, view_->data());
+  // strided data is packed into new storage, writing it back into the
+  // storage it is read from would scramble it
+  if (!core::is_contiguous(desc_)) {
+    Tensor packed = contiguous();
+    view_->data_ = packed.data_;
+    view_->desc_.offset = 0;
   }
 
   // return std::move(*view_);
@@ -146,7 +206,7 @@ Tensor& Tensor::broadcast_to(std::vector<int> new_shape) {
   view_->desc_.shape = new_shape;
   view_->desc_.strides = desc_.strides;
 
-  std::vector<int>& new_strides = view_->desc_.strides;
+  core::DimVector& new_strides = view_->desc_.strides;
   // new_strides.clear();
 
   // calculate new strides
@@ -226,6 +286,17 @@ autograd::BackwardFn& Tensor::grad_fn() {
   return *grad_fn_;
 }
 
+Tensor Tensor::detach() const {
+  Tensor out = *this;
+  out.grad_.reset();
+  out.grad_fn_.reset();
+  out.hooks_.reset();
+  out.flags_[core::FlagId::kRequiresGrad] = false;
+  out.flags_[core::FlagId::kIsLeaf] = true;
+
+  return out;
+}
+
 void Tensor::backward(Tensor gradient) {
   if (gradient.shape() != shape()) {
     throw std::runtime_error("gradient shape should not be broadcasted");
@@ -236,6 +307,13 @@ void Tensor::backward(Tensor gradient) {
   autograd::Graph::clear();
 }
 
+void Tensor::register_hook(Hook hook) {
+  if (!hooks_) {
+    hooks_ = std::make_shared<std::vector<Hook>>();
+  }
+  hooks_->emplace_back(std::move(hook));
+}
+
 std::ostream& operator<<(std::ostream& os, Tensor tensor) {
   core::DataDispatcher<Tensor> tsr(tensor);
   core::ArrayPrintVisitor print_visitor(tsr.desc());
@@ -256,6 +334,9 @@ void Tensor::init_view() {
     view_ = std::make_unique<Tensor>(*this);
   }
 
+  // the tensor may have been rebound to other data since the last view
+  view_->dtype_ = dtype_;
+  view_->data_ = data_;
   // clear shapes and strides
   // reset offset back to the offset of the current class
   view_->desc_.offset = desc_.offset;
@@ -271,6 +352,11 @@ void Tensor::init_grad() {
     *grad_ = empty(shape(), dtype());
     grad_->data_->zero();
   }
+  // shared with every copy made from here on, hooks registered later reach
+  // the copies held by modules and the graph
+  if (hooks_ == nullptr) {
+    hooks_ = std::make_shared<std::vector<Hook>>();
+  }
 
   // grad_->flags_[core::FlagId::kIsEditable] = true;
   grad_->flags_[core::FlagId::kOwnsData] = true;
@@ -0,0 +1,127 @@
+#include "utils/batching.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include "autograd/grad_mode.h"
+#include "functional.h"
+
+namespace abyss::utils {
+
+BatchingExecutor::BatchingExecutor(nn::Module& module, int batch_axis,
+                                   size_t max_batch_size,
+                                   std::chrono::microseconds max_delay)
+    : module_{module},
+      axis_{batch_axis},
+      max_batch_size_{std::max<size_t>(max_batch_size, 1)},
+      max_delay_{max_delay} {
+  if (axis_ != 0 && axis_ != 1) {
+    throw std::runtime_error("batching: the batch axis must be 0 or 1");
+  }
+  module_.eval();
+  thread_ = std::thread(&BatchingExecutor::loop, this);
+}
+
+BatchingExecutor::~BatchingExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+std::future<Tensor> BatchingExecutor::submit(Tensor sample) {
+  if (int(sample.ndims()) <= axis_ || sample.shape(axis_) != 1) {
+    throw std::runtime_error("batching: samples need a batch axis of size 1");
+  }
+
+  Request request;
+  request.sample = sample;
+  request.arrival = std::chrono::steady_clock::now();
+  auto future = request.result.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stop_) throw std::runtime_error("batching: executor is shutting down");
+    queue_.emplace_back(std::move(request));
+  }
+  cv_.notify_one();
+
+  return future;
+}
+
+size_t BatchingExecutor::num_batches() const { return num_batches_; }
+
+void BatchingExecutor::loop() {
+  // the thread only runs inference
+  autograd::NoGradGuard no_grad;
+
+  std::vector<Request> batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) return;
+
+    // give the batch time to fill up, unless shutting down
+    auto deadline = queue_.front().arrival + max_delay_;
+    cv_.wait_until(lock, deadline, [this] {
+      return stop_ || queue_.size() >= max_batch_size_;
+    });
+
+    size_t n = std::min(queue_.size(), max_batch_size_);
+    batch.clear();
+    for (size_t i = 0; i < n; i++) {
+      batch.emplace_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+
+    lock.unlock();
+    run(batch);
+    lock.lock();
+  }
+}
+
+void BatchingExecutor::run(std::vector<Request>& batch) {
+  std::vector<Tensor> samples;
+  for (auto& r : batch) samples.push_back(r.sample);
+
+  Tensor output;
+  try {
+    output = module_(concat(samples, axis_));
+    num_batches_++;
+    if (int(output.ndims()) <= axis_ ||
+        output.shape(axis_) != int(batch.size())) {
+      throw std::runtime_error("batching: output does not keep the batch axis");
+    }
+  } catch (...) {
+    if (batch.size() == 1) {
+      batch[0].result.set_exception(std::current_exception());
+      return;
+    }
+    // one malformed sample should not fail the others
+    for (auto& r : batch) {
+      std::vector<Request> single;
+      single.emplace_back(std::move(r));
+      run(single);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < batch.size(); i++) {
+    batch[i].result.set_value(slice(output, i));
+  }
+}
+
+Tensor BatchingExecutor::slice(Tensor& output, int index) {
+  // indexing drops the batch axis and returns a reused view, the result gets
+  // its own storage and the axis back
+  Tensor row = (axis_ == 0 ? output(index) : output(kAll, index)).copy();
+
+  std::vector<int> shape = output.shape();
+  shape[axis_] = 1;
+  Tensor result = row.reshape(shape);
+  return result;
+}
+
+}  // namespace abyss::utils
@@ -3,22 +3,25 @@
 #include <algorithm>
 #include <numeric>
 #include <random>
+#include <stdexcept>
 
 #include "functional.h"
+#include "random.h"
 
 namespace abyss::utils::data {
 
 DataLoader::DataLoader(Dataset& dataset, size_t batch_size, bool shuffle)
     : batch_size_{batch_size},
       shuffle_{shuffle},
-      dataset_{&dataset},
-      ids_(calc_size(dataset_->size(), batch_size_)) {
-  std::iota(ids_.begin(), ids_.end(), 0);
+      dataset_{&dataset} {
+  reset_ids(false);
 }
 
 DataLoader::DataLoader(const DataLoader& other)
     : batch_size_{other.batch_size_},
       shuffle_{other.shuffle_},
+      rank_{other.rank_},
+      world_size_{other.world_size_},
       dataset_{other.dataset_},
       offset_{other.offset_},
       ids_{other.ids_} {}
@@ -36,31 +39,35 @@ DataLoader::pointer DataLoader::operator->() {
   return &output_slice_;
 }
 size_t DataLoader::size() const {
-  return calc_size(dataset_->size(), batch_size_);
+  return calc_size(ids_.size(), batch_size_);
+}
+
+void DataLoader::shard(size_t rank, size_t world_size) {
+  if (world_size == 0 || rank >= world_size) {
+    throw std::runtime_error("invalid shard");
+  }
+  rank_ = rank;
+  world_size_ = world_size;
+  reset_ids(false);
 }
 
 DataLoader DataLoader::begin() {
   // std::vector<int> x(10);
-  if (shuffle_) {
-    /// @todo reproducibility
-    std::random_device rd{};
-    std::mt19937 rng{rd()};
-    std::shuffle(ids_.begin(), ids_.end(), rng);
-    // std::shuffle(x.begin(), x.end(), rng);
-  }
+  reset_ids(shuffle_);
+  offset_ = 0;
 
   return *this;
 }
 
 DataLoader DataLoader::end() {
   DataLoader out = *this;  // copy
-  out.offset_ = size();
+  out.offset_ = ids_.size();
 
   return out;
 }
 
 DataLoader& DataLoader::operator++() {
-  offset_ += batch_size_;
+  offset_ = std::min(offset_ + batch_size_, ids_.size());
   return *this;
 }
 DataLoader& DataLoader::operator++(int discard) { return ++*this; }
@@ -79,7 +86,7 @@ size_t DataLoader::calc_size(size_t dataset_size, size_t batch_size) {
 void DataLoader::update_slice() {
   Dataset& dset = *dataset_;
 
-  size_t real_batch_size = std::min(dset.size() - offset_, batch_size_);
+  size_t real_batch_size = std::min(ids_.size() - offset_, batch_size_);
   std::vector<Tensor> Xs(real_batch_size);
   std::vector<Tensor> ys(real_batch_size);
 
@@ -93,4 +100,34 @@ void DataLoader::update_slice() {
   output_slice_ = std::make_pair(X, y);
 }
 
+void DataLoader::reset_ids(bool shuffle) {
+  std::vector<size_t> ids(dataset_->size());
+  std::iota(ids.begin(), ids.end(), 0);
+
+  if (shuffle) {
+    // draw the shuffle seed from the default generator so `manual_seed`
+    // also makes the batch order reproducible
+    Generator& generator = default_generator();
+    uint64_t seed = generator.seed();
+    uint64_t offset = generator.advance(1);
+    std::seed_seq seq{static_cast<uint32_t>(seed),
+                      static_cast<uint32_t>(seed >> 32),
+                      static_cast<uint32_t>(offset),
+                      static_cast<uint32_t>(offset >> 32)};
+    std::mt19937 rng{seq};
+    std::shuffle(ids.begin(), ids.end(), rng);
+  }
+
+  if (world_size_ == 1 || ids.empty()) {
+    ids_ = std::move(ids);
+    return;
+  }
+
+  size_t per_rank = (ids.size() + world_size_ - 1) / world_size_;
+  ids_.resize(per_rank);
+  for (size_t i = 0; i < per_rank; i++) {
+    ids_[i] = ids[(i * world_size_ + rank_) % ids.size()];
+  }
+}
+
 }  // namespace abyss::utils::data
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "utils/worker.h"
+
+#include <utility>
+
+namespace abyss::utils {
+
+BackgroundWorker::BackgroundWorker() : thread_{&BackgroundWorker::loop, this} {}
+
+BackgroundWorker::~BackgroundWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void BackgroundWorker::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.emplace_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void BackgroundWorker::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return tasks_.empty() && !busy_; });
+
+  if (error_) {
+    auto error = std::exchange(error_, nullptr);
+    std::rethrow_exception(error);
+  }
+}
+
+void BackgroundWorker::loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+    // pending tasks are drained before stopping
+    if (tasks_.empty()) return;
+
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    busy_ = true;
+
+    lock.unlock();
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> error_lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+    }
+    lock.lock();
+
+    busy_ = false;
+    if (tasks_.empty()) idle_cv_.notify_all();
+  }
+}
+
+}  // namespace abyss::utils
@@ -0,0 +1,111 @@
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <vector>
+
+#include "autograd/checkpoint.h"
+#include "autograd/grad_mode.h"
+#include "autograd/graph.h"
+#include "functional.h"
+#include "operators.h"
+#include "random.h"
+
+namespace {
+
+abyss::Tensor make_leaf(abyss::Tensor data) {
+  data.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return data;
+}
+
+}  // namespace
+
+TEST_CASE("no grad guard", "[autograd][grad_mode]") {
+  using namespace abyss;
+
+  auto a = make_leaf(full({2, 2}, 1.0));
+  {
+    autograd::NoGradGuard no_grad;
+    auto b = exp(a);
+
+    REQUIRE_FALSE(autograd::GradMode::is_enabled());
+    REQUIRE_FALSE(b.flags(core::FlagId::kRequiresGrad));
+    REQUIRE(autograd::Graph::instance().edges().empty());
+  }
+  REQUIRE(autograd::GradMode::is_enabled());
+}
+
+TEST_CASE("checkpointed segments match plain backward",
+          "[autograd][checkpoint]") {
+  using namespace abyss;
+
+  auto make_params = [] {
+    return std::vector<Tensor>{make_leaf(full({3, 3}, 0.1)),
+                               make_leaf(full({3, 3}, -0.2))};
+  };
+  auto make_segment = [](Tensor w) {
+    return [w](Tensor h) { return log(add(exp(matmul(w, h)), 1.0)); };
+  };
+
+  // plain
+  auto params = make_params();
+  auto x = make_leaf(full({3, 2}, 0.5));
+  auto h = make_segment(params[1])(make_segment(params[0])(x));
+  auto loss = sum(h);
+  size_t plain_edges = autograd::Graph::instance().edges().size();
+  loss.backward();
+
+  // checkpointed
+  auto ck_params = make_params();
+  auto ck_x = make_leaf(full({3, 2}, 0.5));
+  auto ck_h = autograd::checkpoint(make_segment(ck_params[0]), ck_x);
+  ck_h = autograd::checkpoint(make_segment(ck_params[1]), ck_h);
+  auto ck_loss = sum(ck_h);
+  size_t ck_edges = autograd::Graph::instance().edges().size();
+
+  // two segments and the sum
+  REQUIRE(ck_edges == 3);
+  REQUIRE(ck_edges < plain_edges);
+
+  bool same = (ck_loss == loss).all();
+  REQUIRE(same);
+
+  ck_loss.backward();
+  REQUIRE(autograd::Graph::instance().edges().empty());
+
+  same = (ck_x.grad() == x.grad()).all();
+  REQUIRE(same);
+  for (size_t i = 0; i < params.size(); i++) {
+    same = (ck_params[i].grad() == params[i].grad()).all();
+    REQUIRE(same);
+  }
+
+  SECTION("parameters get gradients when the input does not") {
+    auto w = make_leaf(full({3, 3}, 0.1));
+    auto data = full({3, 2}, 0.5);
+
+    auto out = sum(autograd::checkpoint(make_segment(w), data));
+    REQUIRE(out.flags(core::FlagId::kRequiresGrad));
+
+    out.backward();
+    same = (w.grad() == params[0].grad()).all();
+    REQUIRE_FALSE(same);
+    same = (w.grad() != 0.0).all();
+    REQUIRE(same);
+  }
+  SECTION("a failing recompute leaves the generator where it was") {
+    auto w = make_leaf(full({3, 3}, 0.1));
+    int calls = 0;
+    auto segment = [&](Tensor h) {
+      // the recompute in backward throws
+      if (calls++ > 0) throw std::runtime_error("segment failed");
+      return matmul(w, h);
+    };
+
+    auto out = sum(autograd::checkpoint(segment, full({3, 2}, 0.5)));
+    randn({4});
+    uint64_t offset = default_generator().offset();
+
+    REQUIRE_THROWS(out.backward());
+    REQUIRE(default_generator().offset() == offset);
+    autograd::Graph::clear();
+  }
+}
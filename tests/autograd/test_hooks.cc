@@ -0,0 +1,150 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "autograd/graph.h"
+#include "functional.h"
+#include "operators.h"
+#include "optimizers.h"
+#include "random.h"
+#include "tensor.h"
+#include "utils/worker.h"
+
+namespace {
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kIsLeaf, true);
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+// plain SGD, but written with an op that autograd records
+class TrackedSGD final : public abyss::optim::Optimizer {
+ public:
+  TrackedSGD(std::vector<abyss::Tensor>& parameters, double lr)
+      : Optimizer{parameters}, learning_rate_{lr} {}
+
+ protected:
+  void update(abyss::Tensor& p) override {
+    abyss::Tensor updated = p + -(learning_rate_ * p.grad());
+    p.set_flag(abyss::core::FlagId::kIsEditable, true);
+    p = updated;
+    p.set_flag(abyss::core::FlagId::kIsEditable, false);
+  }
+
+ private:
+  double learning_rate_;
+};
+
+}  // namespace
+
+TEST_CASE("gradient hooks", "[autograd][hooks]") {
+  using namespace abyss;
+
+  SECTION("fire once with the final gradient") {
+    auto x = leaf(arange(6, kFloat64).reshape({2, 3}) / 6.0);
+    int calls = 0;
+    Tensor seen;
+    x.register_hook([&](Tensor& t) {
+      calls++;
+      seen = t.grad().copy();
+    });
+
+    // x reaches the loss through three paths
+    sum(exp(x) + x + tanh(x)).backward();
+
+    REQUIRE(calls == 1);
+    for (int i = 0; i < 2; i++)
+      for (int j = 0; j < 3; j++) {
+        double v = x(i, j);
+        double t = std::tanh(v);
+        REQUIRE(double(seen(i, j)) == Approx(std::exp(v) + 2 - t * t));
+        REQUIRE(double(x.grad()(i, j)) == double(seen(i, j)));
+      }
+  }
+
+  SECTION("leaves outside the graph are not notified") {
+    auto x = leaf(randn({3}));
+    auto unused = leaf(randn({3}));
+    int calls = 0;
+    unused.register_hook([&](Tensor&) { calls++; });
+
+    sum(exp(x)).backward();
+    REQUIRE(calls == 0);
+  }
+
+  SECTION("copies share hooks") {
+    auto x = leaf(randn({3}));
+    auto alias = x;
+    int calls = 0;
+    alias.register_hook([&](Tensor&) { calls++; });
+
+    sum(exp(x)).backward();
+    REQUIRE(calls == 1);
+  }
+}
+
+TEST_CASE("optimizer updates overlapped with backward", "[autograd][hooks]") {
+  using namespace abyss;
+  manual_seed(3);
+
+  auto x = randn({4, 5});
+  auto make_params = [] {
+    return std::vector<Tensor>{leaf(randn({6, 4})), leaf(randn({3, 6}))};
+  };
+  auto reference = make_params();
+  std::vector<Tensor> overlapped;
+  for (auto&& p : reference) overlapped.push_back(leaf(p.copy()));
+
+  optim::SGD plain(reference, 0.05);
+  optim::SGD overlap(overlapped, 0.05);
+  overlap.overlap_with_backward();
+
+  auto train_step = [&x](std::vector<Tensor>& params, optim::SGD& sgd) {
+    sgd.zero_grad();
+    sum(tanh(matmul(params[1], tanh(matmul(params[0], x))))).backward();
+    sgd.step();
+  };
+  for (int i = 0; i < 3; i++) {
+    train_step(reference, plain);
+    train_step(overlapped, overlap);
+  }
+
+  for (size_t p = 0; p < reference.size(); p++) {
+    bool same = (reference[p] == overlapped[p]).all();
+    REQUIRE(same);
+  }
+}
+
+TEST_CASE("optimizer updates are not recorded", "[autograd][hooks]") {
+  using namespace abyss;
+  manual_seed(3);
+
+  auto x = randn({4, 5});
+  std::vector<Tensor> params{leaf(randn({3, 4}))};
+  TrackedSGD sgd(params, 0.05);
+
+  sum(tanh(matmul(params[0], x))).backward();
+  REQUIRE(autograd::Graph::instance().edges().empty());
+  sgd.step();
+  REQUIRE(autograd::Graph::instance().edges().empty());
+}
+
+TEST_CASE("background worker", "[utils][worker]") {
+  abyss::utils::BackgroundWorker worker;
+
+  std::vector<int> order;
+  for (int i = 0; i < 4; i++) worker.submit([&order, i] { order.push_back(i); });
+  worker.wait();
+  REQUIRE(order == std::vector<int>{0, 1, 2, 3});
+
+  worker.submit([] { throw std::runtime_error("task failed"); });
+  worker.submit([&order] { order.push_back(4); });
+  REQUIRE_THROWS_AS(worker.wait(), std::runtime_error);
+  REQUIRE(order.back() == 4);
+
+  // the error is reported once
+  REQUIRE_NOTHROW(worker.wait());
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch.hpp>
+#include <vector>
+
+#include "autograd/capture.h"
+#include "autograd/planner.h"
+#include "functional.h"
+#include "operators.h"
+
+TEST_CASE("memory plan for a captured chain", "[autograd][planner]") {
+  using namespace abyss;
+
+  auto x = full({16, 8}, 0.01);
+  auto step = [&x] {
+    auto h = x;
+    for (int i = 0; i < 6; i++) {
+      h = exp(h) - h;
+    }
+    return sum(h, 1);
+  };
+
+  autograd::CapturedGraph graph;
+  Tensor out;
+  {
+    autograd::CaptureGuard guard(graph);
+    out = step();
+  }
+
+  auto plan = autograd::plan_memory(graph);
+
+  REQUIRE_FALSE(plan.blocks.empty());
+  CHECK(plan.live_peak_bytes <= plan.arena_bytes);
+  CHECK(plan.arena_bytes < plan.naive_bytes);
+
+  // buffers alive at the same time never share memory
+  for (auto& a : plan.blocks) {
+    for (auto& b : plan.blocks) {
+      if (&a == &b) continue;
+      bool live_together = a.first <= b.last && b.first <= a.last;
+      bool share_memory =
+          a.offset < b.offset + b.nbytes && b.offset < a.offset + a.nbytes;
+      REQUIRE_FALSE((live_together && share_memory));
+    }
+  }
+
+  SECTION("replay on the arena") {
+    autograd::apply_plan(graph, plan);
+
+    x(kAll) = full({16, 8}, 0.5);
+    graph.replay();
+
+    auto expected = step();
+    bool same = (out == expected).all();
+    REQUIRE(same);
+  }
+}
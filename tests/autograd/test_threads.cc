@@ -0,0 +1,144 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "autograd/grad_mode.h"
+#include "functional.h"
+#include "nn/module.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kIsLeaf, true);
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+bool same(abyss::Tensor a, abyss::Tensor b) {
+  return a.shape() == b.shape() && bool((a == b).all());
+}
+
+/**
+ * @brief run `fn(thread id)` on `n` threads, true if every call returned true.
+ */
+template <typename Callable>
+bool run_threads(int n, Callable fn) {
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n; t++) {
+    threads.emplace_back([&, t] {
+      bool ok = false;
+      try {
+        ok = fn(t);
+      } catch (...) {
+      }
+      if (!ok) failures++;
+    });
+  }
+  for (auto& th : threads) th.join();
+  return failures == 0;
+}
+
+}  // namespace
+
+TEST_CASE("threads train on separate graphs", "[autograd][threads]") {
+  using namespace abyss;
+  const int n_threads = 4;
+  const int n_steps = 50;
+
+  std::vector<Tensor> weights, inputs, expected;
+  for (int t = 0; t < n_threads; t++) {
+    weights.push_back(randn({8, 6}));
+    inputs.push_back(randn({6, 5}));
+
+    auto w = leaf(weights[t].copy());
+    (sum(tanh(matmul(w, inputs[t]))) + sum(exp(w))).backward();
+    expected.push_back(w.grad().copy());
+  }
+
+  bool ok = run_threads(n_threads, [&](int t) {
+    for (int step = 0; step < n_steps; step++) {
+      auto w = leaf(weights[t].copy());
+      (sum(tanh(matmul(w, inputs[t]))) + sum(exp(w))).backward();
+      if (!same(w.grad(), expected[t])) return false;
+    }
+    // every backward released what its thread recorded
+    return autograd::Graph::instance().edges().empty();
+  });
+  REQUIRE(ok);
+}
+
+TEST_CASE("threads register their own parameters", "[autograd][threads]") {
+  using namespace abyss;
+
+  bool ok = run_threads(4, [](int) {
+    nn::Linear fc(3, 2);
+    return fc.parameters().size() == 2;
+  });
+  REQUIRE(ok);
+}
+
+TEST_CASE("inference threads share weights", "[autograd][threads]") {
+  using namespace abyss;
+  const int n_threads = 8;
+  const int n_steps = 100;
+
+  nn::Linear fc(16, 8, true, Activation::kReLU);
+  std::vector<Tensor> inputs, expected;
+  for (int t = 0; t < n_threads; t++) {
+    inputs.push_back(randn({16, 4}));
+    autograd::NoGradGuard no_grad;
+    expected.push_back(fc(inputs[t]));
+  }
+
+  bool ok = run_threads(n_threads, [&](int t) {
+    // half of the threads record graphs, which stay local to the thread
+    bool record = t % 2 == 0;
+    for (int step = 0; step < n_steps; step++) {
+      Tensor y;
+      if (record) {
+        y = fc(inputs[t]);
+      } else {
+        autograd::NoGradGuard no_grad;
+        y = fc(inputs[t]);
+      }
+      if (!same(y, expected[t])) return false;
+    }
+    return record != autograd::Graph::instance().edges().empty();
+  });
+  REQUIRE(ok);
+}
+
+TEST_CASE("inference throughput across threads", "[.][stress][threads]") {
+  using namespace abyss;
+  const int batch = 32;
+  const int n_steps = 200;
+
+  nn::Linear fc1(256, 512, true, Activation::kReLU);
+  nn::Linear fc2(512, 10);
+  auto x = randn({256, batch});
+
+  int max_threads = std::max(4u, std::thread::hardware_concurrency());
+  for (int n = 1; n <= max_threads; n *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = run_threads(n, [&](int) {
+      autograd::NoGradGuard no_grad;
+      for (int step = 0; step < n_steps; step++) fc2(fc1(x));
+      return true;
+    });
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    REQUIRE(ok);
+
+    std::cout << n << " threads: " << n * n_steps * batch / elapsed.count()
+              << " samples/s" << std::endl;
+  }
+}
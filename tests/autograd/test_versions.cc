@@ -0,0 +1,96 @@
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+
+#include "functional.h"
+#include "operators.h"
+#include "tensor.h"
+
+namespace {
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kIsLeaf, true);
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+struct CopyOnWriteGuard {
+  explicit CopyOnWriteGuard(bool enabled)
+      : prev_{abyss::copy_on_write_enabled()} {
+    abyss::set_copy_on_write(enabled);
+  }
+  ~CopyOnWriteGuard() { abyss::set_copy_on_write(prev_); }
+
+  bool prev_;
+};
+
+}  // namespace
+
+TEST_CASE("storage versions", "[autograd][version]") {
+  using namespace abyss;
+  CopyOnWriteGuard guard(false);
+
+  SECTION("count in-place writes") {
+    auto a = arange(6, kFloat64) - 3.0;
+    uint64_t before = a.version();
+    relu_(a);
+    REQUIRE(a.version() > before);
+  }
+
+  SECTION("are shared with views") {
+    auto a = arange(6, kFloat64).reshape({2, 3});
+    uint64_t before = a.version();
+    a(1) = full({3}, 0.0);
+    REQUIRE(a.version() > before);
+    REQUIRE(a(0).version() == a.version());
+    REQUIRE(double(sum(a)) == 3.0);
+  }
+
+  SECTION("backward rejects saved tensors modified in place") {
+    auto x = leaf(arange(6, kFloat64).reshape({2, 3}) / 6.0);
+    auto w = (arange(6, kFloat64) - 3.0).reshape({3, 2});
+    auto y = sum(matmul(x, w));
+
+    relu_(w);
+    REQUIRE_THROWS_AS(y.backward(), std::runtime_error);
+  }
+
+  SECTION("backward accepts untouched saved tensors") {
+    auto x = leaf(arange(6, kFloat64).reshape({2, 3}) / 6.0);
+    auto w = (arange(6, kFloat64) - 3.0).reshape({3, 2});
+    sum(matmul(x, w)).backward();
+
+    // rows of w sum to -5, -1 and 3
+    REQUIRE(double(sum(x.grad())) == -6.0);
+  }
+}
+
+TEST_CASE("copy on write", "[autograd][version][cow]") {
+  using namespace abyss;
+  CopyOnWriteGuard guard(true);
+
+  SECTION("saved tensors keep their values") {
+    auto x = leaf(arange(6, kFloat64).reshape({2, 3}) / 6.0);
+    auto w = (arange(6, kFloat64) - 3.0).reshape({3, 2});
+    auto y = sum(matmul(x, w));
+
+    relu_(w);
+    REQUIRE_NOTHROW(y.backward());
+
+    // rows of w sum to -5, -1 and 3
+    REQUIRE(double(sum(x.grad())) == -6.0);
+    REQUIRE(double(sum(w)) == 3.0);
+  }
+
+  SECTION("copies share storage until written") {
+    auto a = arange(6, kFloat64) - 3.0;
+    auto b = a.copy();
+    relu_(b);
+    REQUIRE(double(sum(a)) == -3.0);
+    REQUIRE(double(sum(b)) == 3.0);
+
+    relu_(a);
+    bool same = (a == b).all();
+    REQUIRE(same);
+  }
+}
@@ -0,0 +1,144 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backend/autotune.h"
+#include "backend/matmul.h"
+#include "catch2/catch.hpp"
+
+TEST_CASE("auto-tuner", "[native][autotune]") {
+  using namespace abyss::backend;
+  using namespace std::chrono_literals;
+  const std::string path = "abyss-test-autotune.json";
+  std::remove(path.c_str());
+  auto previous = autotune_cache();
+  set_autotune_cache(path);
+
+  // the second candidate is the fast one
+  std::map<long, int> runs;
+  auto run = [&](const TuneConfig& c) {
+    runs[c[0]]++;
+    std::this_thread::sleep_for(c[0] == 2 ? 0ms : 2ms);
+  };
+  std::vector<TuneConfig> candidates = {{1}, {2}, {3}};
+
+  REQUIRE(autotune("sleep", "8x8", candidates, run) == TuneConfig{2});
+  REQUIRE(runs[1] > 0);
+  REQUIRE(runs[3] > 0);
+
+  SECTION("winners are kept in memory") {
+    runs.clear();
+    REQUIRE(autotune("sleep", "8x8", candidates, run) == TuneConfig{2});
+    REQUIRE(runs.empty());
+  }
+
+  SECTION("and on disk") {
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    REQUIRE(ss.str().find("\"sleep|8x8|t") != std::string::npos);
+
+    // a new process starts from the file
+    set_autotune_cache(path);
+    runs.clear();
+    REQUIRE(autotune("sleep", "8x8", candidates, run) == TuneConfig{2});
+    REQUIRE(runs.empty());
+  }
+
+  SECTION("shape classes are tuned apart") {
+    runs.clear();
+    autotune("sleep", "16x8", candidates, run);
+    REQUIRE_FALSE(runs.empty());
+  }
+
+  SECTION("disabled tuning returns the default") {
+    set_autotune_enabled(false);
+    runs.clear();
+    REQUIRE(autotune("sleep", "32x8", candidates, run) == TuneConfig{1});
+    REQUIRE(runs.empty());
+    set_autotune_enabled(true);
+  }
+
+  std::remove(path.c_str());
+  set_autotune_cache(previous);
+}
+
+TEST_CASE("auto-tuner call sites", "[native][autotune]") {
+  using namespace abyss::backend;
+  using namespace std::chrono_literals;
+  auto previous = autotune_cache();
+  set_autotune_cache("");
+
+  std::map<long, int> runs;
+  auto run = [&](const TuneConfig& c) {
+    runs[c[0]]++;
+    std::this_thread::sleep_for(c[0] == 3 ? 0ms : 2ms);
+  };
+  TuneSite site("sleep_site", {{1}, {2}, {3}});
+
+  REQUIRE(site({8, 8}, run) == TuneConfig{3});
+  REQUIRE_FALSE(runs.empty());
+
+  // the same shape class is a lookup
+  runs.clear();
+  REQUIRE(site({7, 5}, run) == TuneConfig{3});
+  REQUIRE(runs.empty());
+
+  SECTION("other shape classes are tuned") {
+    site({16, 8}, run);
+    REQUIRE_FALSE(runs.empty());
+  }
+
+  SECTION("a new cache forgets the winners") {
+    set_autotune_cache("");
+    site({8, 8}, run);
+    REQUIRE_FALSE(runs.empty());
+  }
+
+  SECTION("defaults are cached until tuning is turned on") {
+    set_autotune_enabled(false);
+    REQUIRE(site({32, 8}, run) == TuneConfig{1});
+    REQUIRE(site({32, 8}, run) == TuneConfig{1});
+    REQUIRE(runs.empty());
+
+    set_autotune_enabled(true);
+    REQUIRE(site({32, 8}, run) == TuneConfig{3});
+    REQUIRE_FALSE(runs.empty());
+  }
+
+  set_autotune_cache(previous);
+}
+
+TEST_CASE("auto-tuner shape classes", "[native][autotune]") {
+  using abyss::backend::shape_class;
+  REQUIRE(shape_class({64, 100, 1}) == "64x128x1");
+  REQUIRE(shape_class({65}) == "128");
+}
+
+TEST_CASE("tuned linear matches gemm", "[native][autotune]") {
+  using namespace abyss::backend;
+  auto previous = autotune_cache();
+  set_autotune_cache("");
+
+  const int m = 64, k = 16, n = 300;
+  std::vector<double> w(m * k), x(k * n), y(m * n), expected(m * n);
+  for (size_t i = 0; i < w.size(); i++) w[i] = double(i % 7) - 3.0;
+  for (size_t i = 0; i < x.size(); i++) x[i] = double(i % 5) - 2.0;
+  gemm(false, false, m, n, k, 1.0, w.data(), x.data(), 0.0, expected.data());
+  for (auto& v : expected) v = v > 0 ? v : 0.0;
+
+  // the first call tunes, the second one uses the winner
+  for (int i = 0; i < 2; i++) {
+    std::vector<uint8_t> mask(m * n / 8);
+    linear(w.data(), x.data(), nullptr, Activation::kReLU, m, k, n, y.data(),
+           mask.data());
+    REQUIRE(y == expected);
+  }
+
+  set_autotune_cache(previous);
+}
@@ -0,0 +1,78 @@
+#include <cmath>
+#include <vector>
+
+#include "backend/parallel.h"
+#include "backend/philox.h"
+#include "backend/random.h"
+#include "catch2/catch.hpp"
+
+TEST_CASE("philox known answers", "[native][random][philox]") {
+  using abyss::backend::Philox4x32;
+
+  SECTION("zero counter and key") {
+    auto out = Philox4x32::generate(Philox4x32::counter_type{0, 0, 0, 0},
+                                    Philox4x32::key_type{0, 0});
+
+    REQUIRE(out == Philox4x32::counter_type{0x6627e8d5, 0xe169c58d,
+                                            0xbc57ac4c, 0x9b00dbd8});
+  }
+
+  SECTION("all bits set") {
+    auto out = Philox4x32::generate(
+        Philox4x32::counter_type{0xffffffff, 0xffffffff, 0xffffffff,
+                                 0xffffffff},
+        Philox4x32::key_type{0xffffffff, 0xffffffff});
+
+    REQUIRE(out == Philox4x32::counter_type{0x408f276d, 0x41c83b0e,
+                                            0xa20bc7c6, 0x6d5451fd});
+  }
+}
+
+TEST_CASE("random fills are independent of threading",
+          "[native][random][parallel]") {
+  using namespace abyss::backend;
+  const size_t n = 100001;  // odd on purpose
+  const int default_threads = get_num_threads();
+
+  std::vector<double> single(n);
+  std::vector<double> multi(n);
+
+  set_num_threads(1);
+  normal(42, 7, n, single.data());
+  set_num_threads(4);
+  normal(42, 7, n, multi.data());
+  set_num_threads(default_threads);
+
+  REQUIRE(single == multi);
+
+  SECTION("sub ranges can be generated on their own") {
+    // elements [2k, n) are produced by counters starting at `offset + k`
+    const size_t k = 1000;
+    std::vector<double> tail(n - 2 * k);
+    normal(42, 7 + k, tail.size(), tail.data());
+
+    REQUIRE(std::equal(tail.begin(), tail.end(), single.begin() + 2 * k));
+  }
+
+  SECTION("sample moments") {
+    double mean = 0;
+    double var = 0;
+    for (auto x : single) mean += x;
+    mean /= n;
+    for (auto x : single) var += (x - mean) * (x - mean);
+    var /= n;
+
+    CHECK(std::abs(mean) < 0.02);
+    CHECK(std::abs(var - 1.0) < 0.02);
+  }
+
+  SECTION("uniform samples stay in range") {
+    std::vector<double> u(n);
+    uniform(42, 7, n, u.data());
+
+    for (auto x : u) {
+      REQUIRE(x >= 0.0);
+      REQUIRE(x < 1.0);
+    }
+  }
+}
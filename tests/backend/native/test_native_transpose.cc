@@ -0,0 +1,58 @@
+#include <cstdint>
+#include <vector>
+
+#include "backend/parallel.h"
+#include "backend/transpose.h"
+#include "catch2/catch.hpp"
+
+TEST_CASE("blocked transpose", "[native][transpose]") {
+  using abyss::backend::transpose;
+
+  SECTION("ragged shapes and leading dimensions") {
+    // edges that are not a multiple of the block or tile size
+    for (size_t rows : {1, 3, 8, 67, 130}) {
+      for (size_t cols : {1, 5, 64, 71}) {
+        const size_t ld_in = cols + 3;
+        const size_t ld_out = rows + 2;
+        std::vector<double> in(rows * ld_in);
+        for (size_t i = 0; i < in.size(); i++) in[i] = double(i);
+        std::vector<double> out(cols * ld_out, -1.0);
+
+        transpose(in.data(), ld_in, rows, cols, out.data(), ld_out);
+
+        bool same = true;
+        for (size_t c = 0; c < cols; c++) {
+          for (size_t r = 0; r < rows; r++) {
+            same &= out[c * ld_out + r] == in[r * ld_in + c];
+          }
+          // padding is left alone
+          for (size_t r = rows; r < ld_out; r++) {
+            same &= out[c * ld_out + r] == -1.0;
+          }
+        }
+        INFO(rows << " x " << cols);
+        REQUIRE(same);
+      }
+    }
+  }
+
+  SECTION("int32 on several threads") {
+    int prev = abyss::backend::get_num_threads();
+    abyss::backend::set_num_threads(4);
+
+    const size_t rows = 300, cols = 500;
+    std::vector<int32_t> in(rows * cols);
+    for (size_t i = 0; i < in.size(); i++) in[i] = int32_t(i);
+    std::vector<int32_t> out(rows * cols);
+    transpose(in.data(), cols, rows, cols, out.data(), rows);
+    abyss::backend::set_num_threads(prev);
+
+    bool same = true;
+    for (size_t r = 0; r < rows; r++) {
+      for (size_t c = 0; c < cols; c++) {
+        same &= out[c * rows + r] == in[r * cols + c];
+      }
+    }
+    REQUIRE(same);
+  }
+}
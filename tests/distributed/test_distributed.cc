@@ -0,0 +1,218 @@
+#include <catch2/catch.hpp>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "distributed/data_parallel.h"
+#include "distributed/process_group.h"
+#include "functional.h"
+#include "nn/module.h"
+#include "operators.h"
+#include "optimizers.h"
+#include "random.h"
+#include "tensor.h"
+#include "utils/data.h"
+
+namespace {
+
+/**
+ * @brief run `fn(rank)` in `world` forked processes, true if every rank
+ * returned true.
+ */
+template <typename Callable>
+bool run_ranks(int world, Callable fn) {
+  std::vector<pid_t> pids;
+  for (int rank = 0; rank < world; rank++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      bool ok = false;
+      try {
+        ok = fn(rank);
+      } catch (...) {
+      }
+      // skip the destructors of state inherited from the test process
+      _exit(ok ? 0 : 1);
+    }
+    pids.push_back(pid);
+  }
+
+  bool ok = true;
+  for (pid_t pid : pids) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ok &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  return ok;
+}
+
+std::string segment_name(const std::string& tag) {
+  return "/abyss-test-" + std::to_string(getpid()) + "-" + tag;
+}
+
+bool close(double a, double b) { return std::abs(a - b) < 1e-10; }
+
+class Range : public abyss::utils::data::Dataset {
+ public:
+  explicit Range(size_t n) : n_{n} {}
+  size_t size() const override { return n_; }
+  std::pair<abyss::Tensor, abyss::Tensor> operator[](size_t idx) override {
+    return {abyss::full({1}, double(idx)), abyss::full({1}, int(idx))};
+  }
+
+ private:
+  size_t n_;
+};
+
+}  // namespace
+
+TEST_CASE("shared memory collectives", "[distributed]") {
+  using namespace abyss;
+  const int world = 3;
+  // buckets of 7 values, tensors straddle bucket and chunk boundaries
+  const size_t bucket_bytes = 7 * sizeof(double);
+  const std::vector<int> sizes{5, 6, 1, 11};
+
+  auto name = segment_name("collectives");
+  bool ok = run_ranks(world, [&](int rank) {
+    distributed::ProcessGroup group(name, rank, world, bucket_bytes);
+
+    std::vector<Tensor> tensors;
+    for (int n : sizes) tensors.push_back(full({n}, 0.0));
+    auto fill = [&](double scale) {
+      for (size_t t = 0; t < sizes.size(); t++)
+        for (int i = 0; i < sizes[t]; i++)
+          tensors[t](i) = scale * (10 * t + i);
+    };
+    auto check = [&](double scale) {
+      for (size_t t = 0; t < sizes.size(); t++)
+        for (int i = 0; i < sizes[t]; i++)
+          if (!close(double(tensors[t](i)), scale * (10 * t + i))) return false;
+      return true;
+    };
+
+    // ranks contribute 1, 2 and 3 times the values
+    fill(rank + 1);
+    group.all_reduce(tensors);
+    if (!check(6)) return false;
+
+    fill(rank + 1);
+    group.all_reduce(tensors, distributed::ReduceOp::kAverage);
+    if (!check(2)) return false;
+
+    fill(rank + 1);
+    group.broadcast(tensors, 1);
+    if (!check(2)) return false;
+
+    auto strided = full({4, 4}, 1.0).T();
+    bool rejected = false;
+    try {
+      group.all_reduce(strided);
+    } catch (std::runtime_error&) {
+      rejected = true;
+    }
+    return rejected;
+  });
+  REQUIRE(ok);
+}
+
+TEST_CASE("data parallel training", "[distributed]") {
+  using namespace abyss;
+  const int world = 2;
+  const int in = 4, out = 3, batch = 5;
+  const double lr = 0.1;
+
+  auto name = segment_name("ddp");
+  bool ok = run_ranks(world, [&](int rank) {
+    distributed::ProcessGroup group(name, rank, world);
+
+    // replicas start out different, the wrapper broadcasts rank 0
+    manual_seed(rank);
+    nn::Linear fc(in, out);
+    distributed::DistributedDataParallel model(fc, group);
+    optim::SGD sgd(model.parameters(), lr);
+
+    manual_seed(0);
+    auto initial = randn({out, in});
+    auto inputs = [=](int r) {
+      manual_seed(100 + r);
+      return randn({in, batch});
+    };
+
+    sgd.zero_grad();
+    sum(model(inputs(rank))).backward();
+    model.synchronize();
+
+    // d sum(W x + b) / dW(i, j) is the sum of row j of x, averaged over ranks
+    std::vector<double> grad(in, 0.0);
+    for (int r = 0; r < world; r++) {
+      auto x = inputs(r);
+      for (int j = 0; j < in; j++)
+        for (int b = 0; b < batch; b++) grad[j] += double(x(j, b)) / world;
+    }
+    for (int i = 0; i < out; i++) {
+      if (!close(double(fc.bias().grad()(i, 0)), batch)) return false;
+      for (int j = 0; j < in; j++) {
+        if (!close(double(fc.weight().grad()(i, j)), grad[j])) return false;
+      }
+    }
+
+    sgd.step();
+    for (int i = 0; i < out; i++)
+      for (int j = 0; j < in; j++) {
+        double expected = double(initial(i, j)) - lr * grad[j];
+        if (!close(double(fc.weight()(i, j)), expected)) return false;
+      }
+    return true;
+  });
+  REQUIRE(ok);
+}
+
+TEST_CASE("data parallel backward twice", "[distributed]") {
+  using namespace abyss;
+  distributed::ProcessGroup group(segment_name("ddp-twice"), 0, 1);
+  nn::Linear fc(4, 3);
+  distributed::DistributedDataParallel model(fc, group);
+
+  auto x = randn({4, 5});
+  sum(model(x)).backward();
+  // the first bucket may already be reducing these gradients
+  REQUIRE_THROWS(sum(model(x)).backward());
+
+  model.synchronize();
+  REQUIRE_NOTHROW(sum(model(x)).backward());
+  model.synchronize();
+}
+
+TEST_CASE("shard data loader", "[distributed][data]") {
+  using namespace abyss;
+  Range dataset(10);
+  const size_t world = 3;
+
+  std::set<int> seen;
+  for (size_t rank = 0; rank < world; rank++) {
+    abyss::manual_seed(7);
+    utils::data::DataLoader loader(dataset, 3, true);
+    loader.shard(rank, world);
+    // 10 samples padded to 4 per rank
+    REQUIRE(loader.size() == 2);
+
+    size_t n_batches = 0;
+    size_t n_samples = 0;
+    for (auto it = loader.begin(); it != loader.end(); ++it) {
+      auto& y = it->second;
+      for (int i = 0; i < y.shape(0); i++) seen.insert(int(y(i)));
+      n_samples += y.shape(0);
+      n_batches++;
+    }
+    REQUIRE(n_batches == 2);
+    REQUIRE(n_samples == 4);
+  }
+  REQUIRE(seen.size() == 10);
+
+  REQUIRE_THROWS(utils::data::DataLoader(dataset).shard(3, 3));
+}
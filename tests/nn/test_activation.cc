@@ -0,0 +1,160 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "functional.h"
+#include "nn/activation.h"
+#include "nn/module.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+using abyss::Activation;
+
+double reference(Activation act, double z) {
+  switch (act) {
+    case Activation::kReLU:
+      return z > 0 ? z : 0;
+    case Activation::kGELU:
+      return 0.5 * z * (1 + std::erf(z / std::sqrt(2.0)));
+    case Activation::kSigmoid:
+      return 1 / (1 + std::exp(-z));
+    case Activation::kTanh:
+      return std::tanh(z);
+    default:
+      return z;
+  }
+}
+
+double derivative(Activation act, double z) {
+  switch (act) {
+    case Activation::kReLU:
+      return z > 0 ? 1 : 0;
+    case Activation::kGELU:
+      return 0.5 * (1 + std::erf(z / std::sqrt(2.0))) +
+             z * std::exp(-0.5 * z * z) / std::sqrt(2 * M_PI);
+    case Activation::kSigmoid:
+      return reference(act, z) * (1 - reference(act, z));
+    case Activation::kTanh:
+      return 1 - std::tanh(z) * std::tanh(z);
+    default:
+      return 1;
+  }
+}
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+}  // namespace
+
+TEST_CASE("fused bias activation", "[nn][activation]") {
+  abyss::manual_seed(11);
+  const int rows = 5, cols = 7;
+
+  auto act = GENERATE(Activation::kIdentity, Activation::kReLU,
+                      Activation::kGELU, Activation::kSigmoid,
+                      Activation::kTanh);
+  // bias per row (axis 0) or per column (axis 1)
+  auto axis = GENERATE(0, 1);
+
+  auto x = leaf(abyss::randn({rows, cols}));
+  auto b = leaf(abyss::randn({axis == 0 ? rows : cols}));
+
+  auto y = abyss::bias_activation(x, b, axis, act);
+  REQUIRE(y.shape() == x.shape());
+
+  abyss::sum(y).backward();
+
+  std::vector<double> grad_bias(b.size(), 0.0);
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++) {
+      int c = axis == 0 ? i : j;
+      double z = double(x(i, j)) + double(b(c));
+      REQUIRE(double(y(i, j)) == Approx(reference(act, z)).margin(1e-12));
+      REQUIRE(double(x.grad()(i, j)) ==
+              Approx(derivative(act, z)).margin(1e-12));
+      grad_bias[c] += derivative(act, z);
+    }
+  for (size_t c = 0; c < b.size(); c++) {
+    REQUIRE(double(b.grad()(c)) == Approx(grad_bias[c]).margin(1e-12));
+  }
+}
+
+TEST_CASE("activations without bias", "[nn][activation]") {
+  auto x = leaf(abyss::randn({3, 4, 5}));
+
+  // larger than one mask byte and not a multiple of 8
+  REQUIRE(x.size() % 8 != 0);
+
+  abyss::sum(abyss::relu(x) + abyss::tanh(x)).backward();
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 4; j++)
+      for (int k = 0; k < 5; k++) {
+        double z = x(i, j, k);
+        REQUIRE(double(x.grad()(i, j, k)) ==
+                Approx(derivative(Activation::kReLU, z) +
+                       derivative(Activation::kTanh, z)));
+      }
+}
+
+TEST_CASE("in-place activations", "[nn][activation]") {
+  SECTION("write through the input storage") {
+    auto x = abyss::randn({4, 6});
+    auto alias = x;
+    auto expected = abyss::sigmoid(x);
+
+    abyss::sigmoid_(x);
+    for (int i = 0; i < 4; i++)
+      for (int j = 0; j < 6; j++) {
+        REQUIRE(double(alias(i, j)) == Approx(double(expected(i, j))));
+      }
+  }
+
+  SECTION("differentiate through an intermediate") {
+    auto x = leaf(abyss::randn({4, 6}));
+    auto h = x + x;
+
+    abyss::relu_(h);
+    abyss::sum(h).backward();
+    for (int i = 0; i < 4; i++)
+      for (int j = 0; j < 6; j++) {
+        double z = 2.0 * double(x(i, j));
+        REQUIRE(double(h(i, j)) == Approx(reference(Activation::kReLU, z)));
+        REQUIRE(double(x.grad()(i, j)) == (z > 0 ? 2.0 : 0.0));
+      }
+  }
+
+  SECTION("leaves that require grad are rejected") {
+    auto x = leaf(abyss::randn({4, 6}));
+    REQUIRE_THROWS(abyss::relu_(x));
+  }
+
+  SECTION("module") {
+    abyss::nn::ReLU relu(true);
+    auto x = abyss::randn({8, 3});
+    auto alias = x;
+    relu(x);
+    for (int i = 0; i < 8; i++)
+      for (int j = 0; j < 3; j++) REQUIRE(double(alias(i, j)) >= 0.0);
+  }
+}
+
+TEST_CASE("linear with fused activation", "[nn][activation]") {
+  abyss::nn::Linear fc(3, 5, true, Activation::kTanh);
+  REQUIRE(fc.bias().shape() == std::vector<int>{5, 1});
+
+  auto x = abyss::randn({3, 2});
+  auto y = fc(x);
+  REQUIRE(y.shape() == std::vector<int>{5, 2});
+
+  auto expected = abyss::tanh(abyss::matmul(fc.weight(), x) + fc.bias());
+  for (int i = 0; i < 5; i++)
+    for (int j = 0; j < 2; j++) {
+      REQUIRE(double(y(i, j)) == Approx(double(expected(i, j))));
+    }
+}
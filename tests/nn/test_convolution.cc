@@ -0,0 +1,144 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include "functional.h"
+#include "nn/convolution.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+struct Config {
+  int batch, in_channels, out_channels, height, width, kernel;
+  int stride, padding, dilation, groups;
+};
+
+std::vector<double> to_vector(abyss::Tensor t) {
+  std::vector<double> out;
+  for (int a = 0; a < t.shape(0); a++)
+    for (int b = 0; b < t.shape(1); b++)
+      for (int c = 0; c < t.shape(2); c++)
+        for (int d = 0; d < t.shape(3); d++) out.emplace_back(t(a, b, c, d));
+  return out;
+}
+
+int out_size(int size, const Config& cfg) {
+  return (size + 2 * cfg.padding - cfg.dilation * (cfg.kernel - 1) - 1) /
+             cfg.stride + 1;
+}
+
+/**
+ * direct loops, the reference for both passes: forward returns the output,
+ * backward accumulates `grad_output` into the input and weight gradients.
+ */
+std::vector<double> reference(const Config& cfg, const std::vector<double>& x,
+                              const std::vector<double>& w,
+                              const std::vector<double>* grad_output = nullptr,
+                              std::vector<double>* grad_x = nullptr,
+                              std::vector<double>* grad_w = nullptr) {
+  const int oh_size = out_size(cfg.height, cfg);
+  const int ow_size = out_size(cfg.width, cfg);
+  const int in_group = cfg.in_channels / cfg.groups;
+  const int out_group = cfg.out_channels / cfg.groups;
+  const int k = cfg.kernel;
+
+  std::vector<double> y(cfg.batch * cfg.out_channels * oh_size * ow_size, 0.0);
+  for (int n = 0; n < cfg.batch; n++)
+    for (int o = 0; o < cfg.out_channels; o++)
+      for (int oh = 0; oh < oh_size; oh++)
+        for (int ow = 0; ow < ow_size; ow++) {
+          int yi = ((n * cfg.out_channels + o) * oh_size + oh) * ow_size + ow;
+          for (int ci = 0; ci < in_group; ci++)
+            for (int kh = 0; kh < k; kh++)
+              for (int kw = 0; kw < k; kw++) {
+                int ih = oh * cfg.stride - cfg.padding + kh * cfg.dilation;
+                int iw = ow * cfg.stride - cfg.padding + kw * cfg.dilation;
+                if (ih < 0 || ih >= cfg.height || iw < 0 || iw >= cfg.width)
+                  continue;
+                int c = (o / out_group) * in_group + ci;
+                int xi = ((n * cfg.in_channels + c) * cfg.height + ih) *
+                             cfg.width + iw;
+                int wi = ((o * in_group + ci) * k + kh) * k + kw;
+                y[yi] += x[xi] * w[wi];
+                if (grad_output) {
+                  (*grad_x)[xi] += (*grad_output)[yi] * w[wi];
+                  (*grad_w)[wi] += (*grad_output)[yi] * x[xi];
+                }
+              }
+        }
+  return y;
+}
+
+}  // namespace
+
+TEST_CASE("conv2d matches direct convolution", "[nn][conv2d]") {
+  abyss::manual_seed(7);
+
+  auto cfg = GENERATE(Config{2, 3, 4, 7, 6, 3, 1, 1, 1, 1},   // basic
+                      Config{1, 4, 6, 9, 9, 3, 2, 0, 1, 1},   // strided
+                      Config{2, 2, 3, 8, 8, 3, 1, 2, 2, 1},   // dilated
+                      Config{1, 4, 6, 5, 5, 3, 1, 1, 1, 2},   // grouped
+                      Config{2, 5, 5, 6, 7, 3, 2, 1, 1, 5},   // depthwise
+                      Config{2, 3, 4, 5, 5, 1, 1, 0, 1, 1});  // pointwise
+
+  auto x = abyss::randn({cfg.batch, cfg.in_channels, cfg.height, cfg.width});
+  auto w = abyss::randn(
+      {cfg.out_channels, cfg.in_channels / cfg.groups, cfg.kernel, cfg.kernel});
+  auto b = abyss::randn({cfg.out_channels});
+  x.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  w.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  b.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+
+  auto xs = to_vector(x);
+  auto ws = to_vector(w);
+  std::vector<double> ones(cfg.batch * cfg.out_channels *
+                               out_size(cfg.height, cfg) *
+                               out_size(cfg.width, cfg),
+                           1.0);
+  std::vector<double> grad_x(xs.size(), 0.0);
+  std::vector<double> grad_w(ws.size(), 0.0);
+  auto expected = reference(cfg, xs, ws, &ones, &grad_x, &grad_w);
+
+  auto y = abyss::conv2d(x, w, b, cfg.stride, cfg.padding, cfg.dilation,
+                         cfg.groups);
+  REQUIRE(y.shape() == std::vector<int>{cfg.batch, cfg.out_channels,
+                                        out_size(cfg.height, cfg),
+                                        out_size(cfg.width, cfg)});
+
+  auto ys = to_vector(y);
+  const int plane = ys.size() / (cfg.batch * cfg.out_channels);
+  for (size_t i = 0; i < ys.size(); i++) {
+    int o = (i / plane) % cfg.out_channels;
+    REQUIRE(ys[i] == Approx(expected[i] + double(b(o))));
+  }
+
+  abyss::sum(y).backward();
+
+  auto gx = to_vector(x.grad());
+  for (size_t i = 0; i < gx.size(); i++) {
+    REQUIRE(gx[i] == Approx(grad_x[i]).margin(1e-9));
+  }
+  auto gw = to_vector(w.grad());
+  for (size_t i = 0; i < gw.size(); i++) {
+    REQUIRE(gw[i] == Approx(grad_w[i]).margin(1e-9));
+  }
+  auto& gb = b.grad();
+  for (int o = 0; o < cfg.out_channels; o++) {
+    REQUIRE(double(gb(o)) == Approx(cfg.batch * plane));
+  }
+}
+
+TEST_CASE("conv2d module", "[nn][conv2d]") {
+  abyss::nn::Conv2d conv(3, 8, 3, 1, 1);
+
+  REQUIRE(conv.weight().shape() == std::vector<int>{8, 3, 3, 3});
+  REQUIRE(conv.bias().shape() == std::vector<int>{8});
+
+  auto y = conv(abyss::randn({2, 3, 10, 10}));
+  REQUIRE(y.shape() == std::vector<int>{2, 8, 10, 10});
+
+  REQUIRE_THROWS(conv(abyss::randn({2, 4, 10, 10})));
+  REQUIRE_THROWS(abyss::nn::Conv2d(3, 8, 3, 1, 0, 1, 2));
+}
@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include "functional.h"
+#include "nn/module.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+void require_close(abyss::Tensor a, abyss::Tensor b) {
+  REQUIRE(a.shape() == b.shape());
+  auto shape = a.shape();
+  shape.insert(shape.begin(), 2 - shape.size(), 1);
+  auto va = a.reshape(shape);
+  auto vb = b.reshape(shape);
+  for (int i = 0; i < shape[0]; i++)
+    for (int j = 0; j < shape[1]; j++) {
+      REQUIRE(double(va(i, j)) == Approx(double(vb(i, j))).margin(1e-10));
+    }
+}
+
+}  // namespace
+
+TEST_CASE("fused linear matches matmul + bias + activation", "[nn][linear]") {
+  using abyss::Activation;
+  abyss::manual_seed(5);
+
+  auto act = GENERATE(Activation::kIdentity, Activation::kReLU,
+                      Activation::kGELU, Activation::kSigmoid,
+                      Activation::kTanh);
+  // enough columns to split the output into several panels
+  auto batch = GENERATE(3, 700);
+  const int in = 13, out = 37;
+
+  auto x = leaf(abyss::randn({in, batch}));
+  auto w = leaf(abyss::randn({out, in}));
+  auto b = leaf(abyss::randn({out, 1}));
+  auto x_ref = leaf(x.detach());
+  auto w_ref = leaf(w.detach());
+  auto b_ref = leaf(b.detach());
+
+  // backward clears the graph, so each path is differentiated right away
+  auto y = abyss::linear(x, w, b, act);
+  abyss::sum(y).backward();
+  auto y_ref =
+      abyss::bias_activation(abyss::matmul(w_ref, x_ref), b_ref, 0, act);
+  abyss::sum(y_ref).backward();
+
+  require_close(y, y_ref);
+  require_close(x.grad(), x_ref.grad());
+  require_close(w.grad(), w_ref.grad());
+  require_close(b.grad(), b_ref.grad());
+}
+
+TEST_CASE("fused linear without bias", "[nn][linear]") {
+  auto x = abyss::randn({4, 6});
+  auto w = abyss::randn({5, 4});
+
+  require_close(abyss::linear(x, w), abyss::matmul(w, x));
+  REQUIRE_THROWS(abyss::linear(x, abyss::randn({5, 3})));
+  REQUIRE_THROWS(abyss::linear(x, w, abyss::randn({4})));
+}
@@ -1,7 +1,12 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "tensor.h"
 #include "operators.h"
+#include "functional.h"
 #include "nn/losses.h"
 
 TEST_CASE("negative log likelihood loss", "[loss][nll]") {
@@ -25,6 +30,91 @@ TEST_CASE("negative log likelihood loss", "[loss][nll]") {
 
   // std::cout<< loss << std::endl;
 
-  bool ok = (loss == 0.0875).all();
+  // only the first sample has a non-zero log probability at its target
+  bool ok = (loss == 0.0125).all();
   REQUIRE(ok);
-}
\ No newline at end of file
+}
+
+TEST_CASE("negative log likelihood loss backward", "[loss][nll]") {
+  abyss::nn::NLLLoss loss_fn;
+
+  const int batch = 4;
+  const int classes = 3;
+  auto input = abyss::randn({batch, classes});
+  auto target = abyss::full({batch}, 0);
+  target(1) = 2;
+  target(2) = 1;
+  target(3) = 2;
+
+  input.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  auto loss = loss_fn(input, target);
+  loss.backward();
+
+  auto grad = input.grad();
+  REQUIRE(grad.shape() == std::vector<int>{batch, classes});
+  for (int i = 0; i < batch; i++) {
+    int id = target(i);
+    for (int j = 0; j < classes; j++) {
+      double expected = (j == id) ? -1.0 / batch : 0.0;
+      REQUIRE(double(grad(i, j)) == Approx(expected));
+    }
+  }
+}
+TEST_CASE("cross entropy loss", "[loss][cross_entropy]") {
+  abyss::nn::CrossEntropyLoss loss_fn;
+
+  const int batch = 4;
+  const int classes = 5;
+  auto input = abyss::randn({batch, classes});
+  auto target = abyss::full({batch}, 0);
+  target(1) = 4;
+  target(2) = 2;
+  target(3) = 1;
+  // large scores must not overflow
+  input(0, 3) = 1000.0;
+
+  // reference: log-softmax followed by nll
+  std::vector<double> softmax(batch * classes);
+  double expected = 0.0;
+  for (int i = 0; i < batch; i++) {
+    double max = input(i, 0);
+    for (int j = 1; j < classes; j++) max = std::max(max, double(input(i, j)));
+    double denom = 0.0;
+    for (int j = 0; j < classes; j++) denom += std::exp(double(input(i, j)) - max);
+    for (int j = 0; j < classes; j++) {
+      softmax[i * classes + j] = std::exp(double(input(i, j)) - max) / denom;
+    }
+    int id = target(i);
+    expected -= double(input(i, id)) - max - std::log(denom);
+  }
+  expected /= batch;
+
+  SECTION("forward matches log-softmax + nll") {
+    auto loss = loss_fn(input, target);
+
+    REQUIRE(loss.shape() == std::vector<int>{1});
+    REQUIRE(double(loss) == Approx(expected));
+  }
+
+  SECTION("backward is (softmax - onehot) / batch") {
+    input.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+    auto loss = loss_fn(input, target);
+    loss.backward();
+
+    auto grad = input.grad();
+    REQUIRE(grad.shape() == std::vector<int>{batch, classes});
+    for (int i = 0; i < batch; i++) {
+      int id = target(i);
+      for (int j = 0; j < classes; j++) {
+        double onehot = (j == id) ? 1.0 : 0.0;
+        REQUIRE(double(grad(i, j)) ==
+                Approx((softmax[i * classes + j] - onehot) / batch));
+      }
+    }
+  }
+
+  SECTION("rejects class ids out of range") {
+    target(0) = classes;
+    REQUIRE_THROWS_AS(loss_fn(input, target), std::out_of_range);
+  }
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "autograd/grad_mode.h"
+#include "functional.h"
+#include "nn/normalization.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+using Loss = std::function<abyss::Tensor()>;
+
+/**
+ * @brief compare the gradient of `loss` w.r.t. `x` against central differences.
+ */
+void check_gradient(abyss::Tensor& x, const Loss& loss) {
+  auto shape = x.shape();
+  REQUIRE(shape.size() <= 4);
+  shape.insert(shape.begin(), 4 - shape.size(), 1);
+  auto view = x.reshape(shape);
+  auto grad = x.grad().reshape(shape);
+
+  abyss::autograd::NoGradGuard no_grad;
+  const double h = 1e-6;
+  for (int a = 0; a < shape[0]; a++)
+    for (int b = 0; b < shape[1]; b++)
+      for (int c = 0; c < shape[2]; c++)
+        for (int d = 0; d < shape[3]; d++) {
+          double orig = view(a, b, c, d);
+          view(a, b, c, d) = orig + h;
+          double plus = loss();
+          view(a, b, c, d) = orig - h;
+          double minus = loss();
+          view(a, b, c, d) = orig;
+
+          double numeric = (plus - minus) / (2 * h);
+          REQUIRE(double(grad(a, b, c, d)) ==
+                  Approx(numeric).epsilon(1e-4).margin(1e-6));
+        }
+}
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+}  // namespace
+
+TEST_CASE("batch normalization", "[nn][normalization]") {
+  abyss::manual_seed(3);
+  const int channels = 3;
+
+  SECTION("normalizes each channel and tracks running statistics") {
+    abyss::nn::BatchNorm2d bn(channels);
+    auto x = 2.0 * abyss::randn({4, channels, 3, 3}) + 1.0;
+
+    auto y = bn(x);
+    REQUIRE(y.shape() == x.shape());
+    for (int c = 0; c < channels; c++) {
+      double sum = 0, sq = 0;
+      for (int n = 0; n < 4; n++)
+        for (int i = 0; i < 9; i++) {
+          double v = y(n, c, i / 3, i % 3);
+          sum += v;
+          sq += v * v;
+        }
+      REQUIRE(sum / 36 == Approx(0.0).margin(1e-9));
+      REQUIRE(sq / 36 == Approx(1.0).epsilon(1e-4));
+
+      double mean = 0;
+      for (int n = 0; n < 4; n++)
+        for (int i = 0; i < 9; i++) mean += double(x(n, c, i / 3, i % 3));
+      mean /= 36;
+      REQUIRE(double(bn.running_mean()(c)) == Approx(0.1 * mean));
+    }
+
+    // evaluation uses the running statistics
+    bn.eval();
+    auto z = bn(x);
+    double rm = bn.running_mean()(1);
+    double rv = bn.running_var()(1);
+    REQUIRE(double(z(0, 1, 0, 0)) ==
+            Approx((double(x(0, 1, 0, 0)) - rm) / std::sqrt(rv + 1e-5)));
+  }
+
+  SECTION("gradients match finite differences") {
+    auto x = leaf(abyss::randn({2, channels, 2, 2}));
+    auto w = leaf(abyss::randn({channels}));
+    auto b = leaf(abyss::randn({channels}));
+
+    Loss loss = [&] {
+      auto y = abyss::batch_norm(x, abyss::Tensor(), abyss::Tensor(), w, b,
+                                 true);
+      return abyss::sum(abyss::exp(y));
+    };
+    loss().backward();
+
+    check_gradient(x, loss);
+    check_gradient(w, loss);
+    check_gradient(b, loss);
+  }
+}
+
+TEST_CASE("layer normalization", "[nn][normalization]") {
+  abyss::manual_seed(5);
+
+  SECTION("normalizes each sample") {
+    abyss::nn::LayerNorm ln({4, 5});
+    auto x = 3.0 * abyss::randn({2, 4, 5}) - 2.0;
+
+    auto y = ln(x);
+    for (int n = 0; n < 2; n++) {
+      double sum = 0, sq = 0;
+      for (int i = 0; i < 20; i++) {
+        double v = y(n, i / 5, i % 5);
+        sum += v;
+        sq += v * v;
+      }
+      REQUIRE(sum / 20 == Approx(0.0).margin(1e-9));
+      REQUIRE(sq / 20 == Approx(1.0).epsilon(1e-4));
+    }
+
+    REQUIRE_THROWS(ln(abyss::randn({2, 5, 4})));
+  }
+
+  SECTION("gradients match finite differences") {
+    auto x = leaf(abyss::randn({3, 6}));
+    auto w = leaf(abyss::randn({6}));
+    auto b = leaf(abyss::randn({6}));
+
+    Loss loss = [&] {
+      return abyss::sum(abyss::exp(abyss::layer_norm(x, {6}, w, b)));
+    };
+    loss().backward();
+
+    check_gradient(x, loss);
+    check_gradient(w, loss);
+    check_gradient(b, loss);
+  }
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include "functional.h"
+#include "nn/pooling.h"
+#include "operators.h"
+#include "tensor.h"
+
+namespace {
+
+abyss::Tensor make_input() {
+  // 0, 1, 2, ... 15 on a single 4x4 plane
+  auto x = abyss::empty({1, 1, 4, 4});
+  for (int i = 0; i < 16; i++) x(0, 0, i / 4, i % 4) = double(i);
+  x.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return x;
+}
+
+}  // namespace
+
+TEST_CASE("max pooling", "[nn][pooling]") {
+  abyss::nn::MaxPool2d pool(2);
+  auto x = make_input();
+
+  auto y = pool(x);
+  REQUIRE(y.shape() == std::vector<int>{1, 1, 2, 2});
+  REQUIRE(double(y(0, 0, 0, 0)) == 5.0);
+  REQUIRE(double(y(0, 0, 0, 1)) == 7.0);
+  REQUIRE(double(y(0, 0, 1, 0)) == 13.0);
+  REQUIRE(double(y(0, 0, 1, 1)) == 15.0);
+
+  abyss::sum(y).backward();
+
+  // only the winners receive the gradient
+  auto& grad = x.grad();
+  for (int i = 0; i < 16; i++) {
+    bool winner = (i == 5 || i == 7 || i == 13 || i == 15);
+    REQUIRE(double(grad(0, 0, i / 4, i % 4)) == (winner ? 1.0 : 0.0));
+  }
+
+  SECTION("padding never wins") {
+    auto x2 = -1.0 * make_input();
+    auto y2 = abyss::max_pool2d(x2, 3, 1, 1);
+    REQUIRE(y2.shape() == std::vector<int>{1, 1, 4, 4});
+    REQUIRE(double(y2(0, 0, 0, 0)) == 0.0);
+    REQUIRE(double(y2(0, 0, 3, 3)) == -10.0);
+  }
+
+  REQUIRE_THROWS(abyss::max_pool2d(x, 2, 2, 2));
+}
+
+TEST_CASE("average pooling", "[nn][pooling]") {
+  abyss::nn::AvgPool2d pool(2);
+  auto x = make_input();
+
+  auto y = pool(x);
+  REQUIRE(y.shape() == std::vector<int>{1, 1, 2, 2});
+  REQUIRE(double(y(0, 0, 0, 0)) == Approx(2.5));
+  REQUIRE(double(y(0, 0, 1, 1)) == Approx(12.5));
+
+  abyss::sum(y).backward();
+
+  auto& grad = x.grad();
+  for (int i = 0; i < 16; i++) {
+    REQUIRE(double(grad(0, 0, i / 4, i % 4)) == Approx(0.25));
+  }
+}
@@ -110,6 +110,35 @@ TEST_CASE("initialize array with containers", "[array][constructor]") {
   }
 }
 
+TEST_CASE("single element arrays are stored inline", "[array][scalar]") {
+  using namespace abyss::core;
+
+  ArrayImpl<double> a(1, 2.5);
+  ArrayImpl<double> b = {1.0, 2.0};
+
+  SECTION("moves keep the element") {
+    ArrayImpl<double> moved(std::move(a));
+    REQUIRE(moved.size() == 1);
+    REQUIRE(moved[0] == 2.5);
+    moved[0] = 3.0;
+    REQUIRE(moved.data() != a.data());
+  }
+
+  SECTION("swapping with a heap array") {
+    a.swap(b);
+    REQUIRE(a.size() == 2);
+    REQUIRE(a[1] == 2.0);
+    REQUIRE(b.size() == 1);
+    REQUIRE(b[0] == 2.5);
+
+    b[0] = 4.0;
+    ArrayImpl<double> c(1, 1.0);
+    b.swap(c);
+    REQUIRE(b[0] == 1.0);
+    REQUIRE(c[0] == 4.0);
+  }
+}
+
 TEST_CASE("n-dim iterators that calculates proper offsets", "[array][NDIterator]") {
   using namespace abyss::core;
   auto arr = ArrayImpl<int>::from_range(6);
@@ -0,0 +1,120 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "dlpack.h"
+#include "functional.h"
+#include "operators.h"
+#include "tensor.h"
+
+namespace {
+
+// a producer that owns its buffer and counts releases
+struct Foreign {
+  std::vector<int32_t> data{0, 1, 2, 3, 4, 5, 6, 7};
+  std::vector<int64_t> shape{2, 3};
+  std::vector<int64_t> strides{4, 1};
+  int released = 0;
+  DLManagedTensor managed{};
+
+  Foreign() {
+    DLTensor& t = managed.dl_tensor;
+    t.data = data.data();
+    t.device = {kDLCPU, 0};
+    t.ndim = 2;
+    t.dtype = {kDLInt, 32, 1};
+    t.shape = shape.data();
+    t.strides = strides.data();
+    t.byte_offset = sizeof(int32_t);
+    managed.manager_ctx = this;
+    managed.deleter = [](DLManagedTensor* self) {
+      static_cast<Foreign*>(self->manager_ctx)->released++;
+    };
+  }
+};
+
+}  // namespace
+
+TEST_CASE("dlpack export", "[dlpack]") {
+  using namespace abyss;
+  auto t = arange(12, kFloat64).reshape({3, 4});
+  auto view = t(1);
+
+  DLManagedTensor* managed = to_dlpack(view);
+  const DLTensor& dl = managed->dl_tensor;
+  REQUIRE(dl.device.device_type == kDLCPU);
+  REQUIRE(dl.dtype.code == kDLFloat);
+  REQUIRE(dl.dtype.bits == 64);
+  REQUIRE(dl.ndim == 1);
+  REQUIRE(dl.shape[0] == 4);
+  REQUIRE(dl.strides[0] == 1);
+  REQUIRE(dl.byte_offset == 4 * sizeof(double));
+
+  // same memory, writes are visible both ways
+  auto* data = reinterpret_cast<double*>(static_cast<char*>(dl.data) +
+                                         dl.byte_offset);
+  REQUIRE(data[0] == 4);
+  data[0] = 40;
+  REQUIRE(double(t(1, 0)) == 40);
+
+  managed->deleter(managed);
+}
+
+TEST_CASE("dlpack import", "[dlpack]") {
+  using namespace abyss;
+
+  SECTION("wraps the producer's memory") {
+    Foreign foreign;
+    int32_t row_sums[] = {1 + 2 + 3, 5 + 6 + 7};
+    {
+      auto t = from_dlpack(&foreign.managed);
+      REQUIRE(t.dtype() == kInt32);
+      REQUIRE(t.shape() == std::vector<int>{2, 3});
+      REQUIRE_FALSE(t.flags(core::FlagId::kIsContiguous));
+      // rows start at 1 and 5
+      REQUIRE(int(t(1, 0)) == 5);
+      auto expected = Tensor::from_blob(row_sums, {2}, kInt32);
+      bool same = (sum(t, 1) == expected).all();
+      REQUIRE(same);
+
+      foreign.data[2] = 20;
+      REQUIRE(int(t(0, 1)) == 20);
+      REQUIRE(foreign.released == 0);
+    }
+    REQUIRE(foreign.released == 1);
+  }
+
+  SECTION("compact strides when none are given") {
+    Foreign foreign;
+    foreign.managed.dl_tensor.strides = nullptr;
+    foreign.managed.dl_tensor.byte_offset = 0;
+    auto t = from_dlpack(&foreign.managed);
+    REQUIRE(t.flags(core::FlagId::kIsContiguous));
+    REQUIRE(int(t(1, 0)) == 3);
+  }
+
+  SECTION("rejects what it cannot represent") {
+    Foreign foreign;
+    foreign.managed.dl_tensor.dtype = {kDLFloat, 32, 1};
+    REQUIRE_THROWS_AS(from_dlpack(&foreign.managed), std::runtime_error);
+
+    foreign.managed.dl_tensor.dtype = {kDLInt, 32, 1};
+    foreign.managed.dl_tensor.device = {kDLCUDA, 0};
+    REQUIRE_THROWS_AS(from_dlpack(&foreign.managed), std::runtime_error);
+
+    foreign.managed.dl_tensor.device = {kDLCPU, 0};
+    foreign.managed.dl_tensor.shape = nullptr;
+    REQUIRE_THROWS_AS(from_dlpack(&foreign.managed), std::runtime_error);
+    // ownership stays with the caller
+    REQUIRE(foreign.released == 0);
+  }
+
+  SECTION("round trip") {
+    auto t = arange(6, kInt32);
+    auto back = from_dlpack(to_dlpack(t));
+    back(2) = 20;
+    REQUIRE(int(t(2)) == 20);
+  }
+}
@@ -157,4 +157,54 @@ TEST_CASE("test reeduction function: sum", "[functions][reduce][sum]") {
     // std::cout<< b << std::endl;
     REQUIRE(all_ok);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("seeded random factories", "[functions][random]") {
+  abyss::manual_seed(1234);
+  auto a = abyss::randn({16, 8});
+  auto b = abyss::rand({5});
+
+  abyss::manual_seed(1234);
+  auto c = abyss::randn({16, 8});
+  auto d = abyss::rand({5});
+
+  REQUIRE(a.shape() == std::vector<int>{16, 8});
+  REQUIRE(a.dtype() == abyss::kFloat64);
+
+  bool same = (a == c).all();
+  REQUIRE(same);
+  same = (b == d).all();
+  REQUIRE(same);
+
+  SECTION("independent generators") {
+    abyss::Generator gen(1234);
+    auto e = abyss::randn({16, 8}, gen);
+
+    same = (a == e).all();
+    REQUIRE(same);
+    REQUIRE(gen.offset() == 64);
+  }
+
+  SECTION("consecutive draws differ") {
+    auto e = abyss::randn({16, 8});
+    bool different = (a != e).all();
+    REQUIRE(different);
+  }
+}
+
+TEST_CASE("concatenate tensors", "[functions][concat]") {
+  auto a = abyss::arange(6, abyss::kFloat64).reshape({2, 3});
+  auto b = abyss::full({3, 2}, 0.5);
+
+  // float64 inputs stay float64, the second operand is a transposed view
+  auto c = abyss::concat({a, b.T()}, 0);
+  REQUIRE(c.dtype() == abyss::kFloat64);
+  REQUIRE(c.shape() == std::vector<int>{4, 3});
+  for (int j = 0; j < 3; j++) {
+    REQUIRE(double(c(1, j)) == 3 + j);
+    REQUIRE(double(c(3, j)) == 0.5);
+  }
+
+  auto d = abyss::concat({a, a}, 1);
+  REQUIRE(d.shape() == std::vector<int>{2, 6});
+  REQUIRE(double(d(1, 4)) == 4.0);
+}
@@ -0,0 +1,144 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "functional.h"
+#include "jit.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+bool same(abyss::Tensor a, abyss::Tensor b) {
+  if (a.shape() != b.shape() || a.dtype() != b.dtype()) return false;
+  return bool((a == b).all());
+}
+
+}  // namespace
+
+TEST_CASE("fused expressions", "[jit]") {
+  using namespace abyss;
+  auto x = jit::input(0), y = jit::input(1);
+  auto expr = exp(x) * y + 1.0;
+  REQUIRE(expr.num_inputs() == 2);
+  REQUIRE(expr.str() == "add(mul(exp(x0), x1), 1)");
+
+  auto a = randn({4, 5});
+  auto b = randn({4, 5});
+  jit::set_enabled(false);
+  auto out = jit::FusedKernel(expr)({a, b});
+  REQUIRE(same(out, exp(a) * b + 1.0));
+
+  REQUIRE_THROWS(jit::FusedKernel(x + jit::input(2))({a, b}));
+}
+
+TEST_CASE("jit kernels match the interpreter", "[jit]") {
+  using namespace abyss;
+  namespace fs = std::filesystem;
+  const std::string dir = "abyss-test-jit";
+  fs::remove_all(dir);
+  auto previous = jit::cache_dir();
+  jit::set_cache_dir(dir);
+  jit::set_enabled(true);
+
+  auto x = jit::input(0), y = jit::input(1);
+  auto a = randn({8, 6});
+  auto t = randn({6, 8});
+  auto row = randn({1, 6});
+  auto ints = full({8, 6}, 7);
+
+  std::vector<std::pair<jit::Expr, std::vector<Tensor>>> cases = {
+      {exp(x) * y + 1.0, {a, a}},
+      // broadcast and a transposed view need strides
+      {x - y / 2.0, {t.T(), row}},
+      // without constants int32 stays int32: truncating exp, integer division
+      {exp(x) / y, {ints, full({1}, 3)}},
+      // constants are float64 and promote the whole expression
+      {exp(x / 2 * 0 + x) / y, {ints, full({1}, 3)}},
+      {-log(x * x + 1.0), {ints}},
+  };
+  REQUIRE(jit::interpret(cases[2].first, cases[2].second).dtype() == kInt32);
+  REQUIRE(jit::interpret(cases[3].first, cases[3].second).dtype() == kFloat64);
+
+  auto before = jit::stats();
+  for (auto& c : cases) {
+    auto reference = jit::interpret(c.first, c.second);
+    // the first call runs on the interpreter while the kernel builds
+    REQUIRE(same(jit::FusedKernel(c.first)(c.second), reference));
+    jit::wait();
+    REQUIRE(same(jit::FusedKernel(c.first)(c.second), reference));
+  }
+
+  auto after = jit::stats();
+  // no compiler is not an error, everything stays interpreted
+  if (after.failed != before.failed) {
+    WARN("jit kernels could not be built (see " + dir +
+         "/*.log), only the interpreter was checked");
+  } else {
+    REQUIRE(after.compiled + after.loaded - before.compiled - before.loaded ==
+            cases.size());
+    REQUIRE(after.compiled_calls - before.compiled_calls >= cases.size());
+
+    SECTION("later processes load kernels from the cache") {
+      jit::set_cache_dir(dir);
+      auto calls = jit::stats().compiled_calls;
+      auto& c = cases.front();
+      REQUIRE(same(jit::FusedKernel(c.first)(c.second),
+                   jit::interpret(c.first, c.second)));
+      REQUIRE(jit::stats().compiled_calls == calls + 1);
+      REQUIRE(jit::stats().loaded > after.loaded);
+    }
+  }
+
+  SECTION("gradients are recorded by the interpreter") {
+    auto leaf = randn({3, 3});
+    leaf.set_flag(core::FlagId::kIsLeaf, true);
+    leaf.set_flag(core::FlagId::kRequiresGrad, true);
+    auto calls = jit::stats().interpreted_calls;
+    auto out = jit::FusedKernel(exp(x) + x)({leaf});
+    REQUIRE(jit::stats().interpreted_calls == calls + 1);
+    REQUIRE(out.flags(core::FlagId::kRequiresGrad));
+  }
+
+  jit::set_enabled(false);
+  jit::set_cache_dir(previous);
+  fs::remove_all(dir);
+}
+
+TEST_CASE("jit without a compiler", "[jit]") {
+  using namespace abyss;
+  namespace fs = std::filesystem;
+  const std::string dir = "abyss-test-jit-nocc";
+  fs::remove_all(dir);
+  auto previous = jit::cache_dir();
+  const char* cxx = std::getenv("ABYSS_JIT_CXX");
+  std::string saved = cxx != nullptr ? cxx : "";
+  ::setenv("ABYSS_JIT_CXX", "abyss-no-such-compiler", 1);
+  jit::set_cache_dir(dir);
+  jit::set_enabled(true);
+
+  auto x = jit::input(0);
+  auto a = randn({5, 4});
+  auto failed = jit::stats().failed;
+  jit::FusedKernel kernel(exp(x) * x);
+  REQUIRE(same(kernel({a}), exp(a) * a));
+  jit::wait();
+  REQUIRE(jit::stats().failed == failed + 1);
+  // the build failure is remembered, later calls stay on the interpreter
+  REQUIRE(same(kernel({a}), exp(a) * a));
+  REQUIRE(jit::stats().failed == failed + 1);
+
+  jit::set_enabled(false);
+  if (cxx != nullptr) {
+    ::setenv("ABYSS_JIT_CXX", saved.c_str(), 1);
+  } else {
+    ::unsetenv("ABYSS_JIT_CXX");
+  }
+  jit::set_cache_dir(previous);
+  fs::remove_all(dir);
+}
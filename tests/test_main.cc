@@ -1,4 +1,21 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 
+#include "backend/autotune.h"
+
 // main test file that will be populated by Catch2
+
+namespace {
+
+// kernels tuned on test shapes must not end up in the user's cache
+struct AutotuneCacheListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void testRunStarting(const Catch::TestRunInfo&) override {
+    abyss::backend::set_autotune_cache("");
+  }
+};
+
+}  // namespace
+
+CATCH_REGISTER_LISTENER(AutotuneCacheListener)
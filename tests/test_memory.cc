@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "functional.h"
+#include "memory_stats.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kIsLeaf, true);
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+const abyss::memory::SiteStats* find_site(
+    const std::vector<abyss::memory::SiteStats>& sites,
+    const std::string& name) {
+  auto it = std::find_if(sites.begin(), sites.end(),
+                         [&](const auto& s) { return s.site == name; });
+  return it == sites.end() ? nullptr : &*it;
+}
+
+}  // namespace
+
+TEST_CASE("tensor sizes in bytes", "[memory]") {
+  using namespace abyss;
+  REQUIRE(kFloat64.itemsize() == 8);
+  REQUIRE(kInt32.itemsize() == 4);
+  REQUIRE(kUint8.itemsize() == 1);
+
+  REQUIRE(full({3, 4}, 1.0).nbytes() == 3 * 4 * 8);
+  REQUIRE(full({5}, 1).nbytes() == 5 * 4);
+}
+
+TEST_CASE("live and peak bytes", "[memory]") {
+  using namespace abyss;
+  auto before = memory::stats();
+  {
+    auto t = full({1000}, 0.0);
+    auto during = memory::stats();
+    REQUIRE(during.live_bytes >= before.live_bytes + 8000);
+    REQUIRE(during.peak_bytes >= during.live_bytes);
+    REQUIRE(during.allocations > before.allocations);
+  }
+  auto after = memory::stats();
+  REQUIRE(after.live_bytes == before.live_bytes);
+  REQUIRE(after.frees > before.frees);
+
+  memory::reset_peak();
+  REQUIRE(memory::stats().peak_bytes == after.live_bytes);
+}
+
+TEST_CASE("allocations by site", "[memory]") {
+  using namespace abyss;
+  memory::track_sites(true);
+  {
+    Tensor labelled;
+    {
+      memory::SiteGuard site("loader");
+      labelled = full({100}, 1.0);
+    }
+    auto y = exp(full({50}, 1.0));
+
+    auto sites = memory::site_stats();
+    auto* loader = find_site(sites, "loader");
+    REQUIRE(loader != nullptr);
+    REQUIRE(loader->live_bytes == 800);
+    // ops label their own allocations
+    auto* op = find_site(sites, "ExpVisitor");
+    REQUIRE(op != nullptr);
+    REQUIRE(op->live_bytes == 400);
+  }
+  auto sites = memory::site_stats();
+  auto* loader = find_site(sites, "loader");
+  REQUIRE(loader->live_bytes == 0);
+  // the fill value was live at the same time
+  REQUIRE(loader->peak_bytes >= 800);
+
+  memory::track_sites(false);
+  REQUIRE(memory::site_stats().empty());
+}
+
+TEST_CASE("snapshot of graph-retained tensors", "[memory]") {
+  using namespace abyss;
+  memory::track_sites(true);
+
+  auto x = leaf(randn({20, 10}));
+  auto y = sum(exp(x));
+
+  auto snap = memory::snapshot();
+  REQUIRE(snap.graph_bytes >= 20 * 10 * 8);
+  REQUIRE(snap.free_bytes + snap.graph_bytes == snap.stats.live_bytes);
+  auto saved = std::find_if(snap.saved.begin(), snap.saved.end(),
+                            [](const auto& s) {
+                              return s.node.find("ExpFn") != std::string::npos;
+                            });
+  REQUIRE(saved != snap.saved.end());
+  REQUIRE(saved->shape == std::vector<int>{20, 10});
+  REQUIRE(saved->dtype == "float64");
+  REQUIRE(saved->nbytes == 20 * 10 * 8);
+
+  std::stringstream ss;
+  ss << snap;
+  REQUIRE(ss.str().find("ExpFn") != std::string::npos);
+
+  // backward releases the graph
+  y.backward();
+  REQUIRE(memory::snapshot().graph_bytes == 0);
+
+  memory::track_sites(false);
+}
@@ -0,0 +1,167 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "functional.h"
+#include "operators.h"
+#include "profiler.h"
+#include "random.h"
+#include "tensor.h"
+
+namespace {
+
+const abyss::profiler::Event* find(const std::vector<abyss::profiler::Event>& events,
+                                   const std::string& category,
+                                   const std::string& name) {
+  auto it = std::find_if(events.begin(), events.end(), [&](const auto& e) {
+    return e.category == category && e.name == name;
+  });
+  return it == events.end() ? nullptr : &*it;
+}
+
+abyss::Tensor leaf(abyss::Tensor t) {
+  t.set_flag(abyss::core::FlagId::kIsLeaf, true);
+  t.set_flag(abyss::core::FlagId::kRequiresGrad, true);
+  return t;
+}
+
+}  // namespace
+
+TEST_CASE("profiler records functions, visitors and kernels", "[profiler]") {
+  using namespace abyss;
+  auto a = leaf(randn({4, 3}));
+  auto b = randn({3, 5});
+
+  profiler::Profile profile;
+  REQUIRE(profiler::is_enabled());
+  sum(matmul(a, b)).backward();
+  profile.stop();
+  REQUIRE_FALSE(profiler::is_enabled());
+
+  const auto& events = profile.events();
+
+  auto* fn = find(events, "function", "MatmulFn");
+  REQUIRE(fn != nullptr);
+  REQUIRE(fn->inputs.size() == 2);
+  REQUIRE(fn->inputs[0].shape == std::vector<int>{4, 3});
+  REQUIRE(fn->inputs[1].shape == std::vector<int>{3, 5});
+  REQUIRE(fn->inputs[0].dtype == "float64");
+
+  auto* visitor = find(events, "visitor", "MatmulVisitor");
+  REQUIRE(visitor != nullptr);
+  // at least the (4, 5) output
+  REQUIRE(visitor->bytes_allocated >= 4 * 5 * sizeof(double));
+  REQUIRE(fn->bytes_allocated >= visitor->bytes_allocated);
+
+  auto* kernel = find(events, "kernel", "matmul");
+  REQUIRE(kernel != nullptr);
+  REQUIRE(kernel->flops == Approx(2 * 4 * 3 * 5));
+
+  // scopes nest in time
+  REQUIRE(fn->start_ns <= kernel->start_ns);
+  REQUIRE(kernel->start_ns + kernel->duration_ns <=
+          fn->start_ns + fn->duration_ns);
+
+  // backward runs through the same visitors
+  REQUIRE(std::count_if(events.begin(), events.end(), [](const auto& e) {
+            return e.name == "MatmulVisitor";
+          }) >= 2);
+
+  SECTION("aggregated table") {
+    auto table = profile.table();
+    REQUIRE(table.find("MatmulFn") != std::string::npos);
+    REQUIRE(table.find("matmul") != std::string::npos);
+  }
+
+  SECTION("chrome trace") {
+    std::string path = "abyss-test-trace.json";
+    profile.export_chrome_trace(path);
+
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    auto json = ss.str();
+    std::remove(path.c_str());
+
+    REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(json.find("\"name\": \"MatmulFn\"") != std::string::npos);
+    REQUIRE(json.find("\"ph\": \"X\"") != std::string::npos);
+    REQUIRE(json.find("float64(4, 3)") != std::string::npos);
+  }
+}
+
+TEST_CASE("profiler is off outside a profile", "[profiler]") {
+  using namespace abyss;
+  REQUIRE_FALSE(profiler::is_enabled());
+
+  profiler::Profile profile;
+  REQUIRE_THROWS(profiler::Profile());
+  profile.stop();
+
+  exp(randn({3, 3}));
+  REQUIRE(profile.events().empty());
+}
+
+TEST_CASE("profiler tells threads apart", "[profiler]") {
+  using namespace abyss;
+  auto x = randn({8, 8});
+
+  profiler::Profile profile;
+  std::thread worker([&] { exp(x); });
+  worker.join();
+  exp(x);
+  profile.stop();
+
+  std::set<int> threads;
+  for (const auto& e : profile.events()) {
+    if (e.name == "ExpVisitor") threads.insert(e.thread_id);
+  }
+  REQUIRE(threads.size() == 2);
+}
+
+TEST_CASE("hardware counters", "[profiler]") {
+  using namespace abyss;
+  using profiler::Counter;
+  auto x = randn({64, 64});
+
+  // counters may be refused (no PMU, perf_event_paranoid), which is not an
+  // error, only missing numbers
+  profiler::HardwareCounters counters;
+  auto before = counters.read();
+  REQUIRE(before.available == counters.available());
+  matmul(x, x);
+  auto delta = counters.read() - before;
+  if (delta.has(Counter::kInstructions)) {
+    REQUIRE(delta[Counter::kInstructions] > 0);
+  }
+  if (delta.has(Counter::kCycles) && delta.has(Counter::kInstructions)) {
+    REQUIRE(delta.ipc() > 0);
+  } else {
+    REQUIRE(delta.ipc() == 0);
+  }
+
+  profiler::Profile profile(true);
+  matmul(x, x);
+  profile.stop();
+
+  auto kernel = std::find_if(
+      profile.events().begin(), profile.events().end(),
+      [](const auto& e) { return e.category == "kernel"; });
+  REQUIRE(kernel != profile.events().end());
+  // a group that opened may still never get onto the PMU
+  auto sampled = profiler::detail::thread_counters().read().available;
+  REQUIRE(kernel->counters.available == sampled);
+  REQUIRE(profile.table().find("IPC") != std::string::npos);
+
+  // counters are only sampled when asked for
+  profiler::Profile plain;
+  matmul(x, x);
+  plain.stop();
+  for (const auto& e : plain.events()) REQUIRE(e.counters.available == 0);
+}
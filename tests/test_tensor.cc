@@ -220,6 +220,101 @@ TEST_CASE("tensor copy", "[Tensor][copy]") {
   }
 }
 
+TEST_CASE("tensor contiguous", "[Tensor][contiguous]") {
+  using namespace abyss;
+  auto t = arange(24, kFloat64);
+  auto cube = t.reshape({2, 3, 4});
+
+  SECTION("dense tensors are returned as they are") {
+    auto c = cube.contiguous();
+    c(0, 0, 0) = 100.0;
+    REQUIRE(double(cube(0, 0, 0)) == 100);
+  }
+
+  SECTION("permuted views are packed") {
+    // large enough for the blocked transpose, and a small one
+    for (int n : {3, 40}) {
+      auto m = arange(n * (n + 1), kFloat64).reshape({n, n + 1});
+      auto packed = m.T().contiguous();
+      REQUIRE(packed.shape() == std::vector<int>{n + 1, n});
+      REQUIRE(packed.strides() == std::vector<int>{n, 1});
+      REQUIRE(double(packed(n, n - 1)) == double(m(n - 1, n)));
+      bool same = (packed == m.T()).all();
+      REQUIRE(same);
+    }
+
+    auto moved = cube.transpose({1, 2, 0}).contiguous();
+    REQUIRE(moved.shape() == std::vector<int>{3, 4, 2});
+    REQUIRE(double(moved(2, 1, 1)) == double(cube(1, 2, 1)));
+  }
+
+  SECTION("reshaping a transpose leaves the source alone") {
+    auto m = arange(6, kFloat64).reshape({2, 3});
+    auto flat = m.T().reshape({6});
+    std::vector<double> expected{0, 3, 1, 4, 2, 5};
+    for (int i = 0; i < 6; i++) {
+      REQUIRE(double(flat(i)) == expected[i]);
+      REQUIRE(double(m(i / 3, i % 3)) == i);
+    }
+  }
+}
+
+TEST_CASE("tensor from blob", "[Tensor][from_blob]") {
+  using namespace abyss;
+  std::vector<double> buffer{0, 1, 2, 3, 4, 5};
+
+  SECTION("reads and writes the foreign memory") {
+    auto t = Tensor::from_blob(buffer.data(), {2, 3}, kFloat64);
+    REQUIRE(t.shape() == std::vector<int>{2, 3});
+    REQUIRE(t.flags(core::FlagId::kIsContiguous));
+    REQUIRE_FALSE(t.flags(core::FlagId::kOwnsData));
+
+    buffer[4] = 40;
+    REQUIRE(double(t(1, 1)) == 40);
+
+    t(0, 2) = 20.0;
+    REQUIRE(buffer[2] == 20);
+  }
+
+  SECTION("strided") {
+    // column-major 2x3
+    auto t = Tensor::from_blob(buffer.data(), {2, 3}, {1, 2}, kFloat64);
+    REQUIRE_FALSE(t.flags(core::FlagId::kIsContiguous));
+    REQUIRE(double(t(0, 1)) == 2);
+    REQUIRE(double(t(1, 0)) == 1);
+
+    bool same = (t + 0.0 == t).all();
+    REQUIRE(same);
+  }
+
+  SECTION("deleter runs once with the last user") {
+    int calls = 0;
+    auto* heap = new int32_t[4]{1, 2, 3, 4};
+    {
+      auto t = Tensor::from_blob(heap, {4}, kInt32, [&](void* ptr) {
+        calls++;
+        delete[] static_cast<int32_t*>(ptr);
+      });
+      REQUIRE(t.flags(core::FlagId::kOwnsData));
+
+      auto view = t(2);
+      auto copy = t;
+      t = Tensor();
+      REQUIRE(calls == 0);
+      REQUIRE(int(view) == 3);
+    }
+    REQUIRE(calls == 1);
+  }
+
+  SECTION("rejects bad layouts") {
+    REQUIRE_THROWS(Tensor::from_blob(buffer.data(), {2, 3}, {1}, kFloat64));
+    REQUIRE_THROWS(
+        Tensor::from_blob(buffer.data(), {2, 3}, {-3, 1}, kFloat64));
+    REQUIRE_THROWS(Tensor::from_blob(nullptr, {2}, kFloat64));
+    REQUIRE(Tensor::from_blob(nullptr, {0}, kFloat64).size() == 0);
+  }
+}
+
 TEST_CASE("tensor concatenation", "[Tensor][concat]") {
   abyss::Tensor t1 = abyss::full({3, 2}, 11);
 
@@ -247,4 +247,94 @@ TEST_CASE("broadcast copy", "[core][utility][broadcast_copy]") {
   //   // shape2:         1 x 2 x 5
   //   // output: 4 x 9 x 3 x 5
   // }
-}
\ No newline at end of file
+}
+TEST_CASE("strided offsets", "[core][utility][static_desc]") {
+  using namespace abyss;
+
+  // reference with unravel_index, for every rank with and without a
+  // fixed-rank loop
+  auto reference = [](const core::ArrayDesc& desc) {
+    std::vector<size_t> out;
+    for (size_t i = 0; i < core::shape2size(desc.shape); i++) {
+      auto coords = core::unravel_index(i, desc.shape);
+      size_t offset = desc.offset;
+      for (size_t j = 0; j < coords.size(); j++) {
+        offset += coords[j] * desc.strides[j];
+      }
+      out.push_back(offset);
+    }
+    return out;
+  };
+
+  for (int rank = 1; rank <= core::kMaxStaticRank + 2; rank++) {
+    core::ArrayDesc desc;
+    desc.offset = 3;
+    for (int d = 0; d < rank; d++) desc.shape.push_back(2 + d % 2);
+    desc.strides = core::shape2strides(desc.shape);
+    // reversed axes, like a transpose, and a broadcast axis
+    std::reverse(desc.strides.begin(), desc.strides.end());
+    desc.strides[0] = 0;
+
+    INFO("rank " << rank);
+    REQUIRE(core::strided_offsets(desc) == reference(desc));
+  }
+
+  SECTION("empty and rank 0") {
+    REQUIRE(core::strided_offsets({0, {2, 0, 3}, {0, 3, 1}}).empty());
+    REQUIRE(core::strided_offsets({5, {}, {}}) == std::vector<size_t>{5});
+  }
+
+  SECTION("paired walk") {
+    core::DimVector shape = {2, 3};
+    core::DimVector a = {3, 1}, b = {0, 1};
+    std::vector<std::array<size_t, 2>> seen;
+    core::for_each_offset<2>(shape, {&a, &b}, {0, 10},
+                             [&](const std::array<size_t, 2>& o) {
+                               seen.push_back(o);
+                             });
+    REQUIRE(seen.size() == 6);
+    REQUIRE(seen[4] == std::array<size_t, 2>{4, 11});
+  }
+}
+
+TEST_CASE("small vector", "[core][utility][small_vector]") {
+  using namespace abyss;
+  using Dims = core::SmallVector<int, 4>;
+
+  Dims dims = {2, 3};
+  REQUIRE(dims.is_inline());
+
+  SECTION("vector interface") {
+    dims.insert(dims.begin(), 2, 1);
+    dims.emplace_back(4);
+    REQUIRE(dims == std::vector<int>{1, 1, 2, 3, 4});
+    REQUIRE_FALSE(dims.is_inline());
+
+    dims.erase(dims.begin());
+    std::vector<int> as_vector = dims;
+    REQUIRE(as_vector == std::vector<int>{1, 2, 3, 4});
+    REQUIRE(*dims.rbegin() == 4);
+
+    dims.assign(2, 7);
+    REQUIRE(dims == Dims{7, 7});
+  }
+
+  SECTION("copies are independent") {
+    Dims copy = dims;
+    copy[0] = 5;
+    REQUIRE(dims[0] == 2);
+
+    Dims grown(6, 1);
+    Dims moved = std::move(grown);
+    REQUIRE(moved.size() == 6);
+    REQUIRE(grown.empty());
+    moved = dims;
+    REQUIRE(moved == dims);
+  }
+
+  SECTION("tensor metadata stays inline") {
+    auto shape = core::shape2strides({4, 3, 2});
+    REQUIRE(shape.is_inline());
+    REQUIRE(shape == std::vector<int>{6, 2, 1});
+  }
+}
@@ -0,0 +1,158 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "autograd/grad_mode.h"
+#include "functional.h"
+#include "nn/module.h"
+#include "operators.h"
+#include "random.h"
+#include "tensor.h"
+#include "utils/batching.h"
+
+namespace {
+
+bool close(abyss::Tensor a, abyss::Tensor b) {
+  if (a.shape() != b.shape()) return false;
+  auto diff = a - b;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (std::abs(double(diff.reshape({int(a.size())})(i))) > 1e-10) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST_CASE("batching executor", "[utils][batching]") {
+  using namespace abyss;
+  using namespace std::chrono_literals;
+  const int in = 6, out = 4;
+  const int n_threads = 4, per_thread = 16;
+
+  nn::Linear fc(in, out, true, Activation::kTanh);
+  std::vector<Tensor> samples, expected;
+  for (int i = 0; i < n_threads * per_thread; i++) {
+    samples.push_back(randn({in, 1}));
+    autograd::NoGradGuard no_grad;
+    expected.push_back(fc(samples.back()));
+  }
+
+  SECTION("results come back to their request") {
+    utils::BatchingExecutor executor(fc, 1, 8, 2ms);
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> clients;
+    for (int t = 0; t < n_threads; t++) {
+      clients.emplace_back([&, t] {
+        std::vector<std::future<Tensor>> results;
+        for (int i = 0; i < per_thread; i++) {
+          results.push_back(executor.submit(samples[t * per_thread + i]));
+        }
+        for (int i = 0; i < per_thread; i++) {
+          if (!close(results[i].get(), expected[t * per_thread + i])) {
+            mismatches++;
+          }
+        }
+      });
+    }
+    for (auto& c : clients) c.join();
+
+    REQUIRE(mismatches == 0);
+    // requests were coalesced
+    REQUIRE(executor.num_batches() < size_t(n_threads * per_thread));
+    REQUIRE(executor.num_batches() >= size_t(n_threads * per_thread / 8));
+  }
+
+  SECTION("a lone request is answered after the delay") {
+    utils::BatchingExecutor executor(fc, 1, 8, 1ms);
+    auto result = executor.submit(samples[0]);
+    REQUIRE(result.wait_for(1s) == std::future_status::ready);
+    REQUIRE(close(result.get(), expected[0]));
+  }
+
+  SECTION("malformed samples only fail themselves") {
+    utils::BatchingExecutor executor(fc, 1, 8, 5ms);
+    auto good = executor.submit(samples[1]);
+    auto bad = executor.submit(randn({in + 1, 1}));
+
+    REQUIRE_THROWS(bad.get());
+    REQUIRE(close(good.get(), expected[1]));
+    REQUIRE_THROWS(executor.submit(randn({in, 2})));
+  }
+
+  SECTION("pending requests are answered on shutdown") {
+    std::future<Tensor> result;
+    {
+      utils::BatchingExecutor executor(fc, 1, 64, 10s);
+      result = executor.submit(samples[2]);
+    }
+    REQUIRE(close(result.get(), expected[2]));
+  }
+}
+
+/**
+ * Load generator: closed loop clients submitting one sample at a time,
+ * compared against every client calling the module directly.
+ */
+TEST_CASE("batching executor under load", "[.][stress][batching]") {
+  using namespace abyss;
+  using namespace std::chrono_literals;
+  using clock = std::chrono::steady_clock;
+  const int in = 512, hidden = 1024, out = 16;
+  const auto duration = 2s;
+
+  nn::Linear fc1(in, hidden, true, Activation::kReLU);
+  nn::Linear fc2(hidden, out);
+  struct Model : nn::Module {
+    nn::Linear &a, &b;
+    Model(nn::Linear& a, nn::Linear& b) : a{a}, b{b} {}
+    Tensor forward(Tensor x) override { return b(a(x)); }
+  } model(fc1, fc2);
+  auto sample = randn({in, 1});
+
+  auto drive = [&](int n_clients, auto request) {
+    std::atomic<bool> done{false};
+    std::vector<std::vector<double>> latencies(n_clients);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < n_clients; c++) {
+      clients.emplace_back([&, c] {
+        autograd::NoGradGuard no_grad;
+        while (!done) {
+          auto start = clock::now();
+          request();
+          std::chrono::duration<double, std::micro> us = clock::now() - start;
+          latencies[c].push_back(us.count());
+        }
+      });
+    }
+    std::this_thread::sleep_for(duration);
+    done = true;
+    for (auto& c : clients) c.join();
+
+    std::vector<double> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    std::chrono::duration<double> seconds = duration;
+    std::cout << n_clients << " clients: " << all.size() / seconds.count()
+              << " req/s, p50 " << all[all.size() / 2] << " us, p99 "
+              << all[all.size() * 99 / 100] << " us" << std::endl;
+  };
+
+  for (int n_clients : {1, 8, 32}) {
+    std::cout << "direct    ";
+    drive(n_clients, [&] { model(sample); });
+
+    utils::BatchingExecutor executor(model, 1, 32, 200us);
+    std::cout << "batched   ";
+    drive(n_clients, [&] { executor.submit(sample).get(); });
+  }
+}